@@ -44,6 +44,11 @@ namespace mech {
 		return number;
 	}
 
+	static uint64 hash(const uint64& number)
+	{
+		return number ^ (number >> 32); //keys packing two 32 bit values keep both halves
+	}
+
 	static uint64 hash(const void* ptr)
 	{
 		uint64 number = uint64(ptr);
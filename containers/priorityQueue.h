@@ -0,0 +1,125 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+//@ssebunya_umar - X(twitter)
+
+#ifndef PRIORITYQUEUE_H
+#define PRIORITYQUEUE_H
+
+#include"dynamicArray.h"
+
+namespace mech {
+
+	/*
+		this class represents a priority queue - the smallest element (operator<) is always at the top.
+		the data is stored in a dynamic array as a binary heap.
+		NOTE: the address of the data can change, do not store pointers!
+		NOTE: the index of the data can change, do not store indicies!
+	*/
+	template<typename T, typename sizeType>
+	class PriorityQueue {
+
+	private:
+
+		DynamicArray<T, sizeType> mData;
+
+		void swapData(const sizeType& index1, const sizeType& index2)
+		{
+			T temp = this->mData[index1];
+			this->mData[index1] = this->mData[index2];
+			this->mData[index2] = temp;
+		}
+
+	public:
+
+		void push(const T& data)
+		{
+			this->mData.pushBack(data);
+
+			sizeType index = this->mData.size() - 1;
+			while (index > 0) {
+
+				sizeType parent = (index - 1) / 2;
+				if ((this->mData[index] < this->mData[parent]) == false) break;
+
+				this->swapData(index, parent);
+				index = parent;
+			}
+		}
+
+		void pop()
+		{
+			if (this->mData.empty()) return;
+
+			this->mData[0] = this->mData.back();
+			this->mData.popBack();
+
+			sizeType index = 0;
+			sizeType count = this->mData.size();
+			while (true) {
+
+				sizeType left = index * 2 + 1;
+				sizeType right = left + 1;
+				sizeType smallest = index;
+
+				if (left < count && this->mData[left] < this->mData[smallest]) smallest = left;
+				if (right < count && this->mData[right] < this->mData[smallest]) smallest = right;
+
+				if (smallest == index) break;
+
+				this->swapData(index, smallest);
+				index = smallest;
+			}
+		}
+
+		T& top()
+		{
+			return this->mData.front();
+		}
+
+		sizeType size()
+		{
+			return this->mData.size();
+		}
+
+		bool empty() const
+		{
+			return this->mData.empty();
+		}
+
+		void shallowClear(bool callDestructors)
+		{
+			this->mData.shallowClear(callDestructors);
+		}
+
+		void clear()
+		{
+			this->mData.clear();
+		}
+	};
+}
+
+#endif
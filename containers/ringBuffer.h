@@ -0,0 +1,127 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include"dynamicArray.h"
+
+namespace mech {
+
+	/*
+		this class represents a fixed capacity queue - first in first out
+		the memory is allocated once by reserve, pushing into a full buffer overwrites the oldest data.
+		NOTE: the index of the data changes as data is popped, index 0 is always the oldest
+	*/
+	template<typename T, typename sizeType>
+	class RingBuffer {
+
+	private:
+
+		DynamicArray<T, sizeType> mData;
+		sizeType mFront = 0;
+		sizeType mCount = 0;
+
+	public:
+
+		RingBuffer() {}
+		explicit RingBuffer(const sizeType& capacity) { this->reserve(capacity); }
+
+		//drops the data held
+		void reserve(const sizeType& capacity)
+		{
+			this->mData.clear();
+			this->mData.reserve(capacity);
+			this->mFront = 0;
+			this->mCount = 0;
+		}
+
+		//returns false when the oldest data had to be overwritten
+		bool push(const T& data)
+		{
+			ASSERT(this->capacity() > 0, "ring buffer has no memory, see reserve");
+
+			if (this->mCount == this->capacity()) {
+				this->mData[this->mFront] = data;
+				this->mFront = (this->mFront + 1) % this->capacity();
+				return false;
+			}
+
+			this->mData[(this->mFront + this->mCount) % this->capacity()] = data;
+			++this->mCount;
+			return true;
+		}
+
+		void pop()
+		{
+			if (this->mCount == 0) return;
+
+			this->mFront = (this->mFront + 1) % this->capacity();
+			--this->mCount;
+		}
+
+		T& operator[](const sizeType& index) const
+		{
+			ASSERT(index >= 0 && index < this->mCount, "ring buffer is empty or index is out of range");
+			return this->mData[(this->mFront + index) % this->capacity()];
+		}
+
+		T& front() const
+		{
+			ASSERT(this->mCount > 0, "ring buffer is empty");
+			return this->mData[this->mFront];
+		}
+
+		sizeType size() const
+		{
+			return this->mCount;
+		}
+
+		sizeType capacity() const
+		{
+			return this->mData.size();
+		}
+
+		bool empty() const
+		{
+			return this->mCount == 0;
+		}
+
+		bool full() const
+		{
+			return this->mCount == this->capacity();
+		}
+
+		void clear()
+		{
+			this->mFront = 0;
+			this->mCount = 0;
+		}
+	};
+}
+
+#endif
@@ -37,6 +37,15 @@ namespace mech {
 #define mech_ENABLE_DEBUG_RENDERER 0
 #define mech_ENABLE_PROFILER 0
 #define mech_ENABLE_LOGGER 0
+
+	//collider types compiled into the dispatch, pairs involving a disabled type are never instantiated
+#define mech_ENABLE_CONVEX_HULL_COLLIDERS 1
+#define mech_ENABLE_SPHERE_COLLIDERS 1
+#define mech_ENABLE_CAPSULE_COLLIDERS 1
+#define mech_ENABLE_COMPOUND_COLLIDERS 1
+#define mech_ENABLE_BOX_COLLIDERS 1
+#define mech_ENABLE_TRIANGLE_MESH_COLLIDERS 1
+#define mech_ENABLE_HEIGHT_FIELD_COLLIDERS 1
 	/////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	// Determine platform
@@ -33,6 +33,8 @@
 #include"../containers/string.h"
 
 #include<fstream>
+#include<string>
+#include<atomic>
 
 namespace mech {
 
@@ -54,9 +56,12 @@ namespace mech {
 		std::ofstream mFile;
 		Stack<ProfileInfo, uint32> mProfileStack;
 
+		//the first thread to profile writes profile.mech, the next ones profile1.mech, profile2.mech...
 		Profiler()
 		{
-			this->mFile.open("profile.mech");
+			static std::atomic<uint32> numOfThreads(0);
+			uint32 index = numOfThreads++;
+			this->mFile.open(index == 0 ? std::string("profile.mech") : "profile" + std::to_string(index) + ".mech");
 		}
 
 	public:
@@ -66,7 +71,8 @@ namespace mech {
 			this->mFile.close();
 		}
 
-		static Profiler* get() { static Profiler staticInstance; return &staticInstance; }
+		//one profiler per thread, scene query batches profile from several threads at once
+		static Profiler* get() { static thread_local Profiler staticInstance; return &staticInstance; }
 
 		void begin(const char* name)
 		{
@@ -0,0 +1,160 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include"core.h"
+
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+namespace mech {
+
+#define MAXIMUM_POOL_WORKERS 15
+
+	/*
+		threads that are started once and then sleep between batches. run(task, count, numOfThreads) splits [0, count) evenly between
+		the calling thread and numOfThreads - 1 workers and returns once task.run(first, last) has finished for every range.
+		batches from different threads are handled one after the other
+	*/
+	class WorkerPool {
+
+	private:
+
+		struct Job {
+			void (*run)(void* task, uint32 first, uint32 last) = nullptr;
+			void* task = nullptr;
+			uint32 first = 0;
+			uint32 last = 0;
+		};
+
+		std::thread mWorkers[MAXIMUM_POOL_WORKERS];
+		Job mJobs[MAXIMUM_POOL_WORKERS];
+		uint32 mNumOfWorkers = 0;
+		uint32 mGeneration = 0; //bumped for every batch, a worker wakes up when it differs from the last one it handled
+		uint32 mPendingJobs = 0;
+		bool mStopping = false;
+		std::mutex mMutex;
+		std::mutex mBatchMutex;
+		std::condition_variable mWakeUp;
+		std::condition_variable mFinished;
+
+		template<typename Task>
+		static void runTask(void* task, uint32 first, uint32 last)
+		{
+			((Task*)task)->run(first, last);
+		}
+
+		void work(uint32 index, uint32 generation)
+		{
+			while (true) {
+				Job job;
+				{
+					std::unique_lock<std::mutex> lock(this->mMutex);
+					while (this->mStopping == false && this->mGeneration == generation) {
+						this->mWakeUp.wait(lock);
+					}
+					if (this->mStopping) return;
+
+					generation = this->mGeneration;
+					job = this->mJobs[index];
+				}
+
+				if (job.first < job.last) {
+					job.run(job.task, job.first, job.last);
+				}
+
+				std::lock_guard<std::mutex> lock(this->mMutex);
+				if (--this->mPendingJobs == 0) {
+					this->mFinished.notify_one();
+				}
+			}
+		}
+
+	public:
+
+		WorkerPool() {}
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->mMutex);
+				this->mStopping = true;
+			}
+			this->mWakeUp.notify_all();
+
+			for (uint32 x = 0; x < this->mNumOfWorkers; ++x) {
+				this->mWorkers[x].join();
+			}
+		}
+
+		template<typename Task>
+		void run(Task& task, const uint32& count, const uint32& numOfThreads)
+		{
+			std::lock_guard<std::mutex> batchLock(this->mBatchMutex);
+
+			uint32 threads = numOfThreads < 1 ? 1 : (numOfThreads > MAXIMUM_POOL_WORKERS + 1 ? MAXIMUM_POOL_WORKERS + 1 : numOfThreads);
+			uint32 countPerThread = (count + threads - 1) / threads;
+
+			{
+				std::lock_guard<std::mutex> lock(this->mMutex);
+
+				//workers are only started the first time a batch asks for them
+				while (this->mNumOfWorkers < threads - 1) {
+					this->mWorkers[this->mNumOfWorkers] = std::thread(&WorkerPool::work, this, this->mNumOfWorkers, this->mGeneration);
+					++this->mNumOfWorkers;
+				}
+
+				for (uint32 x = 0; x < this->mNumOfWorkers; ++x) {
+					Job& job = this->mJobs[x];
+					job.run = &WorkerPool::runTask<Task>;
+					job.task = &task;
+					job.first = x + 1 < threads ? (x + 1) * countPerThread : count; //workers the batch does not need get an empty range
+					job.first = job.first < count ? job.first : count;
+					job.last = job.first + countPerThread < count ? job.first + countPerThread : count;
+				}
+
+				this->mPendingJobs = this->mNumOfWorkers;
+				++this->mGeneration;
+			}
+			this->mWakeUp.notify_all();
+
+			task.run(0, countPerThread < count ? countPerThread : count);
+
+			std::unique_lock<std::mutex> lock(this->mMutex);
+			while (this->mPendingJobs != 0) {
+				this->mFinished.wait(lock);
+			}
+		}
+	};
+}
+
+#endif
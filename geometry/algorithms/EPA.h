@@ -0,0 +1,263 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+#ifndef EPA_H
+#define EPA_H
+
+#include"GJK.h"
+#include"../../containers/hybridArray.h"
+
+namespace mech {
+
+#define MAXIMUM_EPA_ITERATIONS 64
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct EPAResult {
+		bool valid = false; //false when the shapes only touch or the polytope did not converge within MAXIMUM_EPA_ITERATIONS
+		Vec3 normal = nanVEC3; //from shape1 to shape2
+		decimal penetration = decimal(0.0);
+		Vec3 closest1 = nanVEC3; //deepest point of shape1 inside shape2
+		Vec3 closest2 = nanVEC3; //deepest point of shape2 inside shape1
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//expanding polytope algorithm, seeded with the terminating simplex of an overlapping GJK query
+	template<typename T1, typename T2>
+	static EPAResult EPAPenetration(const T1& convexShape1, const T2& convexShape2, const GJK::Simplex& simplex, const decimal& tolerance = decimal(0.0001))
+	{
+		struct Face {
+			Vec3 normal;
+			decimal distance = decimal(0.0);
+			uint16 a = -1, b = -1, c = -1;
+			bool obsolete = false;
+		};
+
+		struct Edge {
+			uint16 a = -1, b = -1;
+		};
+
+		struct TaskExecutor {
+
+			HybridArray<GJK::Simplex::SimplexPoint, 32, uint16> vertices;
+			HybridArray<Face, 64, uint16> faces;
+
+			void addVertex(const T1& convexShape1, const T2& convexShape2, const Vec3& direction)
+			{
+				GJK::Simplex::SimplexPoint p;
+				p.P = convexShape1.getSupportPoint(direction);
+				p.Q = convexShape2.getSupportPoint(-direction);
+				p.W = p.P - p.Q;
+				p.D = direction;
+				this->vertices.pushBack(p);
+			}
+
+			//the GJK simplex can terminate with less than 4 points, it is grown into a tetrahedron before expanding
+			bool buildTetrahedron(const T1& convexShape1, const T2& convexShape2)
+			{
+				Vec3 axes[6] = { XAXIS, -XAXIS, YAXIS, -YAXIS, ZAXIS, -ZAXIS };
+
+				if (this->vertices.size() == 1) {
+					for (byte x = 0; x < 6; ++x) {
+						this->addVertex(convexShape1, convexShape2, axes[x]);
+						if (magnitudeSq(this->vertices[1].W - this->vertices[0].W) > mathEPSILON) break;
+						this->vertices.eraseDataAtIndex(1);
+					}
+					if (this->vertices.size() < 2) return false;
+				}
+
+				if (this->vertices.size() == 2) {
+					Vec3 line = this->vertices[1].W - this->vertices[0].W;
+					for (byte x = 0; x < 6; ++x) {
+						Vec3 dir = crossProduct(line, axes[x]);
+						if (magnitudeSq(dir) <= mathEPSILON) continue;
+						this->addVertex(convexShape1, convexShape2, dir);
+						if (magnitudeSq(crossProduct(line, this->vertices[2].W - this->vertices[0].W)) > mathEPSILON) break;
+						this->vertices.eraseDataAtIndex(2);
+					}
+					if (this->vertices.size() < 3) return false;
+				}
+
+				if (this->vertices.size() == 3) {
+					Vec3 n = crossProduct(this->vertices[1].W - this->vertices[0].W, this->vertices[2].W - this->vertices[0].W);
+					this->addVertex(convexShape1, convexShape2, n);
+					if (mathABS(dotProduct(n, this->vertices[3].W - this->vertices[0].W)) <= mathEPSILON) {
+						this->vertices.eraseDataAtIndex(3);
+						this->addVertex(convexShape1, convexShape2, -n);
+						if (mathABS(dotProduct(n, this->vertices[3].W - this->vertices[0].W)) <= mathEPSILON) return false;
+					}
+				}
+
+				Vec3 center = (this->vertices[0].W + this->vertices[1].W + this->vertices[2].W + this->vertices[3].W) / decimal(4.0);
+				uint16 indicies[4][3] = { {0,1,2}, {0,3,1}, {0,2,3}, {1,3,2} };
+				for (byte x = 0; x < 4; ++x) {
+					if (this->addFace(indicies[x][0], indicies[x][1], indicies[x][2], center) == false) return false;
+				}
+
+				return true;
+			}
+
+			bool addFace(const uint16& a, const uint16& b, const uint16& c, const Vec3& inside)
+			{
+				Face f;
+				f.a = a;
+				f.b = b;
+				f.c = c;
+				f.normal = crossProduct(this->vertices[b].W - this->vertices[a].W, this->vertices[c].W - this->vertices[a].W);
+				if (magnitudeSq(f.normal) <= mathEPSILON * mathEPSILON) return false;
+				f.normal = normalise(f.normal);
+
+				if (dotProduct(f.normal, this->vertices[a].W - inside) < decimal(0.0)) {
+					f.normal = -f.normal;
+					f.b = c;
+					f.c = b;
+				}
+				f.distance = dotProduct(f.normal, this->vertices[a].W);
+
+				this->faces.pushBack(f);
+				return true;
+			}
+
+			void addHorizonEdge(HybridArray<Edge, 16, uint16>& horizon, const uint16& a, const uint16& b)
+			{
+				for (uint16 x = 0, len = horizon.size(); x < len; ++x) {
+					if (horizon[x].a == b && horizon[x].b == a) {
+						horizon.eraseDataAtIndex(x);
+						return;
+					}
+				}
+
+				Edge e;
+				e.a = a;
+				e.b = b;
+				horizon.pushBack(e);
+			}
+		};
+
+		BEGIN_PROFILE("EPAPenetration");
+
+		EPAResult result;
+
+		TaskExecutor ex;
+		for (byte x = 0; x < simplex.numPoints; ++x) {
+			ex.vertices.pushBack(simplex.points[x]);
+		}
+
+		if (ex.vertices.empty() || ex.buildTetrahedron(convexShape1, convexShape2) == false) {
+			END_PROFILE;
+			return result;
+		}
+
+		Vec3 inside = (ex.vertices[0].W + ex.vertices[1].W + ex.vertices[2].W + ex.vertices[3].W) / decimal(4.0);
+
+		uint16 closest = -1;
+		bool converged = false;
+		byte iterations = 0;
+		while (iterations++ < MAXIMUM_EPA_ITERATIONS) {
+
+			closest = -1;
+			decimal least = decimalMAX;
+			for (uint16 x = 0, len = ex.faces.size(); x < len; ++x) {
+				if (ex.faces[x].obsolete == false && ex.faces[x].distance < least) {
+					least = ex.faces[x].distance;
+					closest = x;
+				}
+			}
+
+			if (isAValidIndex(closest) == false) break;
+
+			//the origin sits outside the polytope, the shapes are only touching
+			if (least < -tolerance) {
+				closest = -1;
+				break;
+			}
+
+			Face face = ex.faces[closest];
+			ex.addVertex(convexShape1, convexShape2, face.normal);
+			uint16 newVertex = ex.vertices.size() - 1;
+
+			if (dotProduct(ex.vertices[newVertex].W, face.normal) - face.distance <= tolerance) {
+				converged = true;
+				break;
+			}
+
+			HybridArray<Edge, 16, uint16> horizon;
+			for (uint16 x = 0, len = ex.faces.size(); x < len; ++x) {
+
+				if (ex.faces[x].obsolete == true) continue;
+
+				if (dotProduct(ex.faces[x].normal, ex.vertices[newVertex].W - ex.vertices[ex.faces[x].a].W) > decimal(0.0)) {
+					ex.faces[x].obsolete = true;
+					ex.addHorizonEdge(horizon, ex.faces[x].a, ex.faces[x].b);
+					ex.addHorizonEdge(horizon, ex.faces[x].b, ex.faces[x].c);
+					ex.addHorizonEdge(horizon, ex.faces[x].c, ex.faces[x].a);
+				}
+			}
+
+			for (uint16 x = 0, len = horizon.size(); x < len; ++x) {
+				ex.addFace(horizon[x].a, horizon[x].b, newVertex, inside);
+			}
+		}
+
+		//out of iterations the closest face is one the polytope has already grown past, the caller falls back instead
+		if (converged && isAValidIndex(closest)) {
+
+			const Face& face = ex.faces[closest];
+			const GJK::Simplex::SimplexPoint& a = ex.vertices[face.a];
+			const GJK::Simplex::SimplexPoint& b = ex.vertices[face.b];
+			const GJK::Simplex::SimplexPoint& c = ex.vertices[face.c];
+
+			//barycentric coordinates of the origin projected onto the closest face
+			Vec3 p = face.normal * face.distance;
+			Vec3 v0 = b.W - a.W;
+			Vec3 v1 = c.W - a.W;
+			Vec3 v2 = p - a.W;
+			decimal d00 = dotProduct(v0, v0);
+			decimal d01 = dotProduct(v0, v1);
+			decimal d11 = dotProduct(v1, v1);
+			decimal d20 = dotProduct(v2, v0);
+			decimal d21 = dotProduct(v2, v1);
+			decimal denom = d00 * d11 - d01 * d01;
+
+			if (mathABS(denom) > mathEPSILON * mathEPSILON) {
+				decimal v = (d11 * d20 - d01 * d21) / denom;
+				decimal w = (d00 * d21 - d01 * d20) / denom;
+				decimal u = decimal(1.0) - v - w;
+
+				result.valid = true;
+				result.normal = face.normal;
+				result.penetration = face.distance;
+				result.closest1 = a.P * u + b.P * v + c.P * w;
+				result.closest2 = a.Q * u + b.Q * v + c.Q * w;
+			}
+		}
+
+		END_PROFILE;
+		return result;
+	}
+}
+
+#endif
@@ -45,16 +45,18 @@ namespace mech {
 				Vec3 W = nanVEC3; //point on A - B
 				Vec3 P = nanVEC3; //point on A
 				Vec3 Q = nanVEC3; //point on B
+				Vec3 D = nanVEC3; //search direction that produced the point
 			};
 
 			SimplexPoint points[4];
 			byte numPoints = 0;
 
-			void addPoint(const Vec3& support1, const Vec3& support2)
+			void addPoint(const Vec3& support1, const Vec3& support2, const Vec3& direction = nanVEC3)
 			{
 				this->points[this->numPoints].W = support1 - support2;
 				this->points[this->numPoints].P = support1;
 				this->points[this->numPoints].Q = support2;
+				this->points[this->numPoints].D = direction;
 				this->numPoints++;
 			}
 
@@ -310,6 +312,14 @@ namespace mech {
 		Vec3 searchDirection = nanVEC3;
 		Vec3 closest1 = nanVEC3;
 		Vec3 closest2 = nanVEC3;
+		GJK::Simplex simplex; //terminating simplex, used to seed EPA
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//the directions that produced the last simplex, re-evaluating them on the moved shapes gives a valid warm start simplex
+	struct GJKSimplexCache {
+		Vec3 directions[4];
+		byte numPoints = 0;
 	};
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -329,7 +339,7 @@ namespace mech {
 		byte iterations = 0;
 		while (iterations++ < MAXIMUM_GJK_ITERATIONS) {
 
-			gjk.simplex.addPoint(convexShape1.getSupportPoint(searchDirection), convexShape2.getSupportPoint(-searchDirection));
+			gjk.simplex.addPoint(convexShape1.getSupportPoint(searchDirection), convexShape2.getSupportPoint(-searchDirection), searchDirection);
 
 			if (gjk.simplex.isAffinelyDependent() == false) {
 				result.overlap = false;
@@ -370,6 +380,92 @@ namespace mech {
 		result.searchDirection = searchDirection;
 		result.closest1 = gjk.closestPoint.P;
 		result.closest2 = gjk.closestPoint.Q;
+		result.simplex = gjk.simplex;
+
+		END_PROFILE;
+		return result;
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template<typename T1, typename T2>
+	static GJKDistanceResult GJKDistance(const T1& convexShape1, const T2& convexShape2, GJKSimplexCache& cache, const decimal& tolerance = mathEPSILON)
+	{
+		BEGIN_PROFILE("GJKDistanceWarmStarted");
+
+		GJKDistanceResult result;
+
+		GJK gjk;
+
+		Vec3 searchDirection = Vec3();
+		decimal prevLenSq = decimalMAX;
+		bool done = false;
+
+		for (byte x = 0; x < cache.numPoints; ++x) {
+			gjk.simplex.addPoint(convexShape1.getSupportPoint(cache.directions[x]), convexShape2.getSupportPoint(-cache.directions[x]), cache.directions[x]);
+			gjk.simplex.isAffinelyDependent();
+		}
+
+		//a tetrahedron that still contains the origin is kept as is, EPA expands it directly
+		if (gjk.simplex.numPoints == 4 && gjk.simplex.containsOrigin()) {
+			result.overlap = true;
+			done = true;
+		}
+		else if (gjk.simplex.numPoints > 0) {
+
+			gjk.update();
+
+			searchDirection = -gjk.closestPoint.W;
+			prevLenSq = magnitudeSq(searchDirection);
+
+			if (prevLenSq <= tolerance) {
+				result.overlap = true;
+				done = true;
+			}
+		}
+
+		byte iterations = 0;
+		while (done == false && iterations++ < MAXIMUM_GJK_ITERATIONS) {
+
+			gjk.simplex.addPoint(convexShape1.getSupportPoint(searchDirection), convexShape2.getSupportPoint(-searchDirection), searchDirection);
+
+			if (gjk.simplex.isAffinelyDependent() == false) {
+				result.overlap = false;
+				break;
+			}
+
+			if (gjk.simplex.numPoints == 4 && gjk.simplex.containsOrigin()) {
+				result.overlap = true;
+				break;
+			}
+
+			gjk.update();
+
+			searchDirection = -gjk.closestPoint.W;
+			decimal dirLenSq = magnitudeSq(searchDirection);
+
+			if (dirLenSq <= tolerance) {
+				result.overlap = true;
+				break;
+			}
+
+			if (prevLenSq - dirLenSq <= mathEPSILON * prevLenSq || dirLenSq > prevLenSq) {
+				result.overlap = false;
+				break;
+			}
+
+			prevLenSq = dirLenSq;
+		}
+
+		cache.numPoints = gjk.simplex.numPoints;
+		for (byte x = 0; x < gjk.simplex.numPoints; ++x) {
+			cache.directions[x] = gjk.simplex.points[x].D;
+		}
+
+		result.searchDirection = searchDirection;
+		result.closest1 = gjk.closestPoint.P;
+		result.closest2 = gjk.closestPoint.Q;
+		result.simplex = gjk.simplex;
 
 		END_PROFILE;
 		return result;
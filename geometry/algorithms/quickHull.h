@@ -637,6 +637,8 @@ namespace mech {
 				hull.vertices.wrap();
 				hull.halfEdgeMesh.faces.wrap();
 				hull.halfEdgeMesh.edges.wrap();
+
+				hull.buildAdjacency();
 			}
 		};
 
@@ -96,27 +96,133 @@ namespace mech {
 					}
 				}
 			}
+
+			this->buildAdjacency();
 		}
 	}
 
-	Vec3 ConvexHull::getSupportPoint(const Vec3& direction) const
+	static Vec3 octantDirection(const byte& octant)
 	{
-		Vec3 support = nanVEC3;
-		decimal maxDotProduct = -decimalMAX;
-		for (uint16 i = 0, len = this->vertices.size(); i < len; i++) {
+		return Vec3((octant & 1) ? decimal(1.0) : decimal(-1.0), (octant & 2) ? decimal(1.0) : decimal(-1.0), (octant & 4) ? decimal(1.0) : decimal(-1.0));
+	}
 
-			decimal dot = dotProduct(direction, this->vertices[i]);
-			if (dot > maxDotProduct) {
-				support = this->vertices[i];
-				maxDotProduct = dot;
+	static byte octantIndex(const Vec3& direction)
+	{
+		return (direction.x >= decimal(0.0) ? 1 : 0) | (direction.y >= decimal(0.0) ? 2 : 0) | (direction.z >= decimal(0.0) ? 4 : 0);
+	}
+
+	void ConvexHull::buildAdjacency()
+	{
+		this->adjacency.clear();
+		this->adjacencyOffsets.clear();
+
+		uint16 numVertices = this->vertices.size();
+		if (numVertices < HILL_CLIMBING_THRESHOLD) return;
+
+		//every half edge leaves its vertex once, so the outgoing half edges of a vertex list each neighbour exactly once
+		this->adjacencyOffsets.reserve(numVertices + 1);
+		for (uint16 x = 0; x <= numVertices; ++x) {
+			this->adjacencyOffsets[x] = 0;
+		}
+		for (uint16 x = 0, len = this->halfEdgeMesh.edges.size(); x < len; ++x) {
+			++this->adjacencyOffsets[this->halfEdgeMesh.edges[x].vertIndex + 1];
+		}
+		for (uint16 x = 0; x < numVertices; ++x) {
+			this->adjacencyOffsets[x + 1] += this->adjacencyOffsets[x];
+		}
+
+		DynamicArray<uint16, uint16> cursor(this->adjacencyOffsets);
+		this->adjacency.reserve(this->halfEdgeMesh.edges.size());
+		for (uint16 x = 0, len = this->halfEdgeMesh.edges.size(); x < len; ++x) {
+			const HalfEdgeMesh::hEdge& e = this->halfEdgeMesh.edges[x];
+			this->adjacency[cursor[e.vertIndex]++] = this->halfEdgeMesh.edges[e.nextIndex].vertIndex;
+		}
+
+		for (byte x = 0; x < 8; ++x) {
+
+			Vec3 dir = octantDirection(x);
+			decimal maxDotProduct = -decimalMAX;
+			for (uint16 y = 0; y < numVertices; ++y) {
+
+				decimal dot = dotProduct(dir, this->vertices[y]);
+				if (dot > maxDotProduct) {
+					this->supportHints[x] = y;
+					maxDotProduct = dot;
+				}
+			}
+		}
+	}
+
+	uint16 ConvexHull::getSupportIndex(const Vec3& direction) const
+	{
+		if (this->adjacency.empty()) {
+
+			uint16 support = 0;
+			decimal maxDotProduct = -decimalMAX;
+			for (uint16 i = 0, len = this->vertices.size(); i < len; i++) {
+
+				decimal dot = dotProduct(direction, this->vertices[i]);
+				if (dot > maxDotProduct) {
+					support = i;
+					maxDotProduct = dot;
+				}
+			}
+
+			return support;
+		}
+
+		return this->getSupportIndex(direction, this->supportHints[octantIndex(direction)]);
+	}
+
+	uint16 ConvexHull::getSupportIndex(const Vec3& direction, const uint16& startIndex) const
+	{
+		//a linear function has no local maxima on a convex polytope other than the global one, so walking uphill is enough
+		uint16 current = startIndex;
+		decimal maxDotProduct = dotProduct(direction, this->vertices[current]);
+
+		bool improved = true;
+		while (improved) {
+
+			improved = false;
+			for (uint16 x = this->adjacencyOffsets[current], end = this->adjacencyOffsets[current + 1]; x < end; ++x) {
+
+				decimal dot = dotProduct(direction, this->vertices[this->adjacency[x]]);
+				if (dot > maxDotProduct) {
+					maxDotProduct = dot;
+					current = this->adjacency[x];
+					improved = true;
+				}
 			}
 		}
 
-		return support;
+		return current;
+	}
+
+	Vec3 ConvexHull::getSupportPoint(const Vec3& direction) const
+	{
+		return this->vertices[this->getSupportIndex(direction)];
+	}
+
+	Vec3 ConvexHull::getSupportPoint(const Vec3& direction, uint16& hint) const
+	{
+		if (this->adjacency.empty() || hint >= this->vertices.size()) {
+			hint = this->getSupportIndex(direction);
+		}
+		else {
+			hint = this->getSupportIndex(direction, hint);
+		}
+
+		return this->vertices[hint];
 	}
 
 	void ConvexHull::getSupportPoints(const Vec3& direction, Vec3& min, Vec3& max) const
 	{
+		if (this->adjacency.empty() == false) {
+			min = this->vertices[this->getSupportIndex(-direction)];
+			max = this->vertices[this->getSupportIndex(direction)];
+			return;
+		}
+
 		decimal d1 = -decimalMAX;
 		decimal d2 = decimalMAX;
 		for (uint16 i = 0, len = this->vertices.size(); i < len; i++) {
@@ -429,6 +535,13 @@ namespace mech {
 		for (uint16 i = 0, len = this->vertices.size(); i < len; i++) {
 			this->vertices[i] = t * this->vertices[i];
 		}
+
+		//rotation moves the extreme vertices only a few steps along the surface, so the hints are refreshed by climbing from the old ones
+		if (this->adjacency.empty() == false) {
+			for (byte x = 0; x < 8; ++x) {
+				this->supportHints[x] = this->getSupportIndex(octantDirection(x), this->supportHints[x]);
+			}
+		}
 	}
 
 	ConvexHull ConvexHull::transformed(const Transform3D& t) const
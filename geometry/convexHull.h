@@ -99,6 +99,9 @@ namespace mech {
 		}
 	};
 
+//hulls with fewer vertices than this use a linear scan for support queries
+#define HILL_CLIMBING_THRESHOLD 32
+
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -107,11 +110,22 @@ namespace mech {
 		HalfEdgeMesh halfEdgeMesh;
 		HybridArray<Vec3, 8, uint32> vertices;
 
+		//vertex adjacency for hill climbing, only built for hulls with at least HILL_CLIMBING_THRESHOLD vertices
+		DynamicArray<uint16, uint16> adjacency; //neighbours of vertex i are adjacency[adjacencyOffsets[i]] to adjacency[adjacencyOffsets[i + 1] - 1]
+		DynamicArray<uint16, uint16> adjacencyOffsets;
+		uint16 supportHints[8] = {}; //support vertex along the diagonal of each direction octant, where hill climbing starts
+
 		ConvexHull() {}
 		explicit ConvexHull(const HybridArray<Polygon, 6, uint16>& polygons);
 		~ConvexHull() {};
 
+		void buildAdjacency();
+
+		uint16 getSupportIndex(const Vec3& direction) const;
+		uint16 getSupportIndex(const Vec3& direction, const uint16& startIndex) const;
+
 		Vec3 getSupportPoint(const Vec3& direction) const;
+		Vec3 getSupportPoint(const Vec3& direction, uint16& hint) const; //starts from and updates a caller owned hint, e.g one per manifold
 		void getSupportPoints(const Vec3& direction, Vec3& min, Vec3& max) const;
 
 		AABB toAABB();
@@ -101,6 +101,29 @@ namespace mech {
 
 		String toString() const { return "Ray(origin:" + this->origin.toString() + " direction:" + this->direction.toString() + ")"; }
 	};
+
+	//distance along a ray at which it enters the box, 0 when it starts inside and -1 when it misses the box or reaches it past maxT
+	inline decimal rayEntryTime(const Vec3& origin, const Vec3& inverseDirection, const Vec3& min, const Vec3& max, const decimal& maxT)
+	{
+		decimal tx1 = (min.x - origin.x) * inverseDirection.x;
+		decimal tx2 = (max.x - origin.x) * inverseDirection.x;
+		decimal ty1 = (min.y - origin.y) * inverseDirection.y;
+		decimal ty2 = (max.y - origin.y) * inverseDirection.y;
+		decimal tz1 = (min.z - origin.z) * inverseDirection.z;
+		decimal tz2 = (max.z - origin.z) * inverseDirection.z;
+
+		decimal tmin = mathMAX(mathMAX(mathMIN(tx1, tx2), mathMIN(ty1, ty2)), mathMIN(tz1, tz2));
+		decimal tmax = mathMIN(mathMIN(mathMAX(tx1, tx2), mathMAX(ty1, ty2)), mathMAX(tz1, tz2));
+
+		if (tmin > tmax || tmax < decimal(0.0) || tmin > maxT) return decimal(-1.0);
+
+		return mathMAX(tmin, decimal(0.0));
+	}
+
+	inline Vec3 getInverseDirection(const Ray& ray)
+	{
+		return Vec3(decimal(1.0) / ray.direction.x, decimal(1.0) / ray.direction.y, decimal(1.0) / ray.direction.z);
+	}
 }
 
 #endif
@@ -0,0 +1,162 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+
+#include"ray.h"
+#include"triangle.h"
+#include"../math/simd.h"
+
+namespace mech {
+
+#define RAY_PACKET_SIZE 4
+#define RAY_PACKET_ALL_LANES 0xF
+#define RAY_PACKET_COHERENCE 0.9 //smallest cosine between the first ray of a packet and the others
+
+	/*
+		four rays traced together in single precision, origins and directions are stored a component per Float4 so a box or a triangle
+		is tested against every lane at once. lane x of a mask is bit x, activeMask holds the lanes still being traced.
+		results are as precise as the single precision BVH bounds and height samples the packets are tested against
+	*/
+	struct RayPacket {
+
+		Ray rays[RAY_PACKET_SIZE];
+		Float4 origin[3];
+		Float4 direction[3];
+		Float4 inverseDirection[3];
+		int32 activeMask = 0;
+
+		RayPacket() {}
+		explicit RayPacket(const Ray* packetRays, const int32& mask = RAY_PACKET_ALL_LANES)
+		{
+			float o[3][RAY_PACKET_SIZE];
+			float d[3][RAY_PACKET_SIZE];
+			float inverse[3][RAY_PACKET_SIZE];
+
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+				this->rays[lane] = packetRays[lane];
+				for (byte i = 0; i < 3; ++i) {
+					o[i][lane] = (float)packetRays[lane].origin[i];
+					d[i][lane] = (float)packetRays[lane].direction[i];
+					inverse[i][lane] = float(1.0) / d[i][lane];
+				}
+			}
+
+			for (byte i = 0; i < 3; ++i) {
+				this->origin[i] = Float4::load(o[i]);
+				this->direction[i] = Float4::load(d[i]);
+				this->inverseDirection[i] = Float4::load(inverse[i]);
+			}
+			this->activeMask = mask;
+		}
+
+		//slab test of every active lane, entry is 0 for lanes starting inside the box. returns the lanes reaching the box before their maxT
+		int32 entryTimes(const Vec3f& min, const Vec3f& max, const Float4& maxT, Float4& entry) const
+		{
+			Float4 t1 = (Float4(min.x) - this->origin[0]) * this->inverseDirection[0];
+			Float4 t2 = (Float4(max.x) - this->origin[0]) * this->inverseDirection[0];
+			Float4 tmin = minLanes(t1, t2);
+			Float4 tmax = maxLanes(t1, t2);
+
+			t1 = (Float4(min.y) - this->origin[1]) * this->inverseDirection[1];
+			t2 = (Float4(max.y) - this->origin[1]) * this->inverseDirection[1];
+			tmin = maxLanes(tmin, minLanes(t1, t2));
+			tmax = minLanes(tmax, maxLanes(t1, t2));
+
+			t1 = (Float4(min.z) - this->origin[2]) * this->inverseDirection[2];
+			t2 = (Float4(max.z) - this->origin[2]) * this->inverseDirection[2];
+			tmin = maxLanes(tmin, minLanes(t1, t2));
+			tmax = minLanes(tmax, maxLanes(t1, t2));
+
+			entry = maxLanes(tmin, Float4(float(0.0)));
+			Float4 hit = andLanes(andLanes(lessEqual(tmin, tmax), greaterEqual(tmax, Float4(float(0.0)))), lessEqual(entry, maxT));
+			return getMask(hit) & this->activeMask;
+		}
+
+		//Moller-Trumbore against every active lane, returns the lanes hitting the triangle at or before their maxT
+		int32 rayCastTimes(const Triangle& triangle, const Float4& maxT, Float4& t) const
+		{
+			Float4 a[3];
+			Float4 e1[3];
+			Float4 e2[3];
+			for (byte i = 0; i < 3; ++i) {
+				a[i] = Float4((float)triangle.a[i]);
+				e1[i] = Float4((float)(triangle.b[i] - triangle.a[i]));
+				e2[i] = Float4((float)(triangle.c[i] - triangle.a[i]));
+			}
+
+			Float4 p[3];
+			cross(this->direction, e2, p);
+			Float4 det = dot(e1, p);
+			Float4 inverseDet = Float4(float(1.0)) / det;
+
+			Float4 s[3] = { this->origin[0] - a[0], this->origin[1] - a[1], this->origin[2] - a[2] };
+			Float4 u = dot(s, p) * inverseDet;
+
+			Float4 q[3];
+			cross(s, e1, q);
+			Float4 v = dot(this->direction, q) * inverseDet;
+			t = dot(e2, q) * inverseDet;
+
+			Float4 epsilon = Float4((float)mathEPSILON);
+			Float4 one = Float4(float(1.0)) + epsilon;
+			Float4 zero = Float4(float(0.0));
+
+			Float4 hit = lessThan(epsilon * epsilon, det * det);
+			hit = andLanes(hit, andLanes(greaterEqual(u, zero - epsilon), lessEqual(u, one)));
+			hit = andLanes(hit, andLanes(greaterEqual(v, zero - epsilon), lessEqual(u + v, one)));
+			hit = andLanes(hit, andLanes(greaterEqual(t, zero), lessEqual(t, maxT)));
+			return getMask(hit) & this->activeMask;
+		}
+
+		//rays pointing into the same octant within RAY_PACKET_COHERENCE of each other, they mostly visit the same nodes
+		static bool isCoherent(const Ray* packetRays)
+		{
+			for (byte lane = 1; lane < RAY_PACKET_SIZE; ++lane) {
+				for (byte i = 0; i < 3; ++i) {
+					if ((packetRays[lane].direction[i] < decimal(0.0)) != (packetRays[0].direction[i] < decimal(0.0))) return false;
+				}
+				if (dotProduct(packetRays[lane].direction, packetRays[0].direction) < decimal(RAY_PACKET_COHERENCE)) return false;
+			}
+			return true;
+		}
+
+	private:
+
+		static Float4 dot(const Float4* a, const Float4* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+		static void cross(const Float4* a, const Float4* b, Float4* r)
+		{
+			r[0] = a[1] * b[2] - a[2] * b[1];
+			r[1] = a[2] * b[0] - a[0] * b[2];
+			r[2] = a[0] * b[1] - a[1] * b[0];
+		}
+	};
+}
+
+#endif
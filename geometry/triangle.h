@@ -30,6 +30,7 @@
 
 #include"../math/vec.h"
 #include"../containers/stackArray.h"
+#include"../containers/hybridArray.h"
 
 namespace mech {
 	
@@ -99,6 +100,18 @@ namespace mech {
 
 		String toString() const { return "Triangle(a:" + this->a.toString() + " b:" + this->b.toString() + " c:" + this->c.toString() + ")"; }
 	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	//visitor for forEachTriangleOverlapped queries that keeps every triangle handed to it
+	struct TriangleCollector {
+		HybridArray<Triangle, 24, uint16>& triangles;
+
+		bool visit(const Triangle& triangle)
+		{
+			this->triangles.pushBack(triangle);
+			return true;
+		}
+	};
 }
 
 #endif
\ No newline at end of file
@@ -33,149 +33,794 @@
 
 namespace mech {
 
+#define SAH_BINS 12
+#define MAXIMUM_TRIANGLES_PER_LEAF 16 //leaves are split past this even when the heuristic prefers not to
+#define ALIGN_16(offset) (((uint32)(offset) + 15) & ~(uint32)15)
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	void TriangleMesh::BVH::Node::setBound(const AABB& aabb)
+	{
+		//single precision bounds have to contain the double precision ones
+		for (byte x = 0; x < 3; ++x) {
+			float mn = (float)aabb.min[x];
+			float mx = (float)aabb.max[x];
+			if ((decimal)mn > aabb.min[x]) mn = nextafterf(mn, -FLT_MAX);
+			if ((decimal)mx < aabb.max[x]) mx = nextafterf(mx, FLT_MAX);
+			this->min.mat.data[x] = mn;
+			this->max.mat.data[x] = mx;
+		}
+	}
+
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	void TriangleMesh::BVH::create(decimal* triangleData, const uint32& numberOfTriangles, const Vec3& minimumSizeOfBVHNode)
+	void TriangleMesh::BVH::create(const decimal* triangleData, const uint32& numberOfTriangles, const byte& maxTrianglesPerLeaf)
 	{
 		struct TaskExecutor {
-			
-			AABB getMinimumAABB(decimal* triangles, const uint32& numOfTriangles)
+
+			BVH* bvh = nullptr;
+			DynamicArray<AABB, uint32> bounds; //per triangle
+			DynamicArray<Vec3, uint32> centroids; //per triangle
+			byte maxTrianglesPerLeaf = 4;
+
+			static AABB emptyAABB() { return AABB(Vec3(decimalMAX), Vec3(-decimalMAX)); }
+
+			static void grow(AABB& aabb, const AABB& other)
 			{
-				AABB aabb(Vec3(triangles[0], triangles[1], triangles[2]), Vec3(triangles[0], triangles[1], triangles[2]));
-				for (uint32 x = 3, len = numOfTriangles * 9; x < len; x += 3) {
-					Vec3 v = Vec3(triangles[x + 0], triangles[x + 1], triangles[x + 2]);
-					aabb.min = minVec(v, aabb.min);
-					aabb.max = maxVec(v, aabb.max);
-				}
-				return aabb;
+				aabb.min = minVec(aabb.min, other.min);
+				aabb.max = maxVec(aabb.max, other.max);
 			}
 
-			void process(BVH* bvh, const uint16& nodeIndex, const decimal* triangles, const uint32& numOfTriangles, const Vec3& limit)
+			static decimal surfaceArea(const AABB& aabb)
 			{
-				for (byte x = 0; x < 8; ++x) {
+				Vec3 d = aabb.max - aabb.min;
+				return decimal(2.0) * (d.x * d.y + d.y * d.z + d.z * d.x);
+			}
 
-					uint32 childIndex = bvh->nodes.size();
-					bvh->nodes.pushBack(Node(bvh->nodes[nodeIndex].bound.partitionTo8(x)));
-					bvh->nodes[nodeIndex].children.pushBack(childIndex);
-					BVH::Node* newNode = &bvh->nodes.back();
-					newNode->parent = nodeIndex;
+			void process(const uint32& nodeIndex, const uint32& first, const uint32& count, const byte& depth)
+			{
+				AABB bound = emptyAABB();
+				AABB centroidBound = emptyAABB();
+				for (uint32 x = first, end = first + count; x < end; ++x) {
+					uint32 t = this->bvh->triangleIndices[x];
+					grow(bound, this->bounds[t]);
+					grow(centroidBound, AABB(this->centroids[t], this->centroids[t]));
+				}
+				this->bvh->nodes[nodeIndex].setBound(bound);
+
+				if (count <= this->maxTrianglesPerLeaf || depth >= MAXIMUM_BVH_DEPTH - 1) {
+					this->makeLeaf(nodeIndex, first, count);
+					return;
+				}
 
-					Vec3 dimensions = newNode->bound.getDimensions();
-					if (dimensions.x > limit.x && dimensions.y > limit.y && dimensions.z > limit.z) {
-						process(bvh, childIndex, triangles, numOfTriangles, limit);
+				//binned surface area heuristic, a traversal step costs as much as a triangle test
+				decimal bestCost = decimalMAX;
+				byte bestAxis = -1;
+				byte bestSplit = 0;
+				decimal invArea = decimal(1.0) / mathMAX(surfaceArea(bound), mathEPSILON);
+
+				for (byte axis = 0; axis < 3; ++axis) {
+
+					decimal extent = centroidBound.max[axis] - centroidBound.min[axis];
+					if (extent <= mathEPSILON) continue;
+
+					AABB binBounds[SAH_BINS];
+					uint32 binCounts[SAH_BINS] = {};
+					for (byte x = 0; x < SAH_BINS; ++x) {
+						binBounds[x] = emptyAABB();
 					}
-					else {
-						for (uint32 y = 0, len = numOfTriangles * 9; y < len; y += 9) {
-							Vec3 a = Vec3(triangles[y + 0], triangles[y + 1], triangles[y + 2]);
-							Vec3 b = Vec3(triangles[y + 3], triangles[y + 4], triangles[y + 5]);
-							Vec3 c = Vec3(triangles[y + 6], triangles[y + 7], triangles[y + 8]);
-							if (newNode->bound.intersects(Triangle(a, b, c))) {
-								newNode->indicies.pushBack(y);
-							}
+
+					for (uint32 x = first, end = first + count; x < end; ++x) {
+						uint32 t = this->bvh->triangleIndices[x];
+						byte bin = this->getBin(this->centroids[t][axis], centroidBound.min[axis], extent);
+						++binCounts[bin];
+						grow(binBounds[bin], this->bounds[t]);
+					}
+
+					decimal leftAreas[SAH_BINS - 1];
+					uint32 leftCounts[SAH_BINS - 1];
+					AABB left = emptyAABB();
+					uint32 leftCount = 0;
+					for (byte x = 0; x < SAH_BINS - 1; ++x) {
+						grow(left, binBounds[x]);
+						leftCount += binCounts[x];
+						leftAreas[x] = leftCount > 0 ? surfaceArea(left) : decimal(0.0);
+						leftCounts[x] = leftCount;
+					}
+
+					AABB right = emptyAABB();
+					uint32 rightCount = 0;
+					for (byte x = SAH_BINS - 1; x > 0; --x) {
+						grow(right, binBounds[x]);
+						rightCount += binCounts[x];
+
+						if (leftCounts[x - 1] == 0 || rightCount == 0) continue;
+
+						decimal cost = decimal(1.0) + (leftAreas[x - 1] * leftCounts[x - 1] + surfaceArea(right) * rightCount) * invArea;
+						if (cost < bestCost) {
+							bestCost = cost;
+							bestAxis = axis;
+							bestSplit = x;
+						}
+					}
+				}
+
+				uint32 middle = first;
+				if (isAValidIndex(bestAxis)) {
+
+					if (bestCost >= decimal(count) && count <= MAXIMUM_TRIANGLES_PER_LEAF) {
+						this->makeLeaf(nodeIndex, first, count);
+						return;
+					}
+
+					decimal extent = centroidBound.max[bestAxis] - centroidBound.min[bestAxis];
+					for (uint32 x = first, end = first + count; x < end; ++x) {
+						uint32 t = this->bvh->triangleIndices[x];
+						if (this->getBin(this->centroids[t][bestAxis], centroidBound.min[bestAxis], extent) < bestSplit) {
+							this->bvh->triangleIndices[x] = this->bvh->triangleIndices[middle];
+							this->bvh->triangleIndices[middle] = t;
+							++middle;
 						}
 					}
 				}
+				else {
+					//every centroid is in the same place
+					if (count <= MAXIMUM_TRIANGLES_PER_LEAF) {
+						this->makeLeaf(nodeIndex, first, count);
+						return;
+					}
+					middle = first + count / 2;
+				}
+
+				uint32 children = this->bvh->nodes.size();
+				this->bvh->nodes.pushBack(Node());
+				this->bvh->nodes.pushBack(Node());
+				this->bvh->nodes[nodeIndex].index = children;
+
+				this->process(children, first, middle - first, depth + 1);
+				this->process(children + 1, middle, first + count - middle, depth + 1);
+			}
+
+			byte getBin(const decimal& centroid, const decimal& min, const decimal& extent)
+			{
+				uint32 bin = (uint32)((centroid - min) * decimal(SAH_BINS) / extent);
+				return (byte)(bin < SAH_BINS ? bin : SAH_BINS - 1);
 			}
 
-			void clean(BVH* bvh)
+			void makeLeaf(const uint32& nodeIndex, const uint32& first, const uint32& count)
 			{
-				for (uint32 x = 0, len = bvh->nodes.size(); x < len; ++x) {
+				this->bvh->nodes[nodeIndex].index = first;
+				this->bvh->nodes[nodeIndex].count = count;
+			}
+		};
+
+		this->nodes.clear();
+		this->triangleIndices.clear();
+		if (numberOfTriangles == 0) return;
 
-					if (bvh->nodes[x].indicies.empty() && bvh->nodes[x].children.empty()) {
-							
-						bvh->nodes[bvh->nodes[x].parent].children.eraseData(x);
-						bvh->nodes.eraseDataAtIndex(x);
+		TaskExecutor ex;
+		ex.bvh = this;
+		ex.maxTrianglesPerLeaf = maxTrianglesPerLeaf;
+
+		for (uint32 x = 0; x < numberOfTriangles; ++x) {
+
+			const decimal* t = triangleData + x * 9;
+			Vec3 a = Vec3(t[0], t[1], t[2]);
+			Vec3 b = Vec3(t[3], t[4], t[5]);
+			Vec3 c = Vec3(t[6], t[7], t[8]);
+
+			ex.bounds.pushBack(AABB(minVec(a, minVec(b, c)), maxVec(a, maxVec(b, c))));
+			ex.centroids.pushBack((a + b + c) / decimal(3.0));
+			this->triangleIndices.pushBack(x);
+		}
+
+		this->nodes.pushBack(Node());
+		ex.process(0, 0, numberOfTriangles, 0);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//surface area heuristic cost of a tree relative to its root, a traversal step costs as much as a triangle test
+	static decimal treeCost(const TriangleMesh::BVH::Node* nodes, const uint32& numOfNodes)
+	{
+		struct TaskExecutor {
+			static decimal surfaceArea(const TriangleMesh::BVH::Node& node)
+			{
+				decimal dx = node.max.x - node.min.x;
+				decimal dy = node.max.y - node.min.y;
+				decimal dz = node.max.z - node.min.z;
+				return decimal(2.0) * (dx * dy + dy * dz + dz * dx);
+			}
+		};
 
-						uint16 last = len - 1;
-						if (x != last) {
-							bvh->nodes[bvh->nodes[x].parent].children.eraseData(last);
-							bvh->nodes[bvh->nodes[x].parent].children.pushBack(x);
+		if (numOfNodes == 0) return decimal(0.0);
 
-							for (auto it = bvh->nodes[x].children.begin(), end = bvh->nodes[x].children.end(); it != end; ++it) {
-								bvh->nodes[it.data()].parent = x;
+		decimal cost = decimal(0.0);
+		for (uint32 x = 0; x < numOfNodes; ++x) {
+			cost += TaskExecutor::surfaceArea(nodes[x]) * (nodes[x].isLeaf() ? decimal(nodes[x].count) : decimal(1.0));
+		}
+
+		return cost / mathMAX(TaskExecutor::surfaceArea(nodes[0]), mathEPSILON);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	TriangleMesh::TriangleMesh(const decimal* triangleData, const uint32& numberOfTriangles, const TriangleMeshCookingOptions& options)
+	{
+		DynamicArray<byte, uint32> cookedData;
+		TriangleMesh::cook(cookedData, triangleData, numberOfTriangles, nullptr, options);
+		this->load(cookedData);
+	}
+
+	void TriangleMesh::cook(DynamicArray<byte, uint32>& cookedData, const decimal* triangleData, const uint32& numberOfTriangles, const byte* triangleFlags, const TriangleMeshCookingOptions& options)
+	{
+		//exact duplicates are welded
+		struct Vertex {
+			Vec3 position;
+			uint32 index = -1;
+
+			Vertex() {}
+			Vertex(const Vec3& p, const uint32& i) : position(p), index(i) {}
+
+			bool operator<(const Vertex& other) const
+			{
+				if (this->position.x != other.position.x) return this->position.x < other.position.x;
+				if (this->position.y != other.position.y) return this->position.y < other.position.y;
+				return this->position.z < other.position.z;
+			}
+
+			bool operator>(const Vertex& other) const { return other < *this; }
+		};
+
+		BVH bvh;
+		bvh.create(triangleData, numberOfTriangles, options.maxTrianglesPerLeaf);
+
+		DynamicArray<byte, uint32> vertices;
+		DynamicArray<uint32, uint32> triangles;
+		DynamicArray<uint32, uint32> leafVertices;
+		DynamicArray<byte, uint32> flags;
+		uint32 numOfVertices = 0;
+
+		CookedTriangleMeshHeader header;
+		Vec3 boundMin = Vec3(decimalMAX);
+		Vec3 boundMax = Vec3(-decimalMAX);
+
+		if (options.quantiseVertices) {
+
+			//every leaf gets its own vertices, so the indices stay small and the offsets are relative to the leaf bound
+			DynamicArray<Vertex, uint32> local;
+			for (uint32 n = 0, len = bvh.nodes.size(); n < len; ++n) {
+
+				const BVH::Node& node = bvh.nodes[n];
+				leafVertices.pushBack(numOfVertices);
+				if (node.isLeaf() == false) continue;
+
+				Vec3 min = Vec3(node.min.x, node.min.y, node.min.z);
+				Vec3 extent = Vec3(node.max.x, node.max.y, node.max.z) - min;
+				Vec3 scale;
+				for (byte y = 0; y < 3; ++y) {
+					scale[y] = extent[y] > decimal(0.0) ? decimal(65535.0) / extent[y] : decimal(0.0);
+				}
+
+				local.clear();
+				for (uint32 x = node.index, end = node.index + node.count; x < end; ++x) {
+					for (byte y = 0; y < 3; ++y) {
+
+						const decimal* v = triangleData + bvh.triangleIndices[x] * 9 + y * 3;
+						Vertex vertex = Vertex(Vec3(v[0], v[1], v[2]), local.size());
+
+						uint32 found = -1;
+						for (uint32 z = 0, count = local.size(); z < count; ++z) {
+							if (!(local[z] < vertex) && !(local[z] > vertex)) {
+								found = z;
+								break;
 							}
 						}
 
-						--x;
-						--len;
+						if (isAValidIndex(found)) {
+							triangles.pushBack(found);
+							continue;
+						}
+
+						local.pushBack(vertex);
+						triangles.pushBack(vertex.index);
+						boundMin = minVec(vertex.position, boundMin);
+						boundMax = maxVec(vertex.position, boundMax);
+
+						uint16 q[3];
+						for (byte z = 0; z < 3; ++z) {
+							q[z] = (uint16)(mathMIN(decimal(65535.0), mathMAX(decimal(0.0), (vertex.position[z] - min[z]) * scale[z])) + decimal(0.5));
+						}
+						vertices.pushBack((const byte*)q, sizeof(q));
+						++numOfVertices;
 					}
 				}
+
+				ASSERT(local.size() <= 0xFFFF, "too many vertices in a leaf");
 			}
-		};
-		
-		TaskExecutor ex;
 
-		this->parentNode = 0;
-		this->nodes.pushBack(Node(ex.getMinimumAABB(triangleData, numberOfTriangles)));
+			header.formatFlags |= 1 | 2;
+		}
+		else {
+
+			AVLTree<Vertex, uint32> welded;
+			for (uint32 x = 0, len = bvh.triangleIndices.size(); x < len; ++x) {
+				for (byte y = 0; y < 3; ++y) {
+
+					const decimal* v = triangleData + bvh.triangleIndices[x] * 9 + y * 3;
+					Vertex vertex = Vertex(Vec3(v[0], v[1], v[2]), numOfVertices);
+
+					Vertex* found = welded.find(vertex);
+					if (found != nullptr) {
+						triangles.pushBack(found->index);
+					}
+					else {
+						welded.insert(vertex);
+						vertices.pushBack((const byte*)v, sizeof(decimal) * 3);
+						triangles.pushBack(vertex.index);
+						++numOfVertices;
+
+						boundMin = minVec(vertex.position, boundMin);
+						boundMax = maxVec(vertex.position, boundMax);
+					}
+				}
+			}
+
+			if (numOfVertices <= 0xFFFF) {
+				header.formatFlags |= 2;
+			}
+		}
+
+		for (uint32 x = 0, len = bvh.triangleIndices.size(); x < len; ++x) {
+			flags.pushBack(triangleFlags == nullptr ? (byte)0 : triangleFlags[bvh.triangleIndices[x]]);
+		}
+
+		if (options.deformable) {
+			header.formatFlags |= 4;
+		}
+
+		header.maxTrianglesPerLeaf = options.maxTrianglesPerLeaf;
+		header.buildCost = treeCost(bvh.nodes.data(), bvh.nodes.size());
+		header.numOfVertices = numOfVertices;
+		header.numOfTriangles = numberOfTriangles;
+		header.numOfNodes = bvh.nodes.size();
+		for (byte x = 0; x < 3; ++x) {
+			header.boundMin[x] = boundMin[x];
+			header.boundMax[x] = boundMax[x];
+		}
+
+		uint32 indexSize = header.has16BitIndices() ? sizeof(uint16) : sizeof(uint32);
+		header.verticesOffset = ALIGN_16(sizeof(CookedTriangleMeshHeader));
+		header.trianglesOffset = ALIGN_16(header.verticesOffset + vertices.size());
+		header.nodesOffset = ALIGN_16(header.trianglesOffset + triangles.size() * indexSize);
+		header.leafVerticesOffset = ALIGN_16(header.nodesOffset + bvh.nodes.size() * sizeof(BVH::Node));
+		header.flagsOffset = ALIGN_16(header.leafVerticesOffset + leafVertices.size() * sizeof(uint32));
+		header.sourceTrianglesOffset = ALIGN_16(header.flagsOffset + flags.size());
+		header.sizeInBytes = ALIGN_16(header.sourceTrianglesOffset + (header.isDeformable() ? bvh.triangleIndices.size() * sizeof(uint32) : 0));
+
+		cookedData.clear();
+		cookedData.reserve(header.sizeInBytes);
+		byte* data = cookedData.data();
+		std::memset(data, 0, header.sizeInBytes);
+
+		std::memcpy(data, &header, sizeof(CookedTriangleMeshHeader));
+		if (numberOfTriangles == 0) return;
+
+		std::memcpy(data + header.verticesOffset, vertices.data(), vertices.size());
+		if (header.has16BitIndices()) {
+			uint16* indices = (uint16*)(data + header.trianglesOffset);
+			for (uint32 x = 0, len = triangles.size(); x < len; ++x) {
+				indices[x] = (uint16)triangles[x];
+			}
+		}
+		else {
+			std::memcpy(data + header.trianglesOffset, triangles.data(), triangles.size() * sizeof(uint32));
+		}
+		std::memcpy(data + header.nodesOffset, bvh.nodes.data(), bvh.nodes.size() * sizeof(BVH::Node));
+		if (leafVertices.size() > 0) {
+			std::memcpy(data + header.leafVerticesOffset, leafVertices.data(), leafVertices.size() * sizeof(uint32));
+		}
+		std::memcpy(data + header.flagsOffset, flags.data(), flags.size());
+		if (header.isDeformable()) {
+			std::memcpy(data + header.sourceTrianglesOffset, bvh.triangleIndices.data(), bvh.triangleIndices.size() * sizeof(uint32));
+		}
+	}
+
+	bool TriangleMesh::isValidCookedData(const void* data, const uint64& sizeInBytes)
+	{
+		if (data == nullptr || ((uint64)data & 15) != 0 || sizeInBytes < sizeof(CookedTriangleMeshHeader)) return false;
+
+		const CookedTriangleMeshHeader& header = *(const CookedTriangleMeshHeader*)data;
+		if (header.magic != COOKED_TRIANGLE_MESH_MAGIC || header.version != COOKED_TRIANGLE_MESH_VERSION || header.decimalSize != sizeof(decimal)) return false;
+		if (header.sizeInBytes > sizeInBytes) return false;
+
+		uint64 vertexSize = header.hasQuantisedVertices() ? 3 * sizeof(uint16) : 3 * sizeof(decimal);
+		uint64 indexSize = header.has16BitIndices() ? sizeof(uint16) : sizeof(uint32);
+		uint64 leafVerticesSize = header.hasQuantisedVertices() ? (uint64)header.numOfNodes * sizeof(uint32) : 0;
+		uint64 sourceTrianglesSize = header.isDeformable() ? (uint64)header.numOfTriangles * sizeof(uint32) : 0;
+
+		bool sectionsFit = (uint64)header.verticesOffset + (uint64)header.numOfVertices * vertexSize <= header.sizeInBytes &&
+			(uint64)header.trianglesOffset + (uint64)header.numOfTriangles * 3 * indexSize <= header.sizeInBytes &&
+			(uint64)header.nodesOffset + (uint64)header.numOfNodes * sizeof(BVH::Node) <= header.sizeInBytes &&
+			(uint64)header.leafVerticesOffset + leafVerticesSize <= header.sizeInBytes &&
+			(uint64)header.flagsOffset + (uint64)header.numOfTriangles <= header.sizeInBytes &&
+			(uint64)header.sourceTrianglesOffset + sourceTrianglesSize <= header.sizeInBytes &&
+			(header.numOfTriangles == 0 || header.numOfNodes > 0);
+		if (sectionsFit == false) return false;
+		if (header.numOfTriangles == 0) return true;
+
+		//queries walk the data as it is, so every index they follow is checked once here
+		const byte* cookedData = (const byte*)data;
+		const BVH::Node* nodes = (const BVH::Node*)(cookedData + header.nodesOffset);
+		const uint32* leafVertices = (const uint32*)(cookedData + header.leafVerticesOffset);
+		const byte* triangles = cookedData + header.trianglesOffset;
+
+		//children come after their parent, which rules out cycles, and no path may be deeper than the traversal stacks allow
+		DynamicArray<byte, uint32> depths;
+		depths.reserve(header.numOfNodes);
+		for (uint32 x = 0; x < header.numOfNodes; ++x) {
+			depths.pushBack(0);
+		}
+
+		for (uint32 n = 0; n < header.numOfNodes; ++n) {
 
-		ex.process(this, this->parentNode, triangleData, numberOfTriangles, minimumSizeOfBVHNode);
-		ex.clean(this);
+			const BVH::Node& node = nodes[n];
+			if (node.isLeaf() == false) {
+				if (node.index <= n || (uint64)node.index + 1 >= header.numOfNodes || depths[n] >= MAXIMUM_BVH_DEPTH - 1) return false;
+				for (uint32 child = node.index; child < node.index + 2; ++child) {
+					depths[child] = depths[child] > depths[n] + 1 ? depths[child] : (byte)(depths[n] + 1);
+				}
+				continue;
+			}
+
+			if ((uint64)node.index + node.count > header.numOfTriangles) return false;
+
+			uint64 firstVertex = header.hasQuantisedVertices() ? leafVertices[n] : 0;
+			for (uint64 x = (uint64)node.index * 3, end = ((uint64)node.index + node.count) * 3; x < end; ++x) {
+				uint32 index = header.has16BitIndices() ? ((const uint16*)triangles)[x] : ((const uint32*)triangles)[x];
+				if (firstVertex + index >= header.numOfVertices) return false;
+			}
+		}
+
+		if (header.isDeformable()) {
+			const uint32* sourceTriangles = (const uint32*)(cookedData + header.sourceTrianglesOffset);
+			for (uint32 x = 0; x < header.numOfTriangles; ++x) {
+				if (sourceTriangles[x] >= header.numOfTriangles) return false;
+			}
+		}
+
+		return true;
 	}
 
-	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	TriangleMesh::TriangleMesh(decimal* triangleData, const uint32& numberOfTriangles, const Vec3& minimumSizeOfBVHNode) : triangles(triangleData), numOfTriangles(numberOfTriangles)
+	bool TriangleMesh::load(const DynamicArray<byte, uint32>& cookedData)
+	{
+		if (TriangleMesh::isValidCookedData(cookedData.data(), cookedData.size()) == false) return false;
+
+		this->externalData = nullptr;
+		this->cookedStorage = cookedData;
+		const CookedTriangleMeshHeader& header = this->getHeader();
+		this->bound = AABB(Vec3(header.boundMin[0], header.boundMin[1], header.boundMin[2]), Vec3(header.boundMax[0], header.boundMax[1], header.boundMax[2]));
+
+		return true;
+	}
+
+	bool TriangleMesh::loadInPlace(const void* data, const uint64& sizeInBytes)
 	{
-		bvh.create(this->triangles, this->numOfTriangles, minimumSizeOfBVHNode);
+		if (TriangleMesh::isValidCookedData(data, sizeInBytes) == false) return false;
+
+		this->cookedStorage.clear();
+		this->externalData = (const byte*)data;
+		const CookedTriangleMeshHeader& header = this->getHeader();
+		this->bound = AABB(Vec3(header.boundMin[0], header.boundMin[1], header.boundMin[2]), Vec3(header.boundMax[0], header.boundMax[1], header.boundMax[2]));
+
+		return true;
+	}
+
+	Triangle TriangleMesh::getTriangle(const uint32& leafIndex, const uint32& triangleIndex) const
+	{
+		const CookedTriangleMeshHeader& header = this->getHeader();
+
+		uint32 indices[3];
+		if (header.has16BitIndices()) {
+			const uint16* t = (const uint16*)this->getTriangles() + triangleIndex * 3;
+			indices[0] = t[0]; indices[1] = t[1]; indices[2] = t[2];
+		}
+		else {
+			const uint32* t = (const uint32*)this->getTriangles() + triangleIndex * 3;
+			indices[0] = t[0]; indices[1] = t[1]; indices[2] = t[2];
+		}
+
+		Vec3 v[3];
+		if (header.hasQuantisedVertices()) {
+
+			const BVH::Node& leaf = this->getNodes()[leafIndex];
+			const uint16* vertices = (const uint16*)this->getVertices() + this->getLeafVertices()[leafIndex] * 3;
+
+			Vec3 min = Vec3(leaf.min.x, leaf.min.y, leaf.min.z);
+			Vec3 step = (Vec3(leaf.max.x, leaf.max.y, leaf.max.z) - min) / decimal(65535.0);
+			for (byte x = 0; x < 3; ++x) {
+				const uint16* q = vertices + indices[x] * 3;
+				v[x] = min + Vec3(q[0] * step.x, q[1] * step.y, q[2] * step.z);
+			}
+		}
+		else {
+			const decimal* vertices = (const decimal*)this->getVertices();
+			for (byte x = 0; x < 3; ++x) {
+				const decimal* p = vertices + indices[x] * 3;
+				v[x] = Vec3(p[0], p[1], p[2]);
+			}
+		}
+
+		return Triangle(v[0], v[1], v[2]);
 	}
 
 	ConvexHull TriangleMesh::toConvexHull()
 	{
 		HybridArray<Polygon, 24, uint16> p;
-		for (uint32 x = 0, len = this->numOfTriangles * 9; x < len; x += 9) {
-			Vec3 a = Vec3(this->triangles[x + 0], this->triangles[x + 1], this->triangles[x + 2]);
-			Vec3 b = Vec3(this->triangles[x + 3], this->triangles[x + 4], this->triangles[x + 5]);
-			Vec3 c = Vec3(this->triangles[x + 6], this->triangles[x + 7], this->triangles[x + 8]);
-			p.pushBack(Triangle(a, b, c).toPolygon());
+		const BVH::Node* nodes = this->getNodes();
+		for (uint32 x = 0, len = this->getNumOfTriangles() > 0 ? this->getHeader().numOfNodes : 0; x < len; ++x) {
+			for (uint32 y = nodes[x].index, end = nodes[x].index + nodes[x].count; y < end; ++y) {
+				p.pushBack(this->getTriangle(x, y).toPolygon());
+			}
 		}
 
 		return ConvexHull(p);
 	}
 
-	bool TriangleMesh::intersects(const AABB& aabb)
+	bool TriangleMesh::intersects(const AABB& aabb) const
 	{
-		return this->bvh.nodes[this->bvh.parentNode].bound.intersects(aabb);
+		return this->isEmpty() == false && this->bound.intersects(aabb);
 	}
 
-	void TriangleMesh::getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles)
+	void TriangleMesh::getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles) const
 	{
-		struct TaskExecutor {
+		TriangleCollector collector = { triangles };
+		this->forEachTriangleOverlapped(aabb, collector);
+	}
 
-			void fetchIndices(TriangleMesh::BVH* bvh, const AABB& aabb, const uint16& nodeIndex, DynamicArray<uint32, uint32>& indicies)
-			{
-				for (auto it1 = bvh->nodes[nodeIndex].children.begin(), end1 = bvh->nodes[nodeIndex].children.end(); it1 != end1; ++it1) {
+	decimal TriangleMesh::rayCastTime(const Ray& ray, const decimal& maxT, Triangle& triangleHit, const bool& anyHit) const
+	{
+		if (this->getNumOfTriangles() == 0) return decimal(-1.0);
 
-					if (bvh->nodes[it1.data()].bound.intersects(aabb)) {
+		const BVH::Node* nodes = this->getNodes();
+		Vec3 inverseDirection = getInverseDirection(ray);
 
-						if (bvh->nodes[it1.data()].indicies.empty()) {
-							fetchIndices(bvh, aabb, it1.data(), indicies);
-						}
-						else {
-							for (auto it2 = bvh->nodes[it1.data()].indicies.begin(), end2 = bvh->nodes[it1.data()].indicies.end(); it2 != end2; ++it2) {
-								indicies.pushBack(it2.data());
-							}
+		decimal best = maxT;
+		bool found = false;
+
+		//the nearer child is pushed last so it is popped first, the stack never holds more than the depth plus one nodes
+		uint32 stack[MAXIMUM_BVH_DEPTH + 1];
+		decimal entries[MAXIMUM_BVH_DEPTH + 1];
+		byte size = 0;
+
+		decimal rootEntry = rayEntryTime(ray.origin, inverseDirection, Vec3(nodes[0].min.x, nodes[0].min.y, nodes[0].min.z), Vec3(nodes[0].max.x, nodes[0].max.y, nodes[0].max.z), best);
+		if (rootEntry < decimal(0.0)) return decimal(-1.0);
+		stack[size] = 0;
+		entries[size++] = rootEntry;
+
+		while (size > 0) {
+
+			--size;
+			if (entries[size] > best) continue;
+
+			uint32 nodeIndex = stack[size];
+			const BVH::Node& node = nodes[nodeIndex];
+
+			if (node.isLeaf()) {
+				for (uint32 x = node.index, end = node.index + node.count; x < end; ++x) {
+					Triangle t = this->getTriangle(nodeIndex, x);
+					decimal time = ray.rayCastTime(t);
+					if (time >= decimal(0.0) && time <= best) {
+						best = time;
+						triangleHit = t;
+						found = true;
+						if (anyHit) return best;
+					}
+				}
+			}
+			else {
+				const BVH::Node& child1 = nodes[node.index];
+				const BVH::Node& child2 = nodes[node.index + 1];
+				decimal t1 = rayEntryTime(ray.origin, inverseDirection, Vec3(child1.min.x, child1.min.y, child1.min.z), Vec3(child1.max.x, child1.max.y, child1.max.z), best);
+				decimal t2 = rayEntryTime(ray.origin, inverseDirection, Vec3(child2.min.x, child2.min.y, child2.min.z), Vec3(child2.max.x, child2.max.y, child2.max.z), best);
+
+				uint32 first = node.index;
+				uint32 second = node.index + 1;
+				if (t2 >= decimal(0.0) && (t1 < decimal(0.0) || t2 < t1)) {
+					decimal temp = t1;
+					t1 = t2;
+					t2 = temp;
+					first = node.index + 1;
+					second = node.index;
+				}
+
+				if (t2 >= decimal(0.0)) {
+					stack[size] = second;
+					entries[size++] = t2;
+				}
+				if (t1 >= decimal(0.0)) {
+					stack[size] = first;
+					entries[size++] = t1;
+				}
+			}
+		}
+
+		return found ? best : decimal(-1.0);
+	}
+
+	int32 TriangleMesh::rayCastPacket(const RayPacket& packet, float* maxT, Triangle* trianglesHit, const bool& anyHit) const
+	{
+		if (this->getNumOfTriangles() == 0) return 0;
+
+		const BVH::Node* nodes = this->getNodes();
+
+		Float4 best = Float4::load(maxT);
+		int32 active = packet.activeMask;
+		int32 hitMask = 0;
+
+		//nodes are tested when popped so they are culled against the hits found since they were pushed
+		uint32 stack[MAXIMUM_BVH_DEPTH + 1];
+		byte size = 0;
+		stack[size++] = 0;
+
+		while (size > 0 && active != 0) {
+
+			uint32 nodeIndex = stack[--size];
+			const BVH::Node& node = nodes[nodeIndex];
+
+			Float4 entry;
+			int32 lanes = packet.entryTimes(node.min, node.max, best, entry) & active;
+			if (lanes == 0) continue;
+
+			if (node.isLeaf()) {
+				for (uint32 x = node.index, end = node.index + node.count; x < end && lanes != 0; ++x) {
+
+					Triangle t = this->getTriangle(nodeIndex, x);
+
+					Float4 times;
+					int32 hits = packet.rayCastTimes(t, best, times) & lanes;
+					if (hits == 0) continue;
+
+					float laneTimes[RAY_PACKET_SIZE];
+					times.store(laneTimes);
+					for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+						if ((hits & (1 << lane)) != 0) {
+							maxT[lane] = laneTimes[lane];
+							trianglesHit[lane] = t;
 						}
 					}
+					best = Float4::load(maxT);
+					hitMask |= hits;
+
+					if (anyHit) {
+						active &= ~hits;
+						lanes &= ~hits;
+					}
 				}
 			}
-		};
+			else {
+				//the first lane still reaching the node picks the order, the nearer child is pushed last so it is popped first
+				byte lead = 0;
+				while ((lanes & (1 << lead)) == 0) ++lead;
+
+				const BVH::Node& child1 = nodes[node.index];
+				const BVH::Node& child2 = nodes[node.index + 1];
+				Vec3 offset = Vec3(child2.min.x + child2.max.x - child1.min.x - child1.max.x, child2.min.y + child2.max.y - child1.min.y - child1.max.y, child2.min.z + child2.max.z - child1.min.z - child1.max.z);
+
+				if (dotProduct(offset, packet.rays[lead].direction) < decimal(0.0)) {
+					stack[size++] = node.index;
+					stack[size++] = node.index + 1;
+				}
+				else {
+					stack[size++] = node.index + 1;
+					stack[size++] = node.index;
+				}
+			}
+		}
 
-		TaskExecutor ex;
-		DynamicArray<uint32, uint32> indicies;
+		return hitMask;
+	}
+
+	void TriangleMesh::refit(const decimal* triangleData)
+	{
+		ASSERT(this->cookedStorage.size() > 0 && this->getHeader().isDeformable(), "only deformable meshes owning their data can be refitted");
+
+		byte* data = this->cookedStorage.data();
+		CookedTriangleMeshHeader& header = *(CookedTriangleMeshHeader*)data;
+		if (header.numOfTriangles == 0) return;
+
+		BVH::Node* nodes = (BVH::Node*)(data + header.nodesOffset);
+		const uint32* sourceTriangles = (const uint32*)(data + header.sourceTrianglesOffset);
+		const uint32* leafVertices = (const uint32*)(data + header.leafVerticesOffset);
+		const byte* triangles = data + header.trianglesOffset;
 
-		ex.fetchIndices(&this->bvh, aabb, this->bvh.parentNode, indicies);
-		AVLTree<uint16, uint16> finished;
+		Vec3 boundMin = Vec3(decimalMAX);
+		Vec3 boundMax = Vec3(-decimalMAX);
 
-		for (uint32 x = 0, len = indicies.size(); x < len; ++x) {
+		//children are always stored after their parent, so walking backwards visits them first
+		for (uint32 n = header.numOfNodes; n-- > 0;) {
 
-			Vec3 a = Vec3(this->triangles[indicies[x] + 0], this->triangles[indicies[x] + 1], this->triangles[indicies[x] + 2]);
-			Vec3 b = Vec3(this->triangles[indicies[x] + 3], this->triangles[indicies[x] + 4], this->triangles[indicies[x] + 5]);
-			Vec3 c = Vec3(this->triangles[indicies[x] + 6], this->triangles[indicies[x] + 7], this->triangles[indicies[x] + 8]);
-			Triangle t = Triangle(a, b, c);
-			if (aabb.intersects(t)) {
-				if (finished.find(indicies[x]) == false) {
-					triangles.pushBack(t);
-					finished.insert(indicies[x]);
+			BVH::Node& node = nodes[n];
+			if (node.isLeaf() == false) {
+				AABB left = nodes[node.index].getBound();
+				AABB right = nodes[node.index + 1].getBound();
+				node.setBound(AABB(minVec(left.min, right.min), maxVec(left.max, right.max)));
+				continue;
+			}
+
+			Vec3 min = Vec3(decimalMAX);
+			Vec3 max = Vec3(-decimalMAX);
+			for (uint32 t = node.index, end = node.index + node.count; t < end; ++t) {
+				for (byte c = 0; c < 3; ++c) {
+					const decimal* v = triangleData + sourceTriangles[t] * 9 + c * 3;
+					min = minVec(Vec3(v[0], v[1], v[2]), min);
+					max = maxVec(Vec3(v[0], v[1], v[2]), max);
+				}
+			}
+			node.setBound(AABB(min, max));
+			boundMin = minVec(min, boundMin);
+			boundMax = maxVec(max, boundMax);
+
+			Vec3 leafMin = Vec3(node.min.x, node.min.y, node.min.z);
+			Vec3 scale;
+			for (byte y = 0; y < 3; ++y) {
+				decimal extent = decimal(node.max.mat.data[y]) - leafMin[y];
+				scale[y] = extent > decimal(0.0) ? decimal(65535.0) / extent : decimal(0.0);
+			}
+
+			for (uint32 t = node.index, end = node.index + node.count; t < end; ++t) {
+				for (byte c = 0; c < 3; ++c) {
+
+					const decimal* v = triangleData + sourceTriangles[t] * 9 + c * 3;
+					uint32 index = header.has16BitIndices() ? ((const uint16*)triangles)[t * 3 + c] : ((const uint32*)triangles)[t * 3 + c];
+
+					if (header.hasQuantisedVertices()) {
+						uint16* q = (uint16*)(data + header.verticesOffset) + (leafVertices[n] + index) * 3;
+						for (byte y = 0; y < 3; ++y) {
+							q[y] = (uint16)(mathMIN(decimal(65535.0), mathMAX(decimal(0.0), (v[y] - leafMin[y]) * scale[y])) + decimal(0.5));
+						}
+					}
+					else {
+						std::memcpy((decimal*)(data + header.verticesOffset) + index * 3, v, sizeof(decimal) * 3);
+					}
 				}
 			}
 		}
+
+		for (byte x = 0; x < 3; ++x) {
+			header.boundMin[x] = boundMin[x];
+			header.boundMax[x] = boundMax[x];
+		}
+		this->bound = AABB(boundMin, boundMax);
+	}
+
+	void TriangleMesh::rebuild(const decimal* triangleData)
+	{
+		ASSERT(this->cookedStorage.size() > 0 && this->getHeader().isDeformable(), "only deformable meshes owning their data can be rebuilt");
+
+		const CookedTriangleMeshHeader& header = this->getHeader();
+
+		//flags go back to the order of the soup
+		DynamicArray<byte, uint32> flags;
+		flags.reserve(header.numOfTriangles);
+		for (uint32 x = 0; x < header.numOfTriangles; ++x) {
+			flags[this->getSourceTriangles()[x]] = this->getTriangleFlags()[x];
+		}
+
+		TriangleMeshCookingOptions options;
+		options.maxTrianglesPerLeaf = (byte)header.maxTrianglesPerLeaf;
+		options.quantiseVertices = header.hasQuantisedVertices();
+		options.deformable = true;
+
+		DynamicArray<byte, uint32> cookedData;
+		TriangleMesh::cook(cookedData, triangleData, header.numOfTriangles, flags.size() > 0 ? flags.data() : nullptr, options);
+		this->load(cookedData);
+	}
+
+	bool TriangleMesh::needsRebuild() const
+	{
+		//a refit keeps the topology, once the tree costs twice what it did when it was built it is worth rebuilding
+		return this->getNumOfTriangles() > 0 && this->getCost() > decimal(2.0) * this->getHeader().buildCost;
+	}
+
+	decimal TriangleMesh::getCost() const
+	{
+		return this->isEmpty() ? decimal(0.0) : treeCost(this->getNodes(), this->getHeader().numOfNodes);
 	}
-}
\ No newline at end of file
+}
@@ -30,45 +30,181 @@
 
 #include"aabb.h"
 #include"triangle.h"
+#include"rayPacket.h"
 #include"../containers/hybridArray.h"
 
 namespace mech {
 
+#define MAXIMUM_BVH_DEPTH 64
+
+#define COOKED_TRIANGLE_MESH_MAGIC 0x4853454D //"MESH"
+#define COOKED_TRIANGLE_MESH_VERSION 3
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	/*
+		a cooked triangle mesh is one block of memory that is used in place, so a mesh can point straight into a memory mapped file.
+		every section starts on a 16 byte boundary from the start of the header:
+		header | vertices | triangles (3 vertex indices each, in BVH leaf order) | BVH nodes | first vertex of each leaf | triangle flags (1 byte each) | source triangles
+
+		vertices are either shared by the whole mesh (3 decimals each) or quantised to 3 uint16 offsets inside the bound of the leaf that uses them,
+		in which case the indices of a triangle are local to its leaf.
+		deformable meshes also keep the index each triangle had in the triangle soup it was cooked from, so it can be refitted from new soup data.
+		--------------format flags----------------
+		vertices are quantised            - 0b00000001
+		indices are 16 bit                - 0b00000010
+		mesh is deformable                - 0b00000100
+	*/
+	struct CookedTriangleMeshHeader {
+		uint32 magic = COOKED_TRIANGLE_MESH_MAGIC;
+		uint32 version = COOKED_TRIANGLE_MESH_VERSION;
+		uint32 decimalSize = sizeof(decimal); //data cooked in double precision can not be used in single precision and vice versa
+		uint32 sizeInBytes = 0;
+		uint32 numOfVertices = 0;
+		uint32 numOfTriangles = 0;
+		uint32 numOfNodes = 0;
+		uint32 verticesOffset = 0;
+		uint32 trianglesOffset = 0;
+		uint32 nodesOffset = 0;
+		uint32 leafVerticesOffset = 0;
+		uint32 flagsOffset = 0;
+		uint32 sourceTrianglesOffset = 0;
+		uint32 formatFlags = 0;
+		uint32 maxTrianglesPerLeaf = 0;
+		decimal buildCost = decimal(0.0); //surface area heuristic cost of the tree when it was built
+		decimal boundMin[3] = {};
+		decimal boundMax[3] = {};
+
+		bool hasQuantisedVertices() const { return (this->formatFlags & 1) != 0; }
+		bool has16BitIndices() const { return (this->formatFlags & 2) != 0; }
+		bool isDeformable() const { return (this->formatFlags & 4) != 0; }
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	struct TriangleMeshCookingOptions {
+		byte maxTrianglesPerLeaf = 4;
+		bool quantiseVertices = false; //lossy, a vertex moves by at most 1/65535 of the extent of its leaf
+		bool deformable = false; //keeps what is needed to refit the mesh, vertices that coincide are welded so a deformation has to move them together
+
+		TriangleMeshCookingOptions() {}
+	};
+
 	struct TriangleMesh {
 
-		//bounding volume hierachy
+		//flat binary bounding volume hierachy built with the surface area heuristic, every triangle is referenced by exactly one leaf
 		struct BVH {
 
+			//32 bytes, bounds are rounded outwards to single precision
 			struct Node {
 
-				AABB bound;
-				uint16 parent = -1;
-				StackArray<uint16, 8> children; //StackArray<child index, ...
-				DynamicArray<uint32, uint32> indicies; //DynamicArray<triangle index, ...
+				Vec3f min;
+				Vec3f max;
+				uint32 index = 0; //first child of an inner node (the second follows it), first triangle of a leaf
+				uint32 count = 0; //triangles held by a leaf, 0 for inner nodes
 
 				Node() {}
-				Node(const AABB& aabb) : bound(aabb) {}
+
+				void setBound(const AABB& aabb);
+				AABB getBound() const { return AABB(Vec3(this->min.x, this->min.y, this->min.z), Vec3(this->max.x, this->max.y, this->max.z)); }
+				bool isLeaf() const { return this->count > 0; }
+
+				bool intersects(const AABB& aabb) const
+				{
+					return this->min.x <= aabb.max.x && this->max.x >= aabb.min.x &&
+						this->min.y <= aabb.max.y && this->max.y >= aabb.min.y &&
+						this->min.z <= aabb.max.z && this->max.z >= aabb.min.z;
+				}
 			};
 
-			DynamicArray<Node, uint16> nodes;
-			uint16 parentNode = -1;
+			DynamicArray<Node, uint32> nodes; //nodes[0] is the root
+			DynamicArray<uint32, uint32> triangleIndices; //leaves index into this, cooking stores the triangles in this order
 
 			BVH() {}
 
-			void create(decimal* triangles, const uint32& numOfTriangles, const Vec3& limit);
+			void create(const decimal* triangles, const uint32& numOfTriangles, const byte& maxTrianglesPerLeaf);
 		};
-		
-		BVH bvh;
-		decimal* triangles = nullptr;
-		uint32 numOfTriangles = 0;
+
+		DynamicArray<byte, uint32> cookedStorage; //empty when the mesh points into memory it does not own
+		const byte* externalData = nullptr;
+		AABB bound = AABB(nanVEC3, nanVEC3);
 
 		TriangleMesh() {}
-		TriangleMesh(decimal* triangleData, const uint32& numberOfTriangles, const Vec3& minimumSizeOfBVHNode = Vec3(decimal(5.0)));
+		TriangleMesh(const decimal* triangleData, const uint32& numberOfTriangles, const TriangleMeshCookingOptions& options = TriangleMeshCookingOptions()); //cooks into memory owned by the mesh
+
+		//writes the cooked form of a triangle soup (9 decimals per triangle), triangleFlags is optional and holds one byte per triangle
+		static void cook(DynamicArray<byte, uint32>& cookedData, const decimal* triangleData, const uint32& numberOfTriangles, const byte* triangleFlags = nullptr, const TriangleMeshCookingOptions& options = TriangleMeshCookingOptions());
+		static bool isValidCookedData(const void* data, const uint64& sizeInBytes); //checks every section, node and index, linear in the size of the mesh
+
+		bool load(const DynamicArray<byte, uint32>& cookedData); //copies the data
+		bool loadInPlace(const void* data, const uint64& sizeInBytes); //no copy, data has to outlive the mesh and stay 16 byte aligned
+
+		const CookedTriangleMeshHeader& getHeader() const { return *(const CookedTriangleMeshHeader*)this->getCookedData(); }
+		const byte* getVertices() const { return this->getCookedData() + this->getHeader().verticesOffset; }
+		const byte* getTriangles() const { return this->getCookedData() + this->getHeader().trianglesOffset; }
+		const BVH::Node* getNodes() const { return (const BVH::Node*)(this->getCookedData() + this->getHeader().nodesOffset); }
+		const uint32* getLeafVertices() const { return (const uint32*)(this->getCookedData() + this->getHeader().leafVerticesOffset); }
+		const byte* getTriangleFlags() const { return this->getCookedData() + this->getHeader().flagsOffset; }
+		const uint32* getSourceTriangles() const { return (const uint32*)(this->getCookedData() + this->getHeader().sourceTrianglesOffset); }
+		uint32 getNumOfTriangles() const { return this->isEmpty() ? 0 : this->getHeader().numOfTriangles; }
+		bool isEmpty() const { return this->getCookedData() == nullptr; }
 
 		ConvexHull toConvexHull();
 
-		bool intersects(const AABB& aabb);
-		void getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles);
+		Triangle getTriangle(const uint32& leafIndex, const uint32& triangleIndex) const; //vertices are decoded on the fly, leafIndex is the node holding the triangle
+
+		bool intersects(const AABB& aabb) const;
+		void getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles) const;
+
+		//nearest triangle the ray hits before maxT, leaves are visited front to back. returns -1 on a miss
+		decimal rayCastTime(const Ray& ray, const decimal& maxT, Triangle& triangleHit, const bool& anyHit = false) const;
+
+		/*
+			traces the active lanes of a packet together, maxT holds the furthest distance of each lane and is lowered to its hits.
+			returns the lanes that hit, trianglesHit[lane] is the triangle hit by a lane
+		*/
+		int32 rayCastPacket(const RayPacket& packet, float* maxT, Triangle* trianglesHit, const bool& anyHit = false) const;
+
+		//visitor.visit(triangle) is called for every triangle that overlaps the aabb and returns false to end the query
+		template<typename Visitor>
+		void forEachTriangleOverlapped(const AABB& aabb, Visitor& visitor) const
+		{
+			if (this->getNumOfTriangles() == 0) return;
+
+			const BVH::Node* nodes = this->getNodes();
+
+			//depth first, a binary tree never holds more than its depth plus one nodes on the stack
+			uint32 stack[MAXIMUM_BVH_DEPTH + 1];
+			byte size = 0;
+			stack[size++] = 0;
+
+			while (size > 0) {
+
+				uint32 nodeIndex = stack[--size];
+				const BVH::Node& node = nodes[nodeIndex];
+				if (node.intersects(aabb) == false) continue;
+
+				if (node.isLeaf()) {
+					for (uint32 x = node.index, end = node.index + node.count; x < end; ++x) {
+						Triangle t = this->getTriangle(nodeIndex, x);
+						if (aabb.intersects(t) && visitor.visit(t) == false) return;
+					}
+				}
+				else {
+					stack[size++] = node.index;
+					stack[size++] = node.index + 1;
+				}
+			}
+		}
+
+		/*
+			deformable meshes owning their data only, triangleData is the soup the mesh was cooked from with the vertices moved.
+			refit updates the bounds bottom up and keeps the tree, rebuild cooks the mesh again once refits made the tree too loose
+		*/
+		void refit(const decimal* triangleData);
+		void rebuild(const decimal* triangleData);
+		bool needsRebuild() const;
+		decimal getCost() const;
+
+		const byte* getCookedData() const { return this->cookedStorage.size() > 0 ? this->cookedStorage.data() : this->externalData; }
 	};
 }
 
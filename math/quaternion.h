@@ -253,6 +253,18 @@ namespace mech {
 		return IDENTITY_QUATERNION;
 	}
 
+	//inverse of rotationQuaternion, the rotation is taken the short way round
+	inline static Vec3 rotationVector(const Quaternion& q)
+	{
+		Quaternion r = q.s < decimal(0.0) ? Quaternion(-q.s, -q.vec) : q;
+		decimal sinHalfAngle = magnitude(r.vec);
+		if (sinHalfAngle > mathEPSILON) {
+			return r.vec * (decimal(2.0) * mathATAN2(sinHalfAngle, r.s) / sinHalfAngle);
+		}
+
+		return r.vec * decimal(2.0);
+	}
+
 	inline static Quaternion slerp(const Quaternion& q1, const Quaternion& q2, const decimal& factor)
 	{
 		char invert = 1;
@@ -0,0 +1,158 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include"../core/core.h"
+
+#include<cstring>
+
+#if defined(mechCPU_X86)
+#include<emmintrin.h>
+#define mechSIMD_SSE
+#endif
+
+namespace mech {
+
+	/*
+		four single precision lanes, SSE on x86 and plain arrays elsewhere.
+		comparisons return masks with every bit of a lane set where they hold, getMask packs them into the low four bits of an int
+	*/
+	struct Float4 {
+
+#if defined(mechSIMD_SSE)
+		__m128 v;
+
+		Float4() : v(_mm_setzero_ps()) {}
+		Float4(const __m128& value) : v(value) {}
+		explicit Float4(const float& f) : v(_mm_set1_ps(f)) {}
+		explicit Float4(const float& a, const float& b, const float& c, const float& d) : v(_mm_setr_ps(a, b, c, d)) {}
+
+		void store(float* f) const { _mm_storeu_ps(f, this->v); }
+		static Float4 load(const float* f) { return Float4(_mm_loadu_ps(f)); }
+#else
+		float v[4];
+
+		Float4() { this->v[0] = this->v[1] = this->v[2] = this->v[3] = float(0.0); }
+		explicit Float4(const float& f) { this->v[0] = this->v[1] = this->v[2] = this->v[3] = f; }
+		explicit Float4(const float& a, const float& b, const float& c, const float& d) { this->v[0] = a; this->v[1] = b; this->v[2] = c; this->v[3] = d; }
+
+		void store(float* f) const { std::memcpy(f, this->v, sizeof(this->v)); }
+		static Float4 load(const float* f) { Float4 r; std::memcpy(r.v, f, sizeof(r.v)); return r; }
+#endif
+
+		float getLane(const byte& lane) const
+		{
+			float f[4];
+			this->store(f);
+			return f[lane];
+		}
+	};
+
+#if defined(mechSIMD_SSE)
+
+	inline Float4 operator+(const Float4& a, const Float4& b) { return Float4(_mm_add_ps(a.v, b.v)); }
+	inline Float4 operator-(const Float4& a, const Float4& b) { return Float4(_mm_sub_ps(a.v, b.v)); }
+	inline Float4 operator*(const Float4& a, const Float4& b) { return Float4(_mm_mul_ps(a.v, b.v)); }
+	inline Float4 operator/(const Float4& a, const Float4& b) { return Float4(_mm_div_ps(a.v, b.v)); }
+	inline Float4 minLanes(const Float4& a, const Float4& b) { return Float4(_mm_min_ps(a.v, b.v)); }
+	inline Float4 maxLanes(const Float4& a, const Float4& b) { return Float4(_mm_max_ps(a.v, b.v)); }
+
+	inline Float4 lessThan(const Float4& a, const Float4& b) { return Float4(_mm_cmplt_ps(a.v, b.v)); }
+	inline Float4 lessEqual(const Float4& a, const Float4& b) { return Float4(_mm_cmple_ps(a.v, b.v)); }
+	inline Float4 greaterEqual(const Float4& a, const Float4& b) { return Float4(_mm_cmpge_ps(a.v, b.v)); }
+	inline Float4 andLanes(const Float4& a, const Float4& b) { return Float4(_mm_and_ps(a.v, b.v)); }
+	inline Float4 orLanes(const Float4& a, const Float4& b) { return Float4(_mm_or_ps(a.v, b.v)); }
+	inline int32 getMask(const Float4& mask) { return _mm_movemask_ps(mask.v); }
+
+#else
+
+	inline Float4 operator+(const Float4& a, const Float4& b) { return Float4(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+	inline Float4 operator-(const Float4& a, const Float4& b) { return Float4(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+	inline Float4 operator*(const Float4& a, const Float4& b) { return Float4(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+	inline Float4 operator/(const Float4& a, const Float4& b) { return Float4(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]); }
+
+	//like SSE the second operand is returned when either is NaN
+	inline Float4 minLanes(const Float4& a, const Float4& b)
+	{
+		Float4 r;
+		for (byte x = 0; x < 4; ++x) r.v[x] = a.v[x] < b.v[x] ? a.v[x] : b.v[x];
+		return r;
+	}
+
+	inline Float4 maxLanes(const Float4& a, const Float4& b)
+	{
+		Float4 r;
+		for (byte x = 0; x < 4; ++x) r.v[x] = a.v[x] > b.v[x] ? a.v[x] : b.v[x];
+		return r;
+	}
+
+	inline float maskLane(const bool& condition)
+	{
+		uint32 bits = condition ? 0xFFFFFFFF : 0;
+		float f;
+		std::memcpy(&f, &bits, sizeof(float));
+		return f;
+	}
+
+	inline uint32 laneBits(const float& f)
+	{
+		uint32 bits;
+		std::memcpy(&bits, &f, sizeof(float));
+		return bits;
+	}
+
+	inline Float4 lessThan(const Float4& a, const Float4& b) { return Float4(maskLane(a.v[0] < b.v[0]), maskLane(a.v[1] < b.v[1]), maskLane(a.v[2] < b.v[2]), maskLane(a.v[3] < b.v[3])); }
+	inline Float4 lessEqual(const Float4& a, const Float4& b) { return Float4(maskLane(a.v[0] <= b.v[0]), maskLane(a.v[1] <= b.v[1]), maskLane(a.v[2] <= b.v[2]), maskLane(a.v[3] <= b.v[3])); }
+	inline Float4 greaterEqual(const Float4& a, const Float4& b) { return Float4(maskLane(a.v[0] >= b.v[0]), maskLane(a.v[1] >= b.v[1]), maskLane(a.v[2] >= b.v[2]), maskLane(a.v[3] >= b.v[3])); }
+
+	inline Float4 andLanes(const Float4& a, const Float4& b)
+	{
+		Float4 r;
+		for (byte x = 0; x < 4; ++x) r.v[x] = maskLane((laneBits(a.v[x]) & laneBits(b.v[x])) != 0);
+		return r;
+	}
+
+	inline Float4 orLanes(const Float4& a, const Float4& b)
+	{
+		Float4 r;
+		for (byte x = 0; x < 4; ++x) r.v[x] = maskLane((laneBits(a.v[x]) | laneBits(b.v[x])) != 0);
+		return r;
+	}
+
+	inline int32 getMask(const Float4& mask)
+	{
+		int32 bits = 0;
+		for (byte x = 0; x < 4; ++x) bits |= (laneBits(mask.v[x]) >> 31) << x;
+		return bits;
+	}
+
+#endif
+}
+
+#endif
@@ -30,10 +30,13 @@
 
 #include"narrowPhase.h"
 #include"timeOfImpact.h"
+#include"colliderDispatch.h"
+#include"../containers/priorityQueue.h"
 
 namespace mech {
 
 #define CONTINOUS_COLLISION_THRESHOLD decimal(1.35)
+#define MAXIMUM_TOI_EVENTS_PER_BODY 4
 
 	struct BroadPhase {
 
@@ -42,77 +45,24 @@ namespace mech {
 		TimeOfImpact* timeOfImpact = nullptr;
 		ConstraintSolver* constraintSolver = nullptr;
 
-		void (BroadPhase::* manifoldPtrs[30]) (ContactManifold&, const ColliderIdentifier&, const ColliderIdentifier&) = {};
-		TOIResult(BroadPhase::* toiPtrs[30]) (const AABB&, const ColliderIdentifier&, const ColliderIdentifier&, const Transform3DRange&, const Transform3DRange&) = {};
-		const decimal& (BroadPhase::* radiusPtrs[4]) (const ColliderIdentifier&) = {};
-
 		BroadPhase(const BroadPhase&) = delete;
 		BroadPhase& operator=(const BroadPhase&) = delete;
 
-		BroadPhase()
-		{
-			this->manifoldPtrs[0]  = &BroadPhase::convexHullVsConvexHullManifold;
-			this->manifoldPtrs[5]  = &BroadPhase::convexHullVsSphereManifold;
-			this->manifoldPtrs[10] = &BroadPhase::convexHullVsCapsuleManifold;
-			this->manifoldPtrs[15] = &BroadPhase::otherVsCompoundManifold;
-			this->manifoldPtrs[20] = &BroadPhase::convexHullVsTriangleMeshManifold;
-			this->manifoldPtrs[25] = &BroadPhase::convexHullVsHeightFieldManifold;
-			this->manifoldPtrs[1]  = &BroadPhase::sphereVsConvexHullManifold;
-			this->manifoldPtrs[6]  = &BroadPhase::sphereVsSphereManifold;
-			this->manifoldPtrs[11] = &BroadPhase::sphereVsCapsuleManifold;
-			this->manifoldPtrs[16] = &BroadPhase::otherVsCompoundManifold;
-			this->manifoldPtrs[21] = &BroadPhase::sphereVsTriangleMeshManifold;
-			this->manifoldPtrs[26] = &BroadPhase::sphereVsHeightFieldManifold;
-			this->manifoldPtrs[2]  = &BroadPhase::capsuleVsConvexHullManifold;
-			this->manifoldPtrs[7]  = &BroadPhase::capsuleVsSphereManifold;
-			this->manifoldPtrs[12] = &BroadPhase::capsuleVsCapsuleManifold;
-			this->manifoldPtrs[17] = &BroadPhase::otherVsCompoundManifold;
-			this->manifoldPtrs[22] = &BroadPhase::capsuleVsTriangleMeshManifold;
-			this->manifoldPtrs[27] = &BroadPhase::capsuleVsHeightFieldManifold;
-			this->manifoldPtrs[3]  = &BroadPhase::compoundVsOtherManifold;
-			this->manifoldPtrs[8]  = &BroadPhase::compoundVsOtherManifold;
-			this->manifoldPtrs[13] = &BroadPhase::compoundVsOtherManifold;
-			this->manifoldPtrs[18] = &BroadPhase::compoundVsOtherManifold;
-			this->manifoldPtrs[23] = &BroadPhase::compoundVsOtherManifold;
-			this->manifoldPtrs[28] = &BroadPhase::compoundVsOtherManifold;
-
-			this->toiPtrs[0] = &BroadPhase::commonTOI;
-			this->toiPtrs[5] = &BroadPhase::commonTOI;
-			this->toiPtrs[10] = &BroadPhase::commonTOI;
-			this->toiPtrs[15] = &BroadPhase::otherVsCompoundTOI;
-			this->toiPtrs[20] = &BroadPhase::otherVsTriangleMeshTOI;
-			this->toiPtrs[25] = &BroadPhase::otherVsHeightFieldTOI;
-			this->toiPtrs[1] = &BroadPhase::commonTOI;
-			this->toiPtrs[6] = &BroadPhase::commonTOI;
-			this->toiPtrs[11] = &BroadPhase::commonTOI;
-			this->toiPtrs[16] = &BroadPhase::otherVsCompoundTOI;
-			this->toiPtrs[21] = &BroadPhase::otherVsTriangleMeshTOI;
-			this->toiPtrs[26] = &BroadPhase::otherVsHeightFieldTOI;
-			this->toiPtrs[2] = &BroadPhase::commonTOI;
-			this->toiPtrs[7] = &BroadPhase::commonTOI;
-			this->toiPtrs[12] = &BroadPhase::commonTOI;
-			this->toiPtrs[17] = &BroadPhase::otherVsCompoundTOI;
-			this->toiPtrs[22] = &BroadPhase::otherVsTriangleMeshTOI;
-			this->toiPtrs[27] = &BroadPhase::otherVsHeightFieldTOI;
-			this->toiPtrs[3]  = &BroadPhase::compoundVsOtherTOI;
-			this->toiPtrs[8]  = &BroadPhase::compoundVsOtherTOI;
-			this->toiPtrs[13] = &BroadPhase::compoundVsOtherTOI;
-			this->toiPtrs[18] = &BroadPhase::compoundVsOtherTOI;
-			this->toiPtrs[23] = &BroadPhase::compoundVsOtherTOI;
-			this->toiPtrs[28] = &BroadPhase::compoundVsOtherTOI;
-
-			this->radiusPtrs[0] = &BroadPhase::getRadiusConvexHull;
-			this->radiusPtrs[1] = &BroadPhase::getRadiusSphere;
-			this->radiusPtrs[2] = &BroadPhase::getRadiusCapsule;
-			this->radiusPtrs[3] = &BroadPhase::getRadiusCompound;
-		}
+		BroadPhase() {}
 
 		void handle(PhysicsObject& phyObject, const decimal& deltaTime)
 		{
 			const ColliderIdentifier& identifier1 = this->physicsData->colliderIdentifiers[phyObject.rigidBody.colliderID];
 
-			if ((magnitudeSq(phyObject.rigidBody.getDisplacement()) / (this->*radiusPtrs[(uint32)(identifier1.type)])(identifier1)) >= CONTINOUS_COLLISION_THRESHOLD) {
-				this->continousCollisionDetection(phyObject, identifier1, deltaTime);
+			//kinematic bodies follow their path whatever they hit, so they are never swept
+			bool isKinematic = identifier1.state == ColliderMotionState::kinematic;
+
+			if (isKinematic == false && (this->physicsData->settings.speculativeContacts || phyObject.rigidBody.usesSpeculativeContacts())) {
+				this->speculativeCollisionDetection(phyObject, identifier1, deltaTime);
+			}
+			else if (isKinematic == false && (magnitudeSq(phyObject.rigidBody.getDisplacement()) / this->getRadius(identifier1)) >= CONTINOUS_COLLISION_THRESHOLD) {
+				//handled once every body has moved, see resolveTimeOfImpactEvents
+				this->physicsData->continousBodies.pushBack(identifier1.objectIndex);
 			}
 			else {
 
@@ -133,17 +83,16 @@ namespace mech {
 				Octree::Node& node = this->physicsData->octree.nodes[phyObject.nodesIntersected[x]];
 				for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
 
-					if (phyObject.disabledCollisions.find(it.data())) continue;
+					const ColliderIdentifier& id2 = this->physicsData->colliderIdentifiers[it.data()];
+					if (this->physicsData->collisionFilter.shouldCollide(identifier1, id2) == false) continue;
 
 					uint32 manifoldID = pairingFunction(identifier1.colliderID, it.data());
 					if (this->physicsData->finishedCollisions.find(manifoldID) == false) {
 
-						const ColliderIdentifier& id2 = this->physicsData->colliderIdentifiers[it.data()];
-
 						ContactManifold manifold = ContactManifold(manifoldID);
 						this->detectCollision(manifold, identifier1, id2);
 
-						if (id2.state == ColliderMotionState::dynamic && manifold.flag != CollisionFlag::NOTCOLLIDING) {
+						if (identifier1.state == ColliderMotionState::dynamic && id2.state == ColliderMotionState::dynamic && manifold.flag != CollisionFlag::NOTCOLLIDING) {
 							phyObject.addToIsland(physicsData, id2.colliderID);
 						}
 					}
@@ -162,37 +111,146 @@ namespace mech {
 			END_PROFILE;
 		}
 
-		void continousCollisionDetection(PhysicsObject& phyObject, const ColliderIdentifier& identifier1, const decimal& deltaTime)
+		void registerIntersectingNodes(const uint32& nodeIndex, const AABB& aabbCast, HybridArray<uint16, 8, uint16>& nodes)
 		{
-			struct CCD {
+			for (byte x = 0; x < 8; ++x) {
 
-				void registerIntersectingNodes(const uint32& nodeIndex, PhysicsData* physicsData, const AABB& aabbCast, HybridArray<uint16, 8, uint16>& nodes)
-				{
-					for (byte x = 0; x < 8; ++x) {
-
-						if (isAValidIndex(physicsData->octree.nodes[nodeIndex].children[x].first)) {
+				if (isAValidIndex(this->physicsData->octree.nodes[nodeIndex].children[x].first)) {
 
-							uint32 childIndex = physicsData->octree.nodes[nodeIndex].children[x].second;
+					uint32 childIndex = this->physicsData->octree.nodes[nodeIndex].children[x].second;
 
-							if (physicsData->octree.nodes[childIndex].bound.intersects(aabbCast)) {
+					if (this->physicsData->octree.nodes[childIndex].bound.intersects(aabbCast)) {
 
-								if (physicsData->octree.nodes[childIndex].children.empty()) {
-									nodes.pushBack(childIndex);
-								}
-								else {
-									registerIntersectingNodes(childIndex, physicsData, aabbCast, nodes);
-								}
+						if (this->physicsData->octree.nodes[childIndex].children.empty()) {
+							nodes.pushBack(childIndex);
+						}
+						else {
+							this->registerIntersectingNodes(childIndex, aabbCast, nodes);
+						}
 
-								if (physicsData->octree.nodes[childIndex].bound.contains(aabbCast)) {
-									break;
-								}
-							}
+						if (this->physicsData->octree.nodes[childIndex].bound.contains(aabbCast)) {
+							break;
 						}
 					}
 				}
-			};
+			}
+		}
+
+		//fast bodies are swept and their impacts are handled in time order across all bodies, within the budgets of PhysicsSettings
+		void resolveTimeOfImpactEvents(const decimal& deltaTime)
+		{
+			BEGIN_PROFILE("BroadPhase::resolveTimeOfImpactEvents");
+
+			this->timeOfImpact->iterations = 0;
+
+			PriorityQueue<TOIEvent, uint32> events;
+			for (uint32 x = 0, len = this->physicsData->continousBodies.size(); x < len; ++x) {
+
+				PhysicsObject& phyObject = this->physicsData->physicsObjects[this->physicsData->continousBodies[x]];
+				const ColliderIdentifier& identifier1 = this->physicsData->colliderIdentifiers[phyObject.rigidBody.colliderID];
+
+				this->scheduleEvent(events, this->sweep(phyObject, identifier1, decimal(0.0), false), phyObject, identifier1, deltaTime);
+			}
+
+			uint32 handled = 0;
+			while (events.empty() == false) {
+
+				TOIEvent event = events.top();
+				events.pop();
+
+				PhysicsObject& phyObject = this->physicsData->physicsObjects[event.objectIndex];
+				const ColliderIdentifier& identifier1 = this->physicsData->colliderIdentifiers[phyObject.rigidBody.colliderID];
+
+				//an earlier event moved one of the bodies off the path this one was found on
+				if (this->isStale(event)) {
+					TOIEvent next = this->sweep(phyObject, identifier1, event.start, event.count > 0);
+					next.count = event.count;
+					this->scheduleEvent(events, next, phyObject, identifier1, deltaTime);
+					continue;
+				}
+
+				//stop at the impact
+				phyObject.rigidBody.subStep(this->physicsData, event.fraction);
+
+				if (handled >= this->physicsData->settings.maxTOIEvents || event.count >= MAXIMUM_TOI_EVENTS_PER_BODY) {
+					this->fallBackToSpeculative(phyObject, identifier1, deltaTime);
+					continue;
+				}
+
+				++handled;
+				++this->physicsData->statistics.toiEvents;
+
+				this->physicsData->octree.updateEntityContinous(identifier1.colliderID, this->physicsData->getColliderAABB(identifier1.colliderID), phyObject.nodesIntersected);
+
+				bool outOfBounds = phyObject.nodesIntersected.empty();
+
+				uint32 first = this->physicsData->contactConstraints.size();
+				this->discreteCollisionDetection(phyObject, identifier1);
+
+				if (outOfBounds) continue;
+
+				this->generateSpeculativeContacts(phyObject, identifier1, deltaTime);
+
+				//respond to the impact now so that the rest of the step is swept with the new velocities
+				this->constraintSolver->solveContacts(first);
 
-			BEGIN_PROFILE("BroadPhase::continousCollisionDetection");
+				phyObject.rigidBody.advance(this->physicsData, (decimal(1.0) - event.t) * deltaTime);
+				phyObject.rigidBody.prevTime = event.t;
+
+				TOIEvent next = this->sweep(phyObject, identifier1, event.t, true);
+				next.count = event.count + 1;
+				this->scheduleEvent(events, next, phyObject, identifier1, deltaTime);
+			}
+
+			this->physicsData->statistics.toiIterations = this->timeOfImpact->iterations;
+			this->physicsData->continousBodies.shallowClear(false);
+
+			END_PROFILE;
+		}
+
+		bool isStale(const TOIEvent& event)
+		{
+			if (this->physicsData->physicsObjects[event.objectIndex].rigidBody.motionVersion != event.version1) return true;
+
+			const ColliderIdentifier& id2 = this->physicsData->colliderIdentifiers[event.colliderID];
+			return id2.state != ColliderMotionState::motionless && this->physicsData->physicsObjects[id2.objectIndex].rigidBody.motionVersion != event.version2;
+		}
+
+		void scheduleEvent(PriorityQueue<TOIEvent, uint32>& events, const TOIEvent& event, PhysicsObject& phyObject, const ColliderIdentifier& identifier1, const decimal& deltaTime)
+		{
+			if (event.state == TOIState::overlaping) {
+				events.push(event);
+			}
+			else if (event.state == TOIState::unresolved) {
+				//the sweep could not be finished, keep the body where the sweep began
+				phyObject.rigidBody.subStep(this->physicsData, decimal(0.0));
+				this->fallBackToSpeculative(phyObject, identifier1, deltaTime);
+			}
+			else {
+				this->physicsData->octree.updateEntityContinous(identifier1.colliderID, this->physicsData->getColliderAABB(identifier1.colliderID), phyObject.nodesIntersected);
+				this->discreteCollisionDetection(phyObject, identifier1);
+			}
+		}
+
+		void fallBackToSpeculative(PhysicsObject& phyObject, const ColliderIdentifier& identifier1, const decimal& deltaTime)
+		{
+			++this->physicsData->statistics.toiFallbacks;
+
+			this->physicsData->octree.updateEntityContinous(identifier1.colliderID, this->physicsData->getColliderAABB(identifier1.colliderID), phyObject.nodesIntersected);
+
+			bool outOfBounds = phyObject.nodesIntersected.empty();
+
+			this->discreteCollisionDetection(phyObject, identifier1);
+
+			if (outOfBounds) return;
+
+			this->generateSpeculativeContacts(phyObject, identifier1, deltaTime);
+		}
+
+		//earliest impact while the body moves from its previous transform to its current one, start is the fraction of the step the sweep begins at
+		TOIEvent sweep(PhysicsObject& phyObject, const ColliderIdentifier& identifier1, const decimal& start, const bool& skipTouching)
+		{
+			BEGIN_PROFILE("BroadPhase::sweep");
 
 			const AABB& currentAABB = this->physicsData->getColliderAABB(identifier1.colliderID);
 			AABB prevAABB = currentAABB.transformed(getInverse(phyObject.rigidBody.transform) * phyObject.rigidBody.prevTransform);
@@ -200,59 +258,314 @@ namespace mech {
 
 			HybridArray<uint16, 8, uint16> intersectingNodes;
 
-			CCD ccd;
-			ccd.registerIntersectingNodes(0, physicsData, aabbCast, intersectingNodes);
+			this->registerIntersectingNodes(0, aabbCast, intersectingNodes);
 
 			Transform3DRange tA = Transform3DRange(phyObject.rigidBody.prevTransform, phyObject.rigidBody.transform);
 
-			TOIResult hit;
+			TOIEvent event;
+			event.objectIndex = identifier1.objectIndex;
+			event.start = start;
+			event.version1 = phyObject.rigidBody.motionVersion;
+
 			HashTable<uint32, uint32> finished;
 			for (auto it1 = intersectingNodes.begin(), end1 = intersectingNodes.end(); it1 != end1; ++it1) {
 
 				for (auto it2 = physicsData->octree.nodes[it1.data()].entities.begin(), end2 = physicsData->octree.nodes[it1.data()].entities.end(); it2 != end2; ++it2) {
 
-					if (finished.find(it2.data()) || phyObject.disabledCollisions.find(it2.data())) continue;
+					if (finished.find(it2.data())) continue;
+
+					finished.insert(it2.data());
 
 					const ColliderIdentifier& id2 = this->physicsData->colliderIdentifiers[it2.data()];
+					if (this->physicsData->collisionFilter.shouldCollide(identifier1, id2) == false) continue;
+
+					//pairs that already have contacts are held apart by the solver
+					if (skipTouching) {
+						Pair<uint32, CollisionFlag>* ptr = this->physicsData->finishedCollisions.find(pairingFunction(identifier1.colliderID, it2.data()));
+						if (ptr && (ptr->second == CollisionFlag::PENETRATING || ptr->second == CollisionFlag::SPECULATIVE)) continue;
+					}
 
 					Transform3DRange tB;
-					if (id2.state == ColliderMotionState::dynamic) {
-						tB = Transform3DRange(physicsData->physicsObjects[id2.objectIndex].rigidBody.prevTransform, physicsData->physicsObjects[id2.objectIndex].rigidBody.transform);
+					if (id2.state != ColliderMotionState::motionless) {
+						tB = this->getPathFrom(physicsData->physicsObjects[id2.objectIndex].rigidBody, start);
 					}
 					
-					uint32 functionIndex = (uint32)(identifier1.type) + ((uint32)(id2.type) * 5);
-					TOIResult r = (this->*toiPtrs[functionIndex])(aabbCast, identifier1, id2, tA, tB);
-					if (r.state == TOIState::overlaping && r.t < hit.t) {
-						hit = r;
+					TOIResult r = this->toi(aabbCast, identifier1, id2, tA, tB);
+					if (r.state == TOIState::unresolved) {
+						event.state = TOIState::unresolved;
+						END_PROFILE;
+						return event;
 					}
 
-					finished.insert(it2.data());
+					if (r.state == TOIState::overlaping && r.t < event.fraction) {
+						event.fraction = r.t;
+						event.colliderID = it2.data();
+						event.state = TOIState::overlaping;
+						event.version2 = id2.state != ColliderMotionState::motionless ? physicsData->physicsObjects[id2.objectIndex].rigidBody.motionVersion : 0;
+					}
 				}
 			}
 
-			if (hit.state == TOIState::overlaping) {
-				phyObject.rigidBody.subStep(physicsData, mathMIN(hit.t + (decimal(5.0) / (magnitudeSq(phyObject.rigidBody.linearVelocity) * deltaTime)), decimal(1.0)));
+			if (event.state == TOIState::overlaping) {
+				event.t = start + event.fraction * (decimal(1.0) - start);
+			}
+
+			END_PROFILE;
+			return event;
+		}
+
+		//path of a body from the fraction start of the step to its end
+		static Transform3DRange getPathFrom(RigidBody& body, const decimal& start)
+		{
+			//sleeping bodies were not moved this step
+			if (body.isActive() == false) return Transform3DRange(body.transform, body.transform);
+
+			//prevTransform is the pose at prevTime, the start of the step or the last impact the body handled
+			if (start <= body.prevTime) {
+				//the body was still on its path towards that impact at start, which has been replaced, so it is taken to leave from the impact pose
+				return Transform3DRange(body.prevTransform, body.transform);
 			}
 
-			this->physicsData->octree.updateEntityContinous(identifier1.colliderID, currentAABB, this->physicsData->physicsObjects[identifier1.objectIndex].nodesIntersected);
+			decimal t = (start - body.prevTime) / (decimal(1.0) - body.prevTime);
+			Transform3D startTransform = Transform3D(lerp(body.prevTransform.position, body.transform.position, t), slerp(body.prevTransform.orientation, body.transform.orientation, t));
+			return Transform3DRange(startTransform, body.transform);
+		}
+
+		//contacts are generated within a margin grown by the velocity of the pair, the solver lets the bodies close the gap but not cross it
+		void speculativeCollisionDetection(PhysicsObject& phyObject, const ColliderIdentifier& identifier1, const decimal& deltaTime)
+		{
+			this->physicsData->octree.updateEntityDiscrete(identifier1.colliderID, this->physicsData->getColliderAABB(identifier1.colliderID), phyObject.nodesIntersected);
+
+			this->updateIsland(phyObject, identifier1);
+
+			bool outOfBounds = phyObject.nodesIntersected.empty();
 
 			this->discreteCollisionDetection(phyObject, identifier1);
 
+			if (outOfBounds) return;
+
+			this->generateSpeculativeContacts(phyObject, identifier1, deltaTime);
+		}
+
+		void generateSpeculativeContacts(PhysicsObject& phyObject, const ColliderIdentifier& identifier1, const decimal& deltaTime)
+		{
+			BEGIN_PROFILE("BroadPhase::generateSpeculativeContacts");
+
+			const RigidBody& body1 = phyObject.rigidBody;
+			decimal radius1 = this->getRadius(identifier1);
+			decimal angularReach1 = magnitude(body1.angularVelocity) * radius1 * deltaTime;
+
+			//bound of the motion expected during the next step
+			Vec3 motion = body1.linearVelocity * deltaTime;
+			const AABB& currentAABB = this->physicsData->getColliderAABB(identifier1.colliderID);
+			AABB aabbCast = AABB(currentAABB.min + minVec(motion, Vec3()) - Vec3(angularReach1, angularReach1, angularReach1), currentAABB.max + maxVec(motion, Vec3()) + Vec3(angularReach1, angularReach1, angularReach1));
+
+			HybridArray<uint16, 8, uint16> intersectingNodes;
+			this->registerIntersectingNodes(0, aabbCast, intersectingNodes);
+
+			for (auto it1 = intersectingNodes.begin(), end1 = intersectingNodes.end(); it1 != end1; ++it1) {
+
+				for (auto it2 = this->physicsData->octree.nodes[it1.data()].entities.begin(), end2 = this->physicsData->octree.nodes[it1.data()].entities.end(); it2 != end2; ++it2) {
+
+					const ColliderIdentifier& id2 = this->physicsData->colliderIdentifiers[it2.data()];
+					if (this->physicsData->collisionFilter.shouldCollide(identifier1, id2) == false) continue;
+
+					uint32 manifoldID = pairingFunction(identifier1.colliderID, it2.data());
+					Pair<uint32, CollisionFlag>* ptr = this->physicsData->finishedCollisions.find(manifoldID);
+					if (ptr && (ptr->second == CollisionFlag::PENETRATING || ptr->second == CollisionFlag::SPECULATIVE)) continue;
+
+					decimal margin = magnitude(body1.linearVelocity) * deltaTime + angularReach1 + this->physicsData->settings.linearSlop;
+					if (id2.state != ColliderMotionState::motionless) {
+						const RigidBody& body2 = this->physicsData->physicsObjects[id2.objectIndex].rigidBody;
+						margin = magnitude(body1.linearVelocity - body2.linearVelocity) * deltaTime + angularReach1 + magnitude(body2.angularVelocity) * this->getRadius(id2) * deltaTime + this->physicsData->settings.linearSlop;
+					}
+
+					ContactManifold manifold = ContactManifold(manifoldID);
+					manifold.material1 = identifier1.material;
+					manifold.material2 = id2.material;
+					this->speculativeContacts(manifold, identifier1, id2, aabbCast, margin);
+
+					if (manifold.flag == CollisionFlag::SPECULATIVE) {
+
+						this->physicsData->statistics.speculativeContacts += manifold.numPoints;
+						this->constraintSolver->add(manifold, identifier1, id2);
+
+						if (id2.state == ColliderMotionState::dynamic) {
+							phyObject.addToIsland(physicsData, id2.colliderID);
+						}
+					}
+
+					if (ptr) {
+						if (manifold.flag == CollisionFlag::SPECULATIVE) {
+							ptr->second = CollisionFlag::SPECULATIVE;
+						}
+					}
+					else {
+						this->physicsData->finishedCollisions.insert(Pair<uint32, CollisionFlag>(manifoldID, manifold.flag));
+					}
+				}
+			}
+
 			END_PROFILE;
 		}
 
+		void speculativeContacts(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const AABB& aabbCast, const decimal& margin)
+		{
+			SpeculativeVisitor visitor = { this, manifold, identifier1, identifier2, aabbCast, margin };
+			dispatchPair(identifier1.type, identifier2.type, visitor);
+		}
+
 		void detectCollision(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
 		{
-			uint32 functionIndex = (uint32)(identifier1.type) + ((uint32)(identifier2.type) * 5);
-			(this->*manifoldPtrs[functionIndex])(manifold, identifier1, identifier2);
+			this->generateManifold(manifold, identifier1, identifier2);
 
 			if (manifold.flag == CollisionFlag::PENETRATING) {
-				this->constraintSolver->add(manifold, identifier1.objectIndex, identifier2.objectIndex);
+				this->constraintSolver->add(manifold, identifier1, identifier2);
 			}
 
 			this->physicsData->finishedCollisions.insert(Pair<uint32, CollisionFlag>(manifold.ID, manifold.flag));
 		}
 
+		void generateManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		{
+			bool persistent = this->physicsData->settings.persistentManifolds && identifier1.type != ColliderType::compound && identifier2.type != ColliderType::compound;
+
+			if (persistent && this->refreshPersistentManifold(manifold, identifier1, identifier2)) {
+				++this->physicsData->statistics.persistentManifoldHits;
+				return;
+			}
+
+			ManifoldVisitor visitor = { this, manifold, identifier1, identifier2 };
+			dispatchPair(identifier1.type, identifier2.type, visitor);
+
+			if (persistent) {
+				++this->physicsData->statistics.persistentManifoldRebuilds;
+				this->updatePersistentManifold(manifold, identifier1, identifier2);
+			}
+		}
+
+		Transform3D getBodyTransform(const ColliderIdentifier& identifier)
+		{
+			if (isAValidIndex(identifier.objectIndex)) {
+				return this->physicsData->physicsObjects[identifier.objectIndex].rigidBody.transform;
+			}
+			return Transform3D();
+		}
+
+		//reprojects the stored points with the current body transforms, fails when the manifold has degraded
+		bool refreshPersistentManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		{
+			Pair<uint32, PersistentManifold>* ptr = this->physicsData->persistentManifolds.find(manifold.ID);
+			if (ptr == nullptr || ptr->second.numPoints == 0) return false;
+
+			PersistentManifold& persistentManifold = ptr->second;
+
+			Transform3D t1 = this->getBodyTransform(identifier1);
+			Transform3D t2 = this->getBodyTransform(identifier2);
+
+			Quaternion relativeOrientation = getInverse(t1.orientation) * t2.orientation;
+			if (mathABS(dotProduct(relativeOrientation, persistentManifold.relativeOrientation)) < this->physicsData->settings.contactRotationTolerance) return false;
+
+			decimal breakingDistance = this->physicsData->settings.contactBreakingDistance;
+
+			ContactManifold refreshed(manifold.ID);
+			bool penetrating = false;
+			for (byte x = 0; x < persistentManifold.numPoints; ++x) {
+
+				const PersistentManifold::Point& point = persistentManifold.points[x];
+
+				Vec3 p1 = t1 * point.localPosition[0];
+				Vec3 p2 = t2 * point.localPosition[1];
+				Vec3 n = t1.orientation * point.localNormal;
+
+				Vec3 d = p2 - p1;
+				decimal separation = dotProduct(n, d);
+				if (separation > breakingDistance || magnitudeSq(d - n * separation) > square(breakingDistance)) return false;
+
+				if (separation < decimal(0.0)) {
+					penetrating = true;
+				}
+
+				refreshed.addContact(n, p1, p2, point.ID);
+			}
+
+			//the pair is about to separate, let the narrowphase decide
+			if (penetrating == false) return false;
+
+			manifold.numPoints = refreshed.numPoints;
+			for (byte x = 0; x < refreshed.numPoints; ++x) {
+				manifold.contactPoints[x] = refreshed.contactPoints[x];
+			}
+			manifold.material1 = identifier1.material;
+			manifold.material2 = identifier2.material;
+			manifold.flag = CollisionFlag::PENETRATING;
+
+			persistentManifold.retention = this->physicsData->settings.framesToRetainCache;
+
+			return true;
+		}
+
+		//stores the narrowphase points, points close to a stored one inherit its ID so their impulses can be warm started
+		void updatePersistentManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		{
+			if (manifold.flag != CollisionFlag::PENETRATING || manifold.numPoints > MAXIMUM_PERSISTENT_CONTACT_POINTS) {
+
+				Pair<uint32, PersistentManifold>* ptr = this->physicsData->persistentManifolds.find(manifold.ID);
+				if (ptr) {
+					ptr->second.numPoints = 0;
+				}
+				return;
+			}
+
+			PersistentManifold& persistentManifold = this->physicsData->persistentManifolds[this->physicsData->persistentManifolds.insert(manifold.ID)].second;
+
+			Transform3D t1 = this->getBodyTransform(identifier1);
+			Transform3D t2 = this->getBodyTransform(identifier2);
+			Transform3D invT1 = getInverse(t1);
+			Transform3D invT2 = getInverse(t2);
+
+			decimal matchDistanceSq = square(this->physicsData->settings.contactBreakingDistance);
+
+			PersistentManifold::Point points[MAXIMUM_PERSISTENT_CONTACT_POINTS];
+			bool matched[MAXIMUM_PERSISTENT_CONTACT_POINTS] = {};
+			for (byte x = 0; x < manifold.numPoints; ++x) {
+
+				points[x].localPosition[0] = invT1 * manifold.contactPoints[x].position[0];
+				points[x].localPosition[1] = invT2 * manifold.contactPoints[x].position[1];
+				points[x].localNormal = invT1.orientation * manifold.contactPoints[x].normal;
+
+				byte closest = -1;
+				decimal smallest = matchDistanceSq;
+				for (byte y = 0; y < persistentManifold.numPoints; ++y) {
+
+					if (matched[y]) continue;
+
+					decimal d = mathMAX(magnitudeSq(points[x].localPosition[0] - persistentManifold.points[y].localPosition[0]), magnitudeSq(points[x].localPosition[1] - persistentManifold.points[y].localPosition[1]));
+					if (d < smallest) {
+						smallest = d;
+						closest = y;
+					}
+				}
+
+				if (isAValidIndex(closest)) {
+					matched[closest] = true;
+					points[x].ID = persistentManifold.points[closest].ID;
+				}
+				else {
+					points[x].ID = persistentManifold.nextID++;
+				}
+
+				manifold.contactPoints[x].ID = points[x].ID;
+			}
+
+			persistentManifold.numPoints = manifold.numPoints;
+			for (byte x = 0; x < manifold.numPoints; ++x) {
+				persistentManifold.points[x] = points[x];
+			}
+			persistentManifold.relativeOrientation = getInverse(t1.orientation) * t2.orientation;
+			persistentManifold.retention = this->physicsData->settings.framesToRetainCache;
+		}
+
 		void updateIsland(PhysicsObject& phyObject, const ColliderIdentifier& identifier1)
 		{
 			BEGIN_PROFILE("BroadPhase::updateIsland");
@@ -262,14 +575,15 @@ namespace mech {
 				bool removeFromIsland = true;
 				for (auto it = this->physicsData->islands[phyObject.islandIndex].begin(), end = this->physicsData->islands[phyObject.islandIndex].end(); it != end; ++it) {
 
-					if (phyObject.disabledCollisions.find(it.data())) continue;
+					const ColliderIdentifier& id2 = this->physicsData->colliderIdentifiers[it.data()];
+					if (this->physicsData->collisionFilter.shouldCollide(identifier1, id2) == false) continue;
 
 					uint32 manifoldID = pairingFunction(identifier1.colliderID, it.data());
 					Pair<uint32, CollisionFlag>* ptr = this->physicsData->finishedCollisions.find(manifoldID);
 					if (ptr == nullptr) {
 
 						ContactManifold manifold = ContactManifold(manifoldID);
-						this->detectCollision(manifold, identifier1, this->physicsData->colliderIdentifiers[it.data()]);
+						this->detectCollision(manifold, identifier1, id2);
 
 						if (manifold.flag != CollisionFlag::NOTCOLLIDING) {
 							removeFromIsland = false;
@@ -306,256 +620,295 @@ namespace mech {
 			END_PROFILE;
 		}
 
-		const decimal& getRadiusConvexHull(const ColliderIdentifier& identifier) { return this->physicsData->convexHullColliders[identifier.colliderIndex].convexRadius; }
-		const decimal& getRadiusSphere(const ColliderIdentifier& identifier) { return this->physicsData->sphereColliders[identifier.colliderIndex].collider.radius; }
-		const decimal& getRadiusCapsule(const ColliderIdentifier& identifier) { return this->physicsData->capsuleColliders[identifier.colliderIndex].convexRadius; }
-		const decimal& getRadiusCompound(const ColliderIdentifier& identifier) { return this->physicsData->compoundColliders[identifier.colliderIndex].convexRadius; }
+		//the visitors bind the runtime arguments to the compile time dispatch, see colliderDispatch.h
+		struct ManifoldVisitor {
+			BroadPhase* broadPhase;
+			ContactManifold& manifold;
+			const ColliderIdentifier& identifier1;
+			const ColliderIdentifier& identifier2;
 
-		void convexHullVsConvexHullManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
-		{
-			if (this->physicsData->convexHullColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->convexHullColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->convexHullColliders[identifier1.colliderIndex].collider, this->physicsData->convexHullColliders[identifier2.colliderIndex].collider, manifold, identifier1, identifier2);
+			template<ColliderType type1, ColliderType type2> void visit()
+			{
+				this->broadPhase->generateManifold<type1, type2>(this->manifold, this->identifier1, this->identifier2, typename PairTraits<type1, type2>::Tag());
 			}
-		}
-
-		void convexHullVsSphereManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
-		{
-			if (this->physicsData->convexHullColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->sphereColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->convexHullColliders[identifier1.colliderIndex].collider, this->physicsData->sphereColliders[identifier2.colliderIndex].collider, manifold);
+		};
+
+		struct SpeculativeVisitor {
+			BroadPhase* broadPhase;
+			ContactManifold& manifold;
+			const ColliderIdentifier& identifier1;
+			const ColliderIdentifier& identifier2;
+			const AABB& aabbCast;
+			const decimal& margin;
+
+			template<ColliderType type1, ColliderType type2> void visit()
+			{
+				this->broadPhase->speculativeContacts<type1, type2>(this->manifold, this->identifier1, this->identifier2, this->aabbCast, this->margin, typename PairTraits<type1, type2>::Tag());
 			}
-		}
+		};
+
+		struct TOIVisitor {
+			BroadPhase* broadPhase;
+			const AABB& aabbCast;
+			const ColliderIdentifier& identifier1;
+			const ColliderIdentifier& identifier2;
+			const Transform3DRange& t1;
+			const Transform3DRange& t2;
+			TOIResult result;
+
+			template<ColliderType type1, ColliderType type2> void visit()
+			{
+				this->result = this->broadPhase->toi<type1, type2>(this->aabbCast, this->identifier1, this->identifier2, this->t1, this->t2, typename PairTraits<type1, type2>::Tag());
+			}
+		};
 
-		void convexHullVsCapsuleManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
-		{
-			if (this->physicsData->convexHullColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->capsuleColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->convexHullColliders[identifier1.colliderIndex].collider, this->physicsData->capsuleColliders[identifier2.colliderIndex].collider, manifold);
+		struct RadiusVisitor {
+			PhysicsData* physicsData;
+			uint32 colliderIndex;
+			decimal radius;
+
+			template<ColliderType type> void visit()
+			{
+				this->radius = BroadPhase::getRadius(ColliderTraits<type>::get(this->physicsData, this->colliderIndex));
 			}
-		}
+		};
 
-		void convexHullVsTriangleMeshManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		decimal getRadius(const ColliderIdentifier& identifier)
 		{
-			if (this->physicsData->triangleMeshColliders[identifier2.colliderIndex].collider.intersects(this->physicsData->convexHullColliders[identifier1.colliderIndex].bound)) {
-			
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->triangleMeshColliders[identifier2.colliderIndex].collider.getTrianglesOverlapped(this->physicsData->convexHullColliders[identifier1.colliderIndex].bound, triangles);
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->convexHullColliders[identifier1.colliderIndex].collider, triangles, manifold, identifier1);
-			}
+			RadiusVisitor visitor = { this->physicsData, identifier.colliderIndex, decimal(0.0) };
+			dispatchMovable(identifier.type, visitor);
+			return visitor.radius;
 		}
 
-		void convexHullVsHeightFieldManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<typename Collider>
+		static const decimal& getRadius(const Collider& collider) { return collider.convexRadius; }
+		static const decimal& getRadius(const SphereCollider& collider) { return collider.collider.radius; }
+
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		template<ColliderType type1, ColliderType type2>
+		void generateManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, ConvexPair)
 		{
-			if (this->physicsData->heightFieldCollider.collider.intersects(this->physicsData->convexHullColliders[identifier1.colliderIndex].bound)) {
+			const typename ColliderTraits<type1>::Collider& collider1 = ColliderTraits<type1>::get(this->physicsData, identifier1.colliderIndex);
+			const typename ColliderTraits<type2>::Collider& collider2 = ColliderTraits<type2>::get(this->physicsData, identifier2.colliderIndex);
 
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->heightFieldCollider.collider.getTrianglesOverlapped(this->physicsData->convexHullColliders[identifier1.colliderIndex].bound, triangles);
+			if (collider1.bound.intersects(collider2.bound)) {
+				manifold.flag = CollisionFlag::PROXIMAL;
 				manifold.material1 = identifier1.material;
 				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->convexHullColliders[identifier1.colliderIndex].collider, triangles, manifold, identifier1);
+				this->generateContacts(collider1, collider2, manifold, identifier1, identifier2);
 			}
 		}
 
-		void sphereVsConvexHullManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<ColliderType type1, ColliderType type2>
+		void generateManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, ConvexVsTriangles)
 		{
-			if (this->physicsData->sphereColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->convexHullColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
+			const typename ColliderTraits<type1>::Collider& collider1 = ColliderTraits<type1>::get(this->physicsData, identifier1.colliderIndex);
+			const typename ColliderTraits<type2>::Collider& collider2 = ColliderTraits<type2>::get(this->physicsData, identifier2.colliderIndex);
+
+			if (collider2.intersects(collider1.bound)) {
 				manifold.material1 = identifier1.material;
 				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->sphereColliders[identifier1.colliderIndex].collider, this->physicsData->convexHullColliders[identifier2.colliderIndex].collider, manifold);
+				this->generateContacts(collider1, collider2, collider1.bound, manifold, identifier1);
 			}
 		}
 
-		void sphereVsSphereManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<ColliderType type1, ColliderType type2>
+		void generateManifold(ContactManifold& /*manifold*/, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, CompoundVsOther)
 		{
-			if (this->physicsData->sphereColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->sphereColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->sphereColliders[identifier1.colliderIndex].collider, this->physicsData->sphereColliders[identifier2.colliderIndex].collider, manifold);
+			HybridArray<uint32, 16, byte> componentIDs;
+			this->getComponentsNear<type2>(identifier1, identifier2, componentIDs);
+
+			for (auto it = componentIDs.begin(), end = componentIDs.end(); it != end; ++it) {
+
+				const ColliderIdentifier& component = this->physicsData->colliderIdentifiers[it.data()];
+
+				ContactManifold newManifold(pairingFunction(component.colliderID, identifier2.colliderID));
+				this->generateManifold(newManifold, component, identifier2);
+
+				if (newManifold.flag == CollisionFlag::PENETRATING) {
+					this->constraintSolver->add(newManifold, component, identifier2);
+				}
 			}
 		}
 
-		void sphereVsCapsuleManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<ColliderType type1, ColliderType type2>
+		void generateManifold(ContactManifold& /*manifold*/, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, ConvexVsCompound)
 		{
-			if (this->physicsData->sphereColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->capsuleColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->sphereColliders[identifier1.colliderIndex].collider, this->physicsData->capsuleColliders[identifier2.colliderIndex].collider, manifold);
+			HybridArray<uint32, 16, byte> componentIDs;
+			getComponentsOverlapped(this->physicsData, this->physicsData->compoundColliders[identifier2.colliderIndex], ColliderTraits<type1>::get(this->physicsData, identifier1.colliderIndex).bound, componentIDs);
+
+			for (auto it = componentIDs.begin(), end = componentIDs.end(); it != end; ++it) {
+
+				const ColliderIdentifier& component = this->physicsData->colliderIdentifiers[it.data()];
+
+				ContactManifold newManifold(pairingFunction(identifier1.colliderID, component.colliderID));
+				this->generateManifold(newManifold, identifier1, component);
+
+				if (newManifold.flag == CollisionFlag::PENETRATING) {
+					this->constraintSolver->add(newManifold, identifier1, component);
+				}
 			}
 		}
 
-		void sphereVsTriangleMeshManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		//components of the compound behind identifier1 that are near the other collider, height fields have no bound so every component is a candidate
+		template<ColliderType type2>
+		void getComponentsNear(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, HybridArray<uint32, 16, byte>& componentIDs, const decimal& margin = decimal(0.0))
 		{
-			if (this->physicsData->triangleMeshColliders[identifier2.colliderIndex].collider.intersects(this->physicsData->sphereColliders[identifier1.colliderIndex].bound)) {
-			
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->triangleMeshColliders[identifier2.colliderIndex].collider.getTrianglesOverlapped(this->physicsData->sphereColliders[identifier1.colliderIndex].bound, triangles);
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->sphereColliders[identifier1.colliderIndex].collider, triangles, manifold);
-			}
+			CompoundCollider& compoundCollider = this->physicsData->compoundColliders[identifier1.colliderIndex];
+
+			AABB aabb = (type2 == ColliderType::heightField) ? compoundCollider.bound : this->physicsData->getColliderAABB(identifier2.colliderID);
+			aabb.min -= Vec3(margin, margin, margin);
+			aabb.max += Vec3(margin, margin, margin);
+
+			getComponentsOverlapped(this->physicsData, compoundCollider, aabb, componentIDs);
 		}
 
-		void sphereVsHeightFieldManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<typename Collider1, typename Collider2>
+		void generateContacts(const Collider1& collider1, const Collider2& collider2, ContactManifold& manifold, const ColliderIdentifier& /*identifier1*/, const ColliderIdentifier& /*identifier2*/)
 		{
-			if (this->physicsData->heightFieldCollider.collider.intersects(this->physicsData->sphereColliders[identifier1.colliderIndex].bound)) {
-
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->heightFieldCollider.collider.getTrianglesOverlapped(this->physicsData->sphereColliders[identifier1.colliderIndex].bound, triangles);
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->sphereColliders[identifier1.colliderIndex].collider, triangles, manifold);
-			}
+			this->narrowPhase->generateContacts(collider1.collider, collider2.collider, manifold);
 		}
 
-		void capsuleVsConvexHullManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		void generateContacts(const ConvexHullCollider& collider1, const ConvexHullCollider& collider2, ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
 		{
-			if (this->physicsData->capsuleColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->convexHullColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->capsuleColliders[identifier1.colliderIndex].collider, this->physicsData->convexHullColliders[identifier2.colliderIndex].collider, manifold);
-			}
+			this->narrowPhase->generateContacts(collider1.collider, collider2.collider, manifold, identifier1, identifier2);
 		}
 
-		void capsuleVsSphereManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<typename Collider1, typename Triangles>
+		void generateContacts(const Collider1& collider1, const Triangles& triangles, const AABB& aabb, ContactManifold& manifold, const ColliderIdentifier& /*identifier1*/)
 		{
-			if (this->physicsData->capsuleColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->sphereColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->capsuleColliders[identifier1.colliderIndex].collider, this->physicsData->sphereColliders[identifier2.colliderIndex].collider, manifold);
-			}
+			this->narrowPhase->generateContacts(collider1.collider, triangles, aabb, manifold);
 		}
 
-		void capsuleVsCapsuleManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<typename Triangles>
+		void generateContacts(const ConvexHullCollider& collider1, const Triangles& triangles, const AABB& aabb, ContactManifold& manifold, const ColliderIdentifier& identifier1)
 		{
-			if (this->physicsData->capsuleColliders[identifier1.colliderIndex].bound.intersects(this->physicsData->capsuleColliders[identifier2.colliderIndex].bound)) {
-				manifold.flag = CollisionFlag::PROXIMAL;
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->capsuleColliders[identifier1.colliderIndex].collider, this->physicsData->capsuleColliders[identifier2.colliderIndex].collider, manifold);
-			}
+			this->narrowPhase->generateContacts(collider1.collider, triangles, aabb, manifold, identifier1);
 		}
 
-		void capsuleVsTriangleMeshManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		template<ColliderType type1, ColliderType type2>
+		void speculativeContacts(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const AABB& /*aabbCast*/, const decimal& margin, ConvexPair)
 		{
-			if (this->physicsData->triangleMeshColliders[identifier2.colliderIndex].collider.intersects(this->physicsData->capsuleColliders[identifier1.colliderIndex].bound)) {
-			
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->triangleMeshColliders[identifier2.colliderIndex].collider.getTrianglesOverlapped(this->physicsData->capsuleColliders[identifier1.colliderIndex].bound, triangles);
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->capsuleColliders[identifier1.colliderIndex].collider, triangles, manifold);
-			}
+			//components of a compound share the manifold, the pair of colliders keeps their points apart
+			this->narrowPhase->generateSpeculativeContact(ColliderTraits<type1>::get(this->physicsData, identifier1.colliderIndex).collider, ColliderTraits<type2>::get(this->physicsData, identifier2.colliderIndex).collider, manifold, margin, pairingFunction(identifier1.colliderID, identifier2.colliderID));
 		}
 
-		void capsuleVsHeightFieldManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<ColliderType type1, ColliderType type2>
+		void speculativeContacts(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const AABB& aabbCast, const decimal& margin, ConvexVsTriangles)
 		{
-			if (this->physicsData->heightFieldCollider.collider.intersects(this->physicsData->capsuleColliders[identifier1.colliderIndex].bound)) {
+			const typename ColliderTraits<type2>::Collider& collider2 = ColliderTraits<type2>::get(this->physicsData, identifier2.colliderIndex);
+
+			if (collider2.intersects(aabbCast)) {
+
+				//every triangle is visited, the closest points replace the farthest once the manifold is full
+				struct Kernel {
+					NarrowPhase* narrowPhase;
+					const typename ColliderTraits<type1>::Collider& collider1;
+					ContactManifold& manifold;
+					const decimal& margin;
+					uint32 colliderID;
+
+					bool visit(const Triangle& triangle)
+					{
+						//triangles are told apart by their centroid, which stays put while the mesh or height field does
+						Vec3 centroid = (triangle.a + triangle.b + triangle.c) * decimal(64.0 / 3.0);
+						uint32 triangleID = ((uint32)(int32)centroid.x * 73856093u) ^ ((uint32)(int32)centroid.y * 19349663u) ^ ((uint32)(int32)centroid.z * 83492791u);
+
+						this->narrowPhase->generateSpeculativeContact(this->collider1.collider, triangle, this->manifold, this->margin, this->colliderID ^ triangleID);
+						return true;
+					}
+				};
 
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->heightFieldCollider.collider.getTrianglesOverlapped(this->physicsData->capsuleColliders[identifier1.colliderIndex].bound, triangles);
-				manifold.material1 = identifier1.material;
-				manifold.material2 = identifier2.material;
-				this->narrowPhase->generateContacts(this->physicsData->capsuleColliders[identifier1.colliderIndex].collider, triangles, manifold);
+				Kernel kernel = { this->narrowPhase, ColliderTraits<type1>::get(this->physicsData, identifier1.colliderIndex), manifold, margin, identifier1.colliderID };
+				collider2.forEachTriangleOverlapped(aabbCast, kernel);
 			}
 		}
 
-		void compoundVsOtherManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<ColliderType type1, ColliderType type2>
+		void speculativeContacts(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const AABB& aabbCast, const decimal& margin, CompoundVsOther)
 		{
-			for (auto it = this->physicsData->compoundColliders[identifier1.colliderIndex].components.begin(), end = this->physicsData->compoundColliders[identifier1.colliderIndex].components.end(); it != end; ++it) {
-
-				uint32 functionIndex = (uint32)(this->physicsData->colliderIdentifiers[it.data()].type) + ((uint32)(identifier2.type) * 5);
+			HybridArray<uint32, 16, byte> componentIDs;
+			this->getComponentsNear<type2>(identifier1, identifier2, componentIDs, margin);
 
-				ContactManifold newManifold(pairingFunction(this->physicsData->colliderIdentifiers[it.data()].colliderID, identifier2.colliderID));
-				(this->*manifoldPtrs[functionIndex])(newManifold, this->physicsData->colliderIdentifiers[it.data()], identifier2);
-
-				if (newManifold.flag == CollisionFlag::PENETRATING) {
-					this->constraintSolver->add(newManifold, this->physicsData->colliderIdentifiers[it.data()].objectIndex, identifier2.objectIndex);
-				}
+			for (auto it = componentIDs.begin(), end = componentIDs.end(); it != end; ++it) {
+				this->speculativeContacts(manifold, this->physicsData->colliderIdentifiers[it.data()], identifier2, aabbCast, margin);
 			}
 		}
 
-		void otherVsCompoundManifold(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		template<ColliderType type1, ColliderType type2>
+		void speculativeContacts(ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const AABB& aabbCast, const decimal& margin, ConvexVsCompound)
 		{
-			for (auto it = this->physicsData->compoundColliders[identifier2.colliderIndex].components.begin(), end = this->physicsData->compoundColliders[identifier2.colliderIndex].components.end(); it != end; ++it) {
-
-				uint32 functionIndex = (uint32)(identifier1.type) + ((uint32)(this->physicsData->colliderIdentifiers[it.data()].type) * 5);
+			HybridArray<uint32, 16, byte> componentIDs;
+			getComponentsOverlapped(this->physicsData, this->physicsData->compoundColliders[identifier2.colliderIndex], aabbCast, componentIDs);
 
-				ContactManifold newManifold(pairingFunction(identifier1.colliderID, this->physicsData->colliderIdentifiers[it.data()].colliderID));
-				(this->*manifoldPtrs[functionIndex])(newManifold, identifier1, this->physicsData->colliderIdentifiers[it.data()]);
-
-				if (newManifold.flag == CollisionFlag::PENETRATING) {
-					this->constraintSolver->add(newManifold, identifier1.objectIndex, this->physicsData->colliderIdentifiers[it.data()].objectIndex);
-				}
+			for (auto it = componentIDs.begin(), end = componentIDs.end(); it != end; ++it) {
+				this->speculativeContacts(manifold, identifier1, this->physicsData->colliderIdentifiers[it.data()], aabbCast, margin);
 			}
 		}
 
-		TOIResult commonTOI(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2)
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		TOIResult toi(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2)
 		{
-			return this->timeOfImpact->toi(aabbCast, id1, id2, t1, t2);
+			TOIVisitor visitor = { this, aabbCast, id1, id2, t1, t2, TOIResult() };
+			dispatchPair(id1.type, id2.type, visitor);
+			return visitor.result;
 		}
 
-		TOIResult otherVsTriangleMeshTOI(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2)
+		template<ColliderType type1, ColliderType type2>
+		TOIResult toi(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2, ConvexPair)
 		{
-			TOIResult toiResult;
-			if (this->physicsData->triangleMeshColliders[id2.colliderIndex].collider.intersects(aabbCast)) {
-
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->triangleMeshColliders[id2.colliderIndex].collider.getTrianglesOverlapped(aabbCast, triangles);
-				
-				for (uint16 x = 0, len = triangles.size(); x < len; ++x) {
-
-					TOIResult r = this->timeOfImpact->toi(id1, triangles[x], t1);
-					if (r.state == TOIState::overlaping && r.t < toiResult.t) {
-						toiResult = r;
-					}
-				}
-			}
-
-			return toiResult;
+			return this->timeOfImpact->toi<type1, type2>(aabbCast, id1, id2, t1, t2);
 		}
 
-		TOIResult otherVsHeightFieldTOI(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2)
+		template<ColliderType type1, ColliderType type2>
+		TOIResult toi(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& /*t2*/, ConvexVsTriangles)
 		{
-			TOIResult toiResult;
-			if (this->physicsData->heightFieldCollider.collider.intersects(aabbCast)) {
+			const typename ColliderTraits<type2>::Collider& collider2 = ColliderTraits<type2>::get(this->physicsData, id2.colliderIndex);
 
-				HybridArray<Triangle, 24, uint16> triangles;
-				this->physicsData->heightFieldCollider.collider.getTrianglesOverlapped(aabbCast, triangles);
+			//keeps the earliest impact, an unresolved one ends the query
+			struct Kernel {
+				TimeOfImpact* timeOfImpact;
+				const ColliderIdentifier& id1;
+				const Transform3DRange& t1;
+				TOIResult result;
 
-				for (uint16 x = 0, len = triangles.size(); x < len; ++x) {
-
-					TOIResult r = this->timeOfImpact->toi(id1, triangles[x], t1);
-					if (r.state == TOIState::overlaping && r.t < toiResult.t) {
-						r.t += 0.001;
-						toiResult = r;
+				bool visit(const Triangle& triangle)
+				{
+					TOIResult r = this->timeOfImpact->toi<type1>(this->id1, triangle, this->t1);
+					if (r.state == TOIState::unresolved) {
+						this->result = r;
+						return false;
 					}
+					if (r.state == TOIState::overlaping && r.t < this->result.t) {
+						if (type2 == ColliderType::heightField) {
+							r.t += decimal(0.001);
+						}
+						this->result = r;
+					}
+					return true;
 				}
+			};
+
+			Kernel kernel = { this->timeOfImpact, id1, t1, TOIResult() };
+			if (collider2.intersects(aabbCast)) {
+				collider2.forEachTriangleOverlapped(aabbCast, kernel);
 			}
 
-			return toiResult;
+			return kernel.result;
 		}
 
-		TOIResult compoundVsOtherTOI(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2)
+		template<ColliderType type1, ColliderType type2>
+		TOIResult toi(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2, CompoundVsOther)
 		{
+			//every component is swept, the tree only holds where the compound ends the step
+			refreshComponents(this->physicsData, this->physicsData->compoundColliders[id1.colliderIndex]);
+
 			TOIResult toiResult;
-			for (auto it = this->physicsData->compoundColliders[id2.colliderIndex].components.begin(), end = this->physicsData->compoundColliders[id2.colliderIndex].components.end(); it != end; ++it) {
+			for (auto it = this->physicsData->compoundColliders[id1.colliderIndex].components.begin(), end = this->physicsData->compoundColliders[id1.colliderIndex].components.end(); it != end; ++it) {
 
-				uint32 functionIndex = (uint32)(this->physicsData->colliderIdentifiers[it.data()].type) + ((uint32)(id2.type) * 5);
-				TOIResult r = (this->*toiPtrs[functionIndex])(aabbCast, this->physicsData->colliderIdentifiers[it.data()], id2, t1, t2);
+				TOIResult r = this->toi(aabbCast, this->physicsData->colliderIdentifiers[it.data()], id2, t1, t2);
+				if (r.state == TOIState::unresolved) return r;
 				if (r.state == TOIState::overlaping && r.t < toiResult.t) {
 					toiResult = r;
 				}
@@ -564,13 +917,17 @@ namespace mech {
 			return toiResult;
 		}
 
-		TOIResult otherVsCompoundTOI(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2)
+		template<ColliderType type1, ColliderType type2>
+		TOIResult toi(const AABB& aabbCast, const ColliderIdentifier& id1, const ColliderIdentifier& id2, const Transform3DRange& t1, const Transform3DRange& t2, ConvexVsCompound)
 		{
+			HybridArray<uint32, 16, byte> componentIDs;
+			getComponentsOverlapped(this->physicsData, this->physicsData->compoundColliders[id2.colliderIndex], aabbCast, componentIDs);
+
 			TOIResult toiResult;
-			for (auto it = this->physicsData->compoundColliders[id2.colliderIndex].components.begin(), end = this->physicsData->compoundColliders[id2.colliderIndex].components.end(); it != end; ++it) {
+			for (auto it = componentIDs.begin(), end = componentIDs.end(); it != end; ++it) {
 
-				uint32 functionIndex = (uint32)(id1.type) + ((uint32)(this->physicsData->colliderIdentifiers[it.data()].type) * 5);
-				TOIResult r = (this->*toiPtrs[functionIndex])(aabbCast, id1, this->physicsData->colliderIdentifiers[it.data()], t1, t2);
+				TOIResult r = this->toi(aabbCast, id1, this->physicsData->colliderIdentifiers[it.data()], t1, t2);
+				if (r.state == TOIState::unresolved) return r;
 				if (r.state == TOIState::overlaping && r.t < toiResult.t) {
 					toiResult = r;
 				}
@@ -582,4 +939,3 @@ namespace mech {
 }
 
 #endif
-
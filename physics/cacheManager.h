@@ -46,30 +46,56 @@ namespace mech {
 
 			for (auto it = this->physicsData->contactImpulseCache.begin(), end = this->physicsData->contactImpulseCache.end(); it != end;) {
 
-				auto temp = it.data();
-				++it;
-
-				if (temp.second.retention > 0) {
-					--temp.second.retention;
+				if (it.data().second.retention > 0) {
+					--it.data().second.retention;
+					++it;
 				}
 				else {
+					auto temp = it.data();
+					++it;
 					this->physicsData->contactImpulseCache.eraseData(temp);
 				}
 			}
 
 			for (auto it = this->physicsData->hullVsHullContactCache.begin(), end = this->physicsData->hullVsHullContactCache.end(); it != end;) {
 
-				auto temp = it.data();
-				++it;
-
-				if (temp.second.retention > 0) {
-					--temp.second.retention;
+				if (it.data().second.retention > 0) {
+					--it.data().second.retention;
+					++it;
 				}
 				else {
+					auto temp = it.data();
+					++it;
 					this->physicsData->hullVsHullContactCache.eraseData(temp);
 				}
 			}
 
+			for (auto it = this->physicsData->gjkContactCache.begin(), end = this->physicsData->gjkContactCache.end(); it != end;) {
+
+				if (it.data().second.retention > 0) {
+					--it.data().second.retention;
+					++it;
+				}
+				else {
+					auto temp = it.data();
+					++it;
+					this->physicsData->gjkContactCache.eraseData(temp);
+				}
+			}
+
+			for (auto it = this->physicsData->persistentManifolds.begin(), end = this->physicsData->persistentManifolds.end(); it != end;) {
+
+				if (it.data().second.retention > 0) {
+					--it.data().second.retention;
+					++it;
+				}
+				else {
+					auto temp = it.data();
+					++it;
+					this->physicsData->persistentManifolds.eraseData(temp);
+				}
+			}
+
 			this->physicsData->contactConstraints.shallowClear(false);
 			this->physicsData->finishedCollisions.shallowClear(false);
 
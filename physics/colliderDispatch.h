@@ -0,0 +1,218 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef COLLIDERDISPATCH_H
+#define COLLIDERDISPATCH_H
+
+#include"physicsData.h"
+
+namespace mech {
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class ColliderKind : byte { convex = 0, compound = 1, triangles = 2 };
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//compile time description of every collider type, ties a ColliderType to its collider and its pool in PhysicsData
+	template<ColliderType type> struct ColliderTraits;
+
+	template<> struct ColliderTraits<ColliderType::convexHull> {
+		typedef ConvexHullCollider Collider;
+		static const ColliderKind kind = ColliderKind::convex;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return physicsData->convexHullColliders[colliderIndex]; }
+	};
+
+	template<> struct ColliderTraits<ColliderType::sphere> {
+		typedef SphereCollider Collider;
+		static const ColliderKind kind = ColliderKind::convex;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return physicsData->sphereColliders[colliderIndex]; }
+	};
+
+	template<> struct ColliderTraits<ColliderType::capsule> {
+		typedef CapsuleCollider Collider;
+		static const ColliderKind kind = ColliderKind::convex;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return physicsData->capsuleColliders[colliderIndex]; }
+	};
+
+	template<> struct ColliderTraits<ColliderType::compound> {
+		typedef CompoundCollider Collider;
+		static const ColliderKind kind = ColliderKind::compound;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return physicsData->compoundColliders[colliderIndex]; }
+	};
+
+	template<> struct ColliderTraits<ColliderType::box> {
+		typedef BoxCollider Collider;
+		static const ColliderKind kind = ColliderKind::convex;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return physicsData->boxColliders[colliderIndex]; }
+	};
+
+	template<> struct ColliderTraits<ColliderType::triangleMesh> {
+		typedef TriangleMeshCollider Collider;
+		static const ColliderKind kind = ColliderKind::triangles;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return physicsData->triangleMeshColliders[colliderIndex]; }
+	};
+
+	template<> struct ColliderTraits<ColliderType::heightField> {
+		typedef HeightFieldCollider Collider;
+		static const ColliderKind kind = ColliderKind::triangles;
+		static Collider& get(PhysicsData* physicsData, const uint32& colliderIndex) { return isAValidIndex(colliderIndex) ? physicsData->tiledHeightField.tiles[colliderIndex].collider : physicsData->heightFieldCollider; }
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//tags selecting the routine that handles a pair, the first type of a pair is always movable
+	struct ConvexPair {};
+	struct ConvexVsCompound {};
+	struct ConvexVsTriangles {};
+	struct CompoundVsOther {};
+
+	template<ColliderKind kind1, ColliderKind kind2> struct PairKindTraits;
+	template<> struct PairKindTraits<ColliderKind::convex, ColliderKind::convex> { typedef ConvexPair Tag; };
+	template<> struct PairKindTraits<ColliderKind::convex, ColliderKind::compound> { typedef ConvexVsCompound Tag; };
+	template<> struct PairKindTraits<ColliderKind::convex, ColliderKind::triangles> { typedef ConvexVsTriangles Tag; };
+	template<ColliderKind kind2> struct PairKindTraits<ColliderKind::compound, kind2> { typedef CompoundVsOther Tag; };
+
+	template<ColliderType type1, ColliderType type2>
+	struct PairTraits {
+		typedef typename PairKindTraits<ColliderTraits<type1>::kind, ColliderTraits<type2>::kind>::Tag Tag;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//the switch compiles to a jump table and visitor.visit<type>() is instantiated per case so it can be inlined,
+	//types disabled in core.h have no case and nothing involving them is instantiated
+	template<typename Visitor>
+	inline void dispatchMovable(const ColliderType& type, Visitor& visitor)
+	{
+		switch (type) {
+#if mech_ENABLE_CONVEX_HULL_COLLIDERS
+		case ColliderType::convexHull: visitor.template visit<ColliderType::convexHull>(); break;
+#endif
+#if mech_ENABLE_SPHERE_COLLIDERS
+		case ColliderType::sphere: visitor.template visit<ColliderType::sphere>(); break;
+#endif
+#if mech_ENABLE_CAPSULE_COLLIDERS
+		case ColliderType::capsule: visitor.template visit<ColliderType::capsule>(); break;
+#endif
+#if mech_ENABLE_COMPOUND_COLLIDERS
+		case ColliderType::compound: visitor.template visit<ColliderType::compound>(); break;
+#endif
+#if mech_ENABLE_BOX_COLLIDERS
+		case ColliderType::box: visitor.template visit<ColliderType::box>(); break;
+#endif
+		default: ASSERT(false, "collider type is not movable or is disabled"); break;
+		}
+	}
+
+	template<typename Visitor>
+	inline void dispatch(const ColliderType& type, Visitor& visitor)
+	{
+		switch (type) {
+#if mech_ENABLE_TRIANGLE_MESH_COLLIDERS
+		case ColliderType::triangleMesh: visitor.template visit<ColliderType::triangleMesh>(); break;
+#endif
+#if mech_ENABLE_HEIGHT_FIELD_COLLIDERS
+		case ColliderType::heightField: visitor.template visit<ColliderType::heightField>(); break;
+#endif
+		default: dispatchMovable(type, visitor); break;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template<typename Visitor, ColliderType type1>
+	struct SecondTypeDispatcher {
+		Visitor& visitor;
+		template<ColliderType type2> void visit() { this->visitor.template visit<type1, type2>(); }
+	};
+
+	template<typename Visitor>
+	struct FirstTypeDispatcher {
+		Visitor& visitor;
+		ColliderType type2;
+		template<ColliderType type1> void visit()
+		{
+			SecondTypeDispatcher<Visitor, type1> dispatcher = { this->visitor };
+			dispatch(this->type2, dispatcher);
+		}
+	};
+
+	//calls visitor.visit<type1, type2>(), type1 has to be movable
+	template<typename Visitor>
+	inline void dispatchPair(const ColliderType& type1, const ColliderType& type2, Visitor& visitor)
+	{
+		FirstTypeDispatcher<Visitor> dispatcher = { visitor, type2 };
+		dispatchMovable(type1, dispatcher);
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct ColliderTransformer {
+
+		PhysicsData* physicsData;
+		uint32 colliderIndex;
+		const Transform3D& t;
+
+		template<ColliderType type>
+		void visit()
+		{
+			ColliderTraits<type>::get(this->physicsData, this->colliderIndex).transform(this->t);
+		}
+
+		static void transformCollider(PhysicsData* physicsData, const uint32& colliderID, const Transform3D& t)
+		{
+			ColliderTransformer transformer = { physicsData, physicsData->colliderIdentifiers[colliderID].colliderIndex, t };
+			dispatchMovable(physicsData->colliderIdentifiers[colliderID].type, transformer);
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//brings a component to where its compound is
+	inline void refreshComponent(PhysicsData* physicsData, CompoundCollider& compoundCollider, const byte& index)
+	{
+		if (compoundCollider.componentStamps[index] != compoundCollider.stamp) {
+			ColliderTransformer::transformCollider(physicsData, compoundCollider.components[index], compoundCollider.worldTransform * getInverse(compoundCollider.componentTransforms[index]));
+			compoundCollider.componentTransforms[index] = compoundCollider.worldTransform;
+			compoundCollider.componentStamps[index] = compoundCollider.stamp;
+		}
+	}
+
+	//collider ids of the components whose bound overlaps aabb, only those components are brought up to date
+	inline void getComponentsOverlapped(PhysicsData* physicsData, CompoundCollider& compoundCollider, const AABB& aabb, HybridArray<uint32, 16, byte>& componentIDs)
+	{
+		HybridArray<byte, 16, byte> indices;
+		compoundCollider.getComponentsOverlapped(aabb, indices);
+		for (byte x = 0, len = indices.size(); x < len; ++x) {
+			refreshComponent(physicsData, compoundCollider, indices[x]);
+			componentIDs.pushBack(compoundCollider.components[indices[x]]);
+		}
+	}
+
+	inline void refreshComponents(PhysicsData* physicsData, CompoundCollider& compoundCollider)
+	{
+		for (byte x = 0, len = compoundCollider.components.size(); x < len; ++x) {
+			refreshComponent(physicsData, compoundCollider, x);
+		}
+	}
+}
+
+#endif
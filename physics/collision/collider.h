@@ -33,18 +33,20 @@
 #include"../../geometry/convexHull.h"
 #include"../../geometry/sphere.h"
 #include"../../geometry/capsule.h"
+#include"../../geometry/obb.h"
 #include"../../geometry/polygon.h"
 #include"../../geometry/triangleMesh.h"
+#include"../../containers/stackArray.h"
 #include"../heightField.h"
 #include"../material.h"
 
 namespace mech {
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
-	enum class ColliderType : byte { convexHull = 0, sphere = 1, capsule = 2, compound = 3, triangleMesh = 4, heightField = 5, noType = 6 };
+	enum class ColliderType : byte { convexHull = 0, sphere = 1, capsule = 2, compound = 3, box = 4, triangleMesh = 5, heightField = 6, noType = 7 }; //types that can move come first, see colliderDispatch.h
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
-	enum class ColliderMotionState : byte { motionless = 0, dynamic = 1 };
+	enum class ColliderMotionState : byte { motionless = 0, dynamic = 1, kinematic = 2 }; //kinematic colliders move as they are told, see RigidBody::makeKinematic
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct ColliderIdentifier {
@@ -52,8 +54,13 @@ namespace mech {
 		uint32 colliderID = -1;
 		uint32 colliderIndex = -1;
 		uint32 objectIndex = -1;
+		uint32 compoundID = -1; //the compound the collider is a component of
 		ColliderType type = ColliderType::noType;
 		ColliderMotionState state = ColliderMotionState::motionless;
+		byte layer = 0; //see CollisionFilter
+		uint32 layerMask = 0xFFFFFFFF; //bit x is set when the collider collides with layer x
+		bool isSensor = false; //reports overlaps instead of colliding, see SensorDetector
+		bool reportsContacts = false; //pairs involving the collider make contact events, see ContactEventRecorder
 
 		ColliderIdentifier() {}
 		ColliderIdentifier(const ColliderType& t) : type(t) {}
@@ -155,31 +162,265 @@ namespace mech {
 		decimal getVolume() { return mathPI * this->collider.radius * this->collider.radius * this->collider.capsuleLine.getLength() + decimal(4.0) * mathPI * this->collider.radius * this->collider.radius * this->collider.radius / decimal(3.0); } 
 	};
 
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct BoxCollider {
+
+		OBB collider;
+		AABB bound = AABB(nanVEC3, nanVEC3);
+		decimal convexRadius = decimalNAN;
+
+		BoxCollider() {}
+		BoxCollider(const OBB& obb) : collider(obb)
+		{
+			this->bound = this->collider.toAABB();
+			this->convexRadius = magnitude(this->collider.halfExtents);
+		}
+
+		void transform(const Transform3D& t)
+		{
+			this->collider.transform(t);
+			this->bound = this->collider.toAABB();
+		}
+
+		decimal getVolume() { return decimal(8.0) * this->collider.halfExtents.x * this->collider.halfExtents.y * this->collider.halfExtents.z; }
+	};
+
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct CompoundCollider {
 
+		//local space AABB tree over the components, a leaf holds a single component
+		struct Node {
+			AABB bound;
+			uint16 left = -1;
+			uint16 right = -1;
+			byte component = -1;
+		};
+
 		HybridArray<uint32, 4, byte> components;
+		DynamicArray<AABB, byte> localBounds;
+		DynamicArray<Transform3D, byte> componentTransforms; //compound transform each component was last brought to
+		DynamicArray<uint32, byte> componentStamps;
+		DynamicArray<Node, uint16> tree;
+		Transform3D worldTransform; //components only follow it when a query reaches them, see getComponentsOverlapped in colliderDispatch.h
+		uint32 stamp = 0; //bumped every time the compound moves
 		AABB bound = AABB(nanVEC3, nanVEC3);
 		decimal convexRadius = decimalNAN;
 
 		CompoundCollider() {}
 		CompoundCollider(const uint32& id) {}
+
+		//the component is expected to already be at worldTransform
+		void addComponent(const uint32& colliderID, const AABB& localBound)
+		{
+			this->components.pushBack(colliderID);
+			this->localBounds.pushBack(localBound);
+			this->componentTransforms.pushBack(this->worldTransform);
+			this->componentStamps.pushBack(this->stamp);
+		}
+
+		void buildTree()
+		{
+			this->tree.clear();
+			if (this->components.empty()) return;
+
+			DynamicArray<byte, byte> indices;
+			for (byte x = 0, len = this->components.size(); x < len; ++x) {
+				indices.pushBack(x);
+			}
+			this->buildNode(indices, 0, indices.size());
+			this->updateBound();
+		}
+
+		void transform(const Transform3D& t)
+		{
+			this->worldTransform = t * this->worldTransform;
+			++this->stamp;
+			this->updateBound();
+		}
+
+		void updateBound()
+		{
+			if (this->tree.empty()) return;
+			this->bound = this->tree[0].bound.toOBB().transformed(this->worldTransform).toAABB();
+		}
+
+		//indices into components of the leaves whose bound overlaps aabb, aabb is in world space
+		void getComponentsOverlapped(const AABB& aabb, HybridArray<byte, 16, byte>& indices) const
+		{
+			if (this->tree.empty()) return;
+
+			this->getComponentsOverlapped(aabb.toOBB().transformed(getInverse(this->worldTransform)).toAABB(), 0, indices);
+		}
+
+	private:
+
+		void getComponentsOverlapped(const AABB& localAABB, const uint16& nodeIndex, HybridArray<byte, 16, byte>& indices) const
+		{
+			const Node& node = this->tree[nodeIndex];
+			if (node.bound.intersects(localAABB) == false) return;
+
+			if (isAValidIndex(node.component)) {
+				indices.pushBack(node.component);
+			}
+			else {
+				this->getComponentsOverlapped(localAABB, node.left, indices);
+				this->getComponentsOverlapped(localAABB, node.right, indices);
+			}
+		}
+
+		//splits at the middle of the centroids along their widest axis, falls back to halving the range when every centroid lands on one side
+		uint16 buildNode(DynamicArray<byte, byte>& indices, const byte& first, const byte& last)
+		{
+			uint16 nodeIndex = this->tree.size();
+			this->tree.pushBack(Node());
+
+			AABB bound = this->localBounds[indices[first]];
+			AABB centroids = AABB(bound.getCenter(), bound.getCenter());
+			for (byte x = first + 1; x < last; ++x) {
+				const AABB& b = this->localBounds[indices[x]];
+				bound.min = minVec(bound.min, b.min);
+				bound.max = maxVec(bound.max, b.max);
+				centroids.min = minVec(centroids.min, b.getCenter());
+				centroids.max = maxVec(centroids.max, b.getCenter());
+			}
+			this->tree[nodeIndex].bound = bound;
+
+			if (last - first == 1) {
+				this->tree[nodeIndex].component = indices[first];
+				return nodeIndex;
+			}
+
+			Vec3 dimensions = centroids.getDimensions();
+			byte axis = 0;
+			if (dimensions.y > dimensions.x) axis = 1;
+			if (dimensions.z > dimensions[axis]) axis = 2;
+			decimal split = centroids.getCenter()[axis];
+
+			byte middle = first;
+			for (byte x = first; x < last; ++x) {
+				if (this->localBounds[indices[x]].getCenter()[axis] < split) {
+					byte temp = indices[x];
+					indices[x] = indices[middle];
+					indices[middle] = temp;
+					++middle;
+				}
+			}
+
+			if (middle == first || middle == last) {
+				middle = first + (last - first) / 2;
+			}
+
+			uint16 left = this->buildNode(indices, first, middle);
+			uint16 right = this->buildNode(indices, middle, last);
+			this->tree[nodeIndex].left = left;
+			this->tree[nodeIndex].right = right;
+
+			return nodeIndex;
+		}
 	};
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//the mesh stays in its local space, queries are taken into it and the triangles found are brought back to world space
 	struct TriangleMeshCollider {
 
 		TriangleMesh collider;
+		Transform3D transform; //local to world
+		Transform3D inverseTransform;
 		AABB bound = AABB(nanVEC3, nanVEC3);
+		StackArray<uint16, 8> nodesIntersected; //octree nodes holding the mesh, updated when it moves
+		bool isTransformed = false; //false while the local and world spaces are the same
 
 		TriangleMeshCollider() {}
 		TriangleMeshCollider(const TriangleMesh& mesh) : collider(mesh)
 		{
-			this->bound = this->collider.bvh.nodes[this->collider.bvh.parentNode].bound;
+			this->updateBound();
+		}
+
+		void setTransform(const Transform3D& t)
+		{
+			this->transform = t;
+			this->inverseTransform = getInverse(t);
+			this->isTransformed = true;
+			this->updateBound();
+		}
+
+		void updateBound()
+		{
+			this->bound = this->isTransformed ? this->collider.bound.toOBB().transformed(this->transform).toAABB() : this->collider.bound;
+		}
+
+		bool intersects(const AABB& aabb) const
+		{
+			return this->bound.intersects(aabb) && this->collider.intersects(this->toLocal(aabb));
+		}
+
+		void getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles) const
+		{
+			TriangleCollector collector = { triangles };
+			this->forEachTriangleOverlapped(aabb, collector);
+		}
+
+		//the transform is rigid so distances along the ray are the same in both spaces, triangleHit is in world space
+		decimal rayCastTime(const Ray& ray, const decimal& maxT, Triangle& triangleHit, const bool& anyHit = false) const
+		{
+			if (this->isTransformed == false) return this->collider.rayCastTime(ray, maxT, triangleHit, anyHit);
+
+			decimal t = this->collider.rayCastTime(ray.transformed(this->inverseTransform), maxT, triangleHit, anyHit);
+			if (t >= decimal(0.0)) {
+				triangleHit = triangleHit.transformed(this->transform);
+			}
+			return t;
+		}
+
+		int32 rayCastPacket(const RayPacket& packet, float* maxT, Triangle* trianglesHit, const bool& anyHit = false) const
+		{
+			if (this->isTransformed == false) return this->collider.rayCastPacket(packet, maxT, trianglesHit, anyHit);
+
+			Ray rays[RAY_PACKET_SIZE];
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+				rays[lane] = packet.rays[lane].transformed(this->inverseTransform);
+			}
+
+			int32 hitMask = this->collider.rayCastPacket(RayPacket(rays, packet.activeMask), maxT, trianglesHit, anyHit);
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+				if ((hitMask & (1 << lane)) != 0) {
+					trianglesHit[lane] = trianglesHit[lane].transformed(this->transform);
+				}
+			}
+			return hitMask;
+		}
+
+		template<typename Visitor>
+		void forEachTriangleOverlapped(const AABB& aabb, Visitor& visitor) const
+		{
+			if (this->isTransformed) {
+				ToWorld<Visitor> toWorld = { this->transform, visitor };
+				this->collider.forEachTriangleOverlapped(this->toLocal(aabb), toWorld);
+			}
+			else {
+				this->collider.forEachTriangleOverlapped(aabb, visitor);
+			}
+		}
+
+	private:
+
+		template<typename Visitor>
+		struct ToWorld {
+			const Transform3D& transform;
+			Visitor& visitor;
+
+			bool visit(const Triangle& triangle) { return this->visitor.visit(triangle.transformed(this->transform)); }
+		};
+
+		AABB toLocal(const AABB& aabb) const
+		{
+			return this->isTransformed ? aabb.toOBB().transformed(this->inverseTransform).toAABB() : aabb;
 		}
 	};
 
@@ -188,6 +429,15 @@ namespace mech {
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct HeightFieldCollider {
 		HeightField collider;
+
+		bool intersects(const AABB& aabb) const { return this->collider.intersects(aabb); }
+		void getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles) const { this->collider.getTrianglesOverlapped(aabb, triangles); }
+
+		template<typename Visitor>
+		void forEachTriangleOverlapped(const AABB& aabb, Visitor& visitor) const { this->collider.forEachTriangleOverlapped(aabb, visitor); }
+
+		decimal rayCastTime(const Ray& ray, const decimal& maxT, Triangle& triangleHit, const bool& /*anyHit*/ = false) const { return this->collider.rayCastTime(ray, maxT, triangleHit); }
+		int32 rayCastPacket(const RayPacket& packet, float* maxT, Triangle* trianglesHit, const bool& /*anyHit*/ = false) const { return this->collider.rayCastPacket(packet, maxT, trianglesHit); }
 	};
 }
 
@@ -29,26 +29,60 @@
 #define CONTACT_H
 
 #include"collider.h"
+#include"../../geometry/algorithms/GJK.h"
 #include"../../core/debugRenderer.h"
 
 namespace mech {
 
 #define MAXIMUN_MANIFOLD_CONTACT_POINTS 8
+#define MAXIMUM_PERSISTENT_CONTACT_POINTS 4
 
 	//////////////////////////////////////////////////////////////////////////////////////////
-	enum class CollisionFlag : byte { NOTCOLLIDING = 1 << 0, PROXIMAL = 1 << 1, PENETRATING = 1 << 2};
+	enum class CollisionFlag : byte { NOTCOLLIDING = 1 << 0, PROXIMAL = 1 << 1, PENETRATING = 1 << 2, SPECULATIVE = 1 << 3 };
 
 	//////////////////////////////////////////////////////////////////////////////////////////
 	struct HullVsHullContactCache {
 		Vec3 center1 = nanVEC3;
 		Vec3 center2 = nanVEC3;
-		uint32 ID1 = -1;
+		uint32 ID1 = -1; //id of the collider that owns refFace / edge1
 		uint16 refFace = -1;
 		uint16 incidentFace = -1;
+		uint16 edge1 = -1;
+		uint16 edge2 = -1;
+		/*
+			--------------cache flags----------------
+			cache is not empty                - 0b00000001
+			cached axis is a face normal      - 0b00000010
+			cached axis is an edge pair       - 0b00000100
+			cached axis separates the hulls   - 0b00001000
+		*/
 		byte cacheFlags = 0;
 		byte retention = 0;
 	};
 
+	//////////////////////////////////////////////////////////////////////////////////////////
+	struct GJKContactCache {
+		GJKSimplexCache simplex;
+		byte retention = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	//contact points of a pair kept across frames in the local space of each body (world space for motionless colliders)
+	struct PersistentManifold {
+
+		struct Point {
+			Vec3 localPosition[2];
+			Vec3 localNormal; //in the local space of body 1
+			uint32 ID = -1;
+		};
+
+		Point points[MAXIMUM_PERSISTENT_CONTACT_POINTS] = {};
+		Quaternion relativeOrientation = IDENTITY_QUATERNION; //orientation of body 2 relative to body 1 when the points were generated
+		uint32 nextID = 0;
+		byte numPoints = 0;
+		byte retention = 0;
+	};
+
 	//////////////////////////////////////////////////////////////////////////////////////////
 	struct ContactPoint {
 		Vec3 position[2];
@@ -0,0 +1,125 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef COLLISIONFILTER_H
+#define COLLISIONFILTER_H
+
+#include"collision/collider.h"
+#include"../containers/hashTable.h"
+#include"../containers/hybridArray.h"
+
+namespace mech {
+
+#define MAXIMUM_COLLISION_LAYERS 32
+
+	/*
+		decides whether two colliders are worth handing to the narrow phase, it runs before any manifold is generated.
+		a pair is dropped when
+		- neither collider is dynamic (static and kinematic colliders do not respond to each other)
+		- both belong to the same body (a collider and itself or the components of a compound)
+		- the layer matrix or the layer mask of either collider excludes the layer of the other
+		- the pair has been ignored, see ignorePair
+	*/
+	struct CollisionFilter {
+
+		uint32 layerMatrix[MAXIMUM_COLLISION_LAYERS]; //bit y of layerMatrix[x] is set when layers x and y collide, kept symmetric
+		HashTable<uint64, uint32> ignoredPairs; //HashTable<getPairKey(...), ...
+
+		CollisionFilter()
+		{
+			for (byte x = 0; x < MAXIMUM_COLLISION_LAYERS; ++x) {
+				this->layerMatrix[x] = 0xFFFFFFFF;
+			}
+		}
+
+		static uint64 getPairKey(const uint32& id1, const uint32& id2)
+		{
+			return id1 < id2 ? ((uint64)id1 << 32) | id2 : ((uint64)id2 << 32) | id1;
+		}
+
+		void setLayerCollision(const byte& layer1, const byte& layer2, const bool& collide)
+		{
+			ASSERT(layer1 < MAXIMUM_COLLISION_LAYERS && layer2 < MAXIMUM_COLLISION_LAYERS, "invalid collision layer");
+
+			if (collide) {
+				this->layerMatrix[layer1] |= (1u << layer2);
+				this->layerMatrix[layer2] |= (1u << layer1);
+			}
+			else {
+				this->layerMatrix[layer1] &= ~(1u << layer2);
+				this->layerMatrix[layer2] &= ~(1u << layer1);
+			}
+		}
+
+		void ignorePair(const uint32& id1, const uint32& id2)
+		{
+			uint64 key = getPairKey(id1, id2);
+			if (this->ignoredPairs.find(key) == nullptr) {
+				this->ignoredPairs.insert(key);
+			}
+		}
+
+		void restorePair(const uint32& id1, const uint32& id2)
+		{
+			this->ignoredPairs.eraseData(getPairKey(id1, id2));
+		}
+
+		//drops every ignored pair the collider is part of, its id can be reused after it has been erased
+		void eraseCollider(const uint32& id)
+		{
+			if (this->ignoredPairs.empty()) return;
+
+			HybridArray<uint64, 8, uint32> keys;
+			for (auto it = this->ignoredPairs.begin(), end = this->ignoredPairs.end(); it != end; ++it) {
+				if ((uint32)(it.data() >> 32) == id || (uint32)it.data() == id) keys.pushBack(it.data());
+			}
+
+			for (uint32 x = 0, len = keys.size(); x < len; ++x) {
+				this->ignoredPairs.eraseData(keys[x]);
+			}
+		}
+
+		bool shouldCollide(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		{
+			if (identifier1.state != ColliderMotionState::dynamic && identifier2.state != ColliderMotionState::dynamic) return false;
+			return this->passesFilters(identifier1, identifier2);
+		}
+
+		//every test but the motion states
+		bool passesFilters(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		{
+			if (identifier1.objectIndex == identifier2.objectIndex && isAValidIndex(identifier1.objectIndex)) return false;
+
+			if ((this->layerMatrix[identifier1.layer] & (1u << identifier2.layer)) == 0) return false;
+			if ((identifier1.layerMask & (1u << identifier2.layer)) == 0 || (identifier2.layerMask & (1u << identifier1.layer)) == 0) return false;
+
+			return this->ignoredPairs.empty() || this->ignoredPairs.find(getPairKey(identifier1.colliderID, identifier2.colliderID)) == nullptr;
+		}
+	};
+}
+
+#endif
@@ -107,15 +107,35 @@ namespace mech {
 			END_PROFILE;
 		}
 
-		void add(const ContactManifold& manifold, const uint32& objectIndex1, const uint32& objectIndex2)
+		//velocity only pass over the contact constraints added since first, used at time of impact events
+		void solveContacts(const uint32& first)
 		{
-			this->physicsData->contactConstraints.pushBack(ContactConstraint(this->physicsData, manifold, objectIndex1, objectIndex2));
+			BEGIN_PROFILE("ConstraintSolver::solveContacts");
+
+			for (byte iteration = 0; iteration < this->physicsData->settings.velocityIterations; ++iteration) {
+				for (uint32 x = first, len = this->physicsData->contactConstraints.size(); x < len; ++x) {
+					if (iteration == 0) {
+						this->physicsData->contactConstraints[x].warmStart(physicsData);
+					}
+					this->physicsData->contactConstraints[x].solve(physicsData, this->physicsData->settings.baumgarteFactor, this->physicsData->settings.linearSlop, false, false);
+				}
+			}
+
+			END_PROFILE;
+		}
+
+		void add(const ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
+		{
+			ContactConstraint constraint = ContactConstraint(this->physicsData, manifold, identifier1.objectIndex, identifier2.objectIndex);
+			constraint.colliderID[0] = identifier1.colliderID;
+			constraint.colliderID[1] = identifier2.colliderID;
+			this->physicsData->contactConstraints.pushBack(constraint);
 		}
 
 		void add(const HingeConstraint::Parameters& parameters)
 		{
 			if (parameters.disableCollisions == true) {
-				this->physicsData->physicsObjects[this->physicsData->colliderIdentifiers[parameters.colliderID1].objectIndex].diableCollision(this->physicsData, parameters.colliderID2);
+				this->physicsData->collisionFilter.ignorePair(parameters.colliderID1, parameters.colliderID2);
 			}
 			this->physicsData->hingeConstraints.insert(HingeConstraint(this->physicsData, parameters));
 		}
@@ -123,7 +143,7 @@ namespace mech {
 		void add(const ConeConstraint::Parameters& parameters)
 		{
 			if (parameters.disableCollisions == true) {
-				this->physicsData->physicsObjects[this->physicsData->colliderIdentifiers[parameters.colliderID1].objectIndex].diableCollision(this->physicsData, parameters.colliderID2);
+				this->physicsData->collisionFilter.ignorePair(parameters.colliderID1, parameters.colliderID2);
 			}
 			this->physicsData->coneConstraints.insert(ConeConstraint(this->physicsData, parameters));
 		}
@@ -131,7 +151,7 @@ namespace mech {
 		void add(const MotorConstraint::Parameters& parameters)
 		{
 			if (parameters.disableCollisions == true) {
-				this->physicsData->physicsObjects[this->physicsData->colliderIdentifiers[parameters.colliderID1].objectIndex].diableCollision(this->physicsData, parameters.colliderID2);
+				this->physicsData->collisionFilter.ignorePair(parameters.colliderID1, parameters.colliderID2);
 			}
 			this->physicsData->motorConstraints.insert(MotorConstraint(this->physicsData, parameters));
 		}
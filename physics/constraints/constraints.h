@@ -73,10 +73,13 @@ namespace mech {
 		};
 
 		ContactData contactData[MAXIMUM_CONTACT_POINTS] = {};
+		Vec3 point; //average of the contact points, reported by contact events
 		decimal frictionCoefficient = decimal(0.0);
 		StackArray<uint32, 2> objectIndex = StackArray<uint32, 2>(-1);
+		StackArray<uint32, 2> colliderID = StackArray<uint32, 2>(-1);
 		uint32 impulseCacheID = -1;
 		byte contactPointCount = 0;
+		bool warmStarted = false; //constraints solved during continous collision detection are warm started before the main solve
 
 		ContactConstraint() {}
 		ContactConstraint(PhysicsData* physicsData, const ContactManifold& manifold, const uint32& objectIndex1, const uint32& objectIndex2);
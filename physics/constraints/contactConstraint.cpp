@@ -54,6 +54,7 @@ namespace mech {
 		for (byte x = 0; x < this->contactPointCount; ++x) {
 
 			this->contactData[x].ID = manifold.contactPoints[x].ID;
+			this->point += (manifold.contactPoints[x].position[0] + manifold.contactPoints[x].position[1]) * decimal(0.5);
 
 			StackArray<Vec3, 2> r;
 			Vec3 deltaVelocity;
@@ -71,17 +72,31 @@ namespace mech {
 
 			this->contactData[x].penetration = dotProduct(this->contactData[x].normal, manifold.contactPoints[x].position[1] - manifold.contactPoints[x].position[0]);
 
-			decimal normalVelocity = mathABS(dotProduct(this->contactData[x].normal, deltaVelocity));
-			decimal penetrationBias = coeficientOfRestitution * (normalVelocity > physicsData->settings.minVelocityForRestitution ? normalVelocity : decimal(0.0));
+			decimal penetrationBias = decimal(0.0);
+			if (this->contactData[x].penetration > decimal(0.0)) {
+				//speculative contact, the bodies may still approach by the gap within this step
+				penetrationBias = -this->contactData[x].penetration / physicsData->deltaTime;
+			}
+			else {
+				decimal normalVelocity = mathABS(dotProduct(this->contactData[x].normal, deltaVelocity));
+				penetrationBias = coeficientOfRestitution * (normalVelocity > physicsData->settings.minVelocityForRestitution ? normalVelocity : decimal(0.0));
+			}
 
 			this->contactData[x].penetrationConstraint.initialise(this->contactData[x].normal, bodies, r, invI, invMass, penetrationBias);
 			this->contactData[x].frictionConstraint1.initialise(this->contactData[x].tangent1, bodies, r, invI, invMass, decimal(0.0));
 			this->contactData[x].frictionConstraint2.initialise(this->contactData[x].tangent2, bodies, r, invI, invMass, decimal(0.0));
 		}
+
+		if (this->contactPointCount > 0) {
+			this->point = this->point / decimal(this->contactPointCount);
+		}
 	}
 
 	void ContactConstraint::warmStart(PhysicsData* physicsData)
 	{
+		if (this->warmStarted) return;
+		this->warmStarted = true;
+
 		ImpulseCache& impulseCache = physicsData->contactImpulseCache[physicsData->contactImpulseCache.insert(this->impulseCacheID)].second;
 	
 		if (impulseCache.retention != 0) {
@@ -96,7 +111,7 @@ namespace mech {
 				invMass[y] = bodies[y]->invMass;
 			}
 
-			for (byte x = 0, len = impulseCache.impulses.size(); x < len; ++x) {
+			for (byte x = 0; x < this->contactPointCount; ++x) {
 
 				Pair<uint32, ImpulseCache::Impulse>* impPtr = impulseCache.impulses.find(this->contactData[x].ID);
 
@@ -179,6 +194,19 @@ namespace mech {
 			else {
 				bodies[0]->activate();
 			}
+
+			//a kinematic body pushing a sleeping one is not in its island
+			if (bodies[1] && bodies[1]->isActive() == false) {
+				const PhysicsObject& object = physicsData->physicsObjects[this->objectIndex[1]];
+				if (isAValidIndex(object.islandIndex)) {
+					for (auto it = physicsData->islands[object.islandIndex].begin(), end = physicsData->islands[object.islandIndex].end(); it != end; ++it) {
+						physicsData->physicsObjects[physicsData->colliderIdentifiers[it.data()].objectIndex].rigidBody.activate();
+					}
+				}
+				else {
+					bodies[1]->activate();
+				}
+			}
 		}
 	}
 }
\ No newline at end of file
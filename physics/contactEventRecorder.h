@@ -0,0 +1,187 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef CONTACTEVENTRECORDER_H
+#define CONTACTEVENTRECORDER_H
+
+#include"physicsData.h"
+
+namespace mech {
+
+	/*
+		turns the contact constraints of a step into events once the solver is done with them, only pairs where either collider reports contacts are looked at.
+		a compound is reported as a whole, the contacts of its components with a collider are merged into one event.
+		a pair begins the first step it touches, persists while it keeps touching and ends the first step it does not.
+		pairs whose bodies all sleep are kept without events, events stay in the ring buffer until they are popped or overwritten
+	*/
+	struct ContactEventRecorder {
+
+		PhysicsData* physicsData = nullptr;
+		HashTable<Pair<uint64, bool>, uint32> solvedPairs; //HashTable<Pair<CollisionFilter::getPairKey(...), ...>............ constraint pairs already counted this step
+		HashTable<Pair<uint64, uint32>, uint32> stepEventIndices; //HashTable<Pair<CollisionFilter::getPairKey(...), index into stepEvents>............ keyed by the reported pair
+		DynamicArray<Pair<ContactEvent, uint32>, uint32> stepEvents; //DynamicArray<Pair<event, number of contact points merged into it>...
+
+		ContactEventRecorder() {}
+		ContactEventRecorder(const ContactEventRecorder&) = delete;
+		ContactEventRecorder& operator=(const ContactEventRecorder&) = delete;
+
+		void update()
+		{
+			BEGIN_PROFILE("ContactEventRecorder::update");
+
+			if (this->physicsData->contactEvents.capacity() != this->physicsData->settings.contactEventCapacity) {
+				this->physicsData->contactEvents.reserve(this->physicsData->settings.contactEventCapacity);
+			}
+
+			this->solvedPairs.shallowClear(false);
+			this->stepEventIndices.shallowClear(false);
+			this->stepEvents.shallowClear(false);
+
+			for (uint32 x = 0, len = this->physicsData->contactConstraints.size(); x < len; ++x) {
+
+				const ContactConstraint& constraint = this->physicsData->contactConstraints[x];
+				if (this->physicsData->colliderIdentifiers[constraint.colliderID[0]].reportsContacts == false && this->physicsData->colliderIdentifiers[constraint.colliderID[1]].reportsContacts == false) continue;
+
+				//speculative contacts that the bodies never closed do not count
+				decimal impulse = decimal(0.0);
+				Vec3 normal;
+				bool touching = false;
+				for (byte y = 0; y < constraint.contactPointCount; ++y) {
+					impulse += constraint.contactData[y].penetrationConstraint.totalLambda;
+					normal += constraint.contactData[y].normal;
+					touching = touching || constraint.contactData[y].penetration <= decimal(0.0);
+				}
+				if (touching == false && impulse <= decimal(0.0)) continue;
+
+				//a pair solved more than once in a step (at a time of impact and again later) is reported once
+				uint64 solvedKey = CollisionFilter::getPairKey(constraint.colliderID[0], constraint.colliderID[1]);
+				if (this->solvedPairs.find(Pair<uint64, bool>(solvedKey)) != nullptr) continue;
+				this->solvedPairs.insert(Pair<uint64, bool>(solvedKey, true));
+
+				//components are reported as their compound, the contacts of every component with a collider make one event
+				uint32 colliderID1 = this->getReportedID(constraint.colliderID[0]);
+				uint32 colliderID2 = this->getReportedID(constraint.colliderID[1]);
+				uint64 key = CollisionFilter::getPairKey(colliderID1, colliderID2);
+				Pair<uint64, uint32>* index = this->stepEventIndices.find(Pair<uint64, uint32>(key));
+
+				if (index != nullptr) {
+					Pair<ContactEvent, uint32>& stepEvent = this->stepEvents[index->second];
+					stepEvent.first.impulse += impulse;
+					stepEvent.first.normal += stepEvent.first.colliderID1 == colliderID1 ? normal : normal * decimal(-1.0);
+					stepEvent.first.point += constraint.point * decimal(constraint.contactPointCount);
+					stepEvent.second += constraint.contactPointCount;
+					continue;
+				}
+
+				ContactEvent event;
+				event.impulse = impulse;
+				event.normal = normal;
+				event.point = constraint.point * decimal(constraint.contactPointCount);
+				event.colliderID1 = colliderID1;
+				event.colliderID2 = colliderID2;
+				this->stepEventIndices.insert(Pair<uint64, uint32>(key, this->stepEvents.size()));
+				this->stepEvents.pushBack(Pair<ContactEvent, uint32>(event, constraint.contactPointCount));
+			}
+
+			for (uint32 x = 0, len = this->stepEvents.size(); x < len; ++x) {
+
+				ContactEvent& event = this->stepEvents[x].first;
+				uint64 key = CollisionFilter::getPairKey(event.colliderID1, event.colliderID2);
+				Pair<uint64, bool>* pair = this->physicsData->contactPairs.find(Pair<uint64, bool>(key));
+
+				if (pair != nullptr) {
+					pair->second = true;
+					event.type = ContactEventType::persist;
+				}
+				else {
+					this->physicsData->contactPairs.insert(Pair<uint64, bool>(key, true));
+					event.type = ContactEventType::begin;
+				}
+
+				event.point /= decimal(this->stepEvents[x].second);
+				event.normal = normalise(event.normal);
+				this->push(event);
+			}
+
+			for (auto it = this->physicsData->contactPairs.begin(), end = this->physicsData->contactPairs.end(); it != end;) {
+
+				if (it.data().second == true) {
+					it.data().second = false;
+					++it;
+					continue;
+				}
+
+				auto temp = it.data();
+				++it;
+
+				uint32 colliderID1 = (uint32)(temp.first >> 32);
+				uint32 colliderID2 = (uint32)temp.first;
+				if (this->isSleeping(colliderID1, colliderID2)) continue;
+
+				ContactEvent event;
+				event.colliderID1 = colliderID1;
+				event.colliderID2 = colliderID2;
+				event.type = ContactEventType::end;
+				this->push(event);
+
+				this->physicsData->contactPairs.eraseData(temp);
+			}
+
+			END_PROFILE;
+		}
+
+	private:
+
+		void push(const ContactEvent& event)
+		{
+			if (this->physicsData->contactEvents.push(event) == false) {
+				++this->physicsData->statistics.contactEventsOverwritten;
+			}
+		}
+
+		//the compound of a component, the collider itself otherwise
+		uint32 getReportedID(const uint32& colliderID)
+		{
+			const uint32& compoundID = this->physicsData->colliderIdentifiers[colliderID].compoundID;
+			return isAValidIndex(compoundID) ? compoundID : colliderID;
+		}
+
+		//both colliders are still in the world and no body of the pair moves
+		bool isSleeping(const uint32& colliderID1, const uint32& colliderID2)
+		{
+			if (this->physicsData->colliderIdentifiers.isIndexOccupied(colliderID1) == false || this->physicsData->colliderIdentifiers.isIndexOccupied(colliderID2) == false) return false;
+
+			uint32 objectIndices[2] = { this->physicsData->colliderIdentifiers[colliderID1].objectIndex, this->physicsData->colliderIdentifiers[colliderID2].objectIndex };
+			for (byte x = 0; x < 2; ++x) {
+				if (isAValidIndex(objectIndices[x]) && this->physicsData->physicsObjects[objectIndices[x]].rigidBody.isActive()) return false;
+			}
+			return true;
+		}
+	};
+}
+
+#endif
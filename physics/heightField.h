@@ -30,6 +30,7 @@
 
 #include"../geometry/triangle.h"
 #include"../geometry/aabb.h"
+#include"../geometry/rayPacket.h"
 #include"../containers/hybridArray.h"
 
 namespace mech {
@@ -53,6 +54,10 @@ namespace mech {
 		TriangleDiagonalMode::twoTothree - diagonal connects point 2 to point 2
 	*/
 
+#define HEIGHT_PYRAMID_BLOCK 8
+#define HEIGHT_TILE_SIZE 32
+#define HEIGHT_PYRAMID_MAXIMUM_LEVELS 16
+
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	enum class TriangleDiagonalMode : byte { none = 0, oneToFour = 1 << 0, twoTothree = 1 << 1 };
 
@@ -67,17 +72,172 @@ namespace mech {
 	};
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/*
+		heights quantised to 16 bits with an offset and scale per tile of HEIGHT_TILE_SIZE x HEIGHT_TILE_SIZE samples.
+		with a maximumDeltaError above 0, a tile that can be quantised coarsely enough for neighbouring samples along a row to differ
+		by at most 127 steps without erring by more than maximumDeltaError keeps the first sample of every row followed by 8 bit deltas,
+		a sample then costs the sum of the deltas in front of it in its row
+	*/
+	struct QuantisedHeights {
+
+		struct Tile {
+			float offset = 0.0;
+			float scale = 0.0;
+			uint32 dataOffset = 0; //in bytes
+			bool deltaEncoded = false;
+		};
+
+		DynamicArray<Tile, uint32> tiles;
+		DynamicArray<byte, uint32> data;
+		uint32 numOfPoints = 0; //along x and z
+		uint32 tilesAlongXandZ = 0;
+
+		void create(const float* heights, const uint32& numberOfPoints, const float& maximumDeltaError = 0.0)
+		{
+			this->tiles.clear();
+			this->data.clear();
+			this->numOfPoints = numberOfPoints;
+			this->tilesAlongXandZ = (numberOfPoints + HEIGHT_TILE_SIZE - 1) / HEIGHT_TILE_SIZE;
+
+			for (uint32 tz = 0; tz < this->tilesAlongXandZ; ++tz) {
+				for (uint32 tx = 0; tx < this->tilesAlongXandZ; ++tx) {
+
+					uint32 width = 0, height = 0;
+					this->getTileSize(tx, tz, width, height);
+					const float* first = heights + tz * HEIGHT_TILE_SIZE * numberOfPoints + tx * HEIGHT_TILE_SIZE;
+
+					float min = FLT_MAX;
+					float max = -FLT_MAX;
+					float largestStep = 0.0;
+					for (uint32 z = 0; z < height; ++z) {
+						for (uint32 x = 0; x < width; ++x) {
+							float h = first[z * numberOfPoints + x];
+							min = h < min ? h : min;
+							max = h > max ? h : max;
+							if (x > 0) {
+								largestStep = mathMAX(largestStep, mathABS(h - first[z * numberOfPoints + x - 1]));
+							}
+						}
+					}
+
+					Tile tile;
+					tile.offset = min;
+					tile.dataOffset = this->data.size();
+
+					//126 rather than 127 steps leaves room for rounding
+					float fineScale = (max - min) / float(65535.0);
+					float deltaScale = mathMAX(fineScale, largestStep / float(126.0));
+					tile.deltaEncoded = maximumDeltaError > float(0.0) && deltaScale * float(0.5) <= maximumDeltaError;
+					tile.scale = tile.deltaEncoded ? deltaScale : fineScale;
+
+					for (uint32 z = 0; z < height; ++z) {
+						uint16 previous = 0;
+						for (uint32 x = 0; x < width; ++x) {
+							float h = first[z * numberOfPoints + x];
+							uint16 value = tile.scale > float(0.0) ? (uint16)mathMIN((h - min) / tile.scale + float(0.5), float(65535.0)) : 0;
+
+							if (tile.deltaEncoded && x > 0) {
+								int32 delta = (int32)value - (int32)previous;
+								ASSERT(delta >= -128 && delta <= 127, "delta does not fit in 8 bits");
+								this->data.pushBack((byte)(signed char)delta);
+							}
+							else {
+								this->data.pushBack((byte)(value & 0xFF));
+								this->data.pushBack((byte)(value >> 8));
+							}
+							previous = value;
+						}
+					}
+
+					this->tiles.pushBack(tile);
+				}
+			}
+		}
+
+		float getHeight(const uint32& x, const uint32& z) const
+		{
+			uint32 tx = x / HEIGHT_TILE_SIZE;
+			uint32 tz = z / HEIGHT_TILE_SIZE;
+			uint32 lx = x - tx * HEIGHT_TILE_SIZE;
+			uint32 lz = z - tz * HEIGHT_TILE_SIZE;
+
+			const Tile& tile = this->tiles[tz * this->tilesAlongXandZ + tx];
+
+			uint32 width = 0, height = 0;
+			this->getTileSize(tx, tz, width, height);
+
+			int32 value = 0;
+			if (tile.deltaEncoded) {
+				//a row is its first sample in 16 bits followed by width - 1 deltas
+				const byte* row = this->data.data() + tile.dataOffset + lz * (width + 1);
+				value = row[0] | (row[1] << 8);
+				for (uint32 i = 1; i <= lx; ++i) {
+					value += (signed char)row[i + 1];
+				}
+			}
+			else {
+				const byte* sample = this->data.data() + tile.dataOffset + (lz * width + lx) * 2;
+				value = sample[0] | (sample[1] << 8);
+			}
+
+			return tile.offset + value * tile.scale;
+		}
+
+		void getTileSize(const uint32& tx, const uint32& tz, uint32& width, uint32& height) const
+		{
+			width = this->numOfPoints - tx * HEIGHT_TILE_SIZE;
+			height = this->numOfPoints - tz * HEIGHT_TILE_SIZE;
+			width = width < HEIGHT_TILE_SIZE ? width : HEIGHT_TILE_SIZE;
+			height = height < HEIGHT_TILE_SIZE ? height : HEIGHT_TILE_SIZE;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/*
+		heights come from quantisedHeights when it is set and from heightData otherwise.
+		cellFlags is optional and holds one byte per cell, numOfCellsAlongXandZ - 1 cells along each side
+		--------------cell flags----------------
+		cell is a hole                    - 0b00000001
+		diagonal connects point 2 to 3    - 0b00000010 (point 1 to 4 otherwise, overrides diagonalMode)
+	*/
 	struct BumpyTerrainParameters {
 		float* heightData = nullptr;
+		QuantisedHeights* quantisedHeights = nullptr;
+		byte* cellFlags = nullptr;
 		float gridSize = 0.0;
 		float drift = 0.0;
-		uint16 numOfCellsAlongXandZ = 0;
+		float originX = 0.0; //added to drift along x, places a tile of a larger terrain
+		float originZ = 0.0; //added to drift along z
+		uint16 numOfCellsAlongXandZ = 0; //height values along a row
 		TriangleDiagonalMode diagonalMode = TriangleDiagonalMode::none;
 	};
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct HeightField {
 
+		struct HeightRange {
+			float min = FLT_MAX;
+			float max = -FLT_MAX;
+
+			void grow(const HeightRange& other)
+			{
+				this->min = other.min < this->min ? other.min : this->min;
+				this->max = other.max > this->max ? other.max : this->max;
+			}
+
+			bool overlaps(const AABB& aabb) const { return this->min <= aabb.max.y && this->max >= aabb.min.y; }
+		};
+
+		/*
+			quadtree of height ranges over blocks of cells, level 0 holds blocks of HEIGHT_PYRAMID_BLOCK x HEIGHT_PYRAMID_BLOCK cells,
+			every level above it halves the blocks along x and z until one block covers the whole heightField.
+			cells inside a level 0 block are tested from their own heights
+		*/
+		DynamicArray<HeightRange, uint32> pyramid;
+		uint32 levelOffsets[HEIGHT_PYRAMID_MAXIMUM_LEVELS] = {};
+		uint32 levelSizes[HEIGHT_PYRAMID_MAXIMUM_LEVELS] = {}; //blocks along x and z
+		byte numOfLevels = 0;
+
 		BumpyTerrainParameters* bumpy = nullptr;
 		FlatTerrainParameters* flat = nullptr;
 		HeightFieldType heightFieldType = HeightFieldType::none;
@@ -86,6 +246,7 @@ namespace mech {
 		{
 			this->bumpy = params;
 			this->heightFieldType = HeightFieldType::bumpy;
+			this->buildPyramid();
 		}
 
 		void initialise(FlatTerrainParameters* params)
@@ -104,51 +265,156 @@ namespace mech {
 			Vec3 points[2] = { aabb.min, aabb.max };
 			for (byte i = 0; i < 2; ++i) {
 
-				float gridX = (points[i].x - this->bumpy->drift) / this->bumpy->gridSize;
+				float gridX = (points[i].x - this->getOriginX()) / this->bumpy->gridSize;
 				minX = gridX < minX ? gridX : minX;
 				maxX = gridX > maxX ? gridX : maxX;
 
-				float gridZ = (points[i].z - this->bumpy->drift) / this->bumpy->gridSize;
+				float gridZ = (points[i].z - this->getOriginZ()) / this->bumpy->gridSize;
 				minZ = gridZ < minZ ? gridZ : minZ;
 				maxZ = gridZ > maxZ ? gridZ : maxZ;
 			}
 
 			minX = mathMAX(minX, 0.0);
 			minZ = mathMAX(minZ, 0.0);
-			maxX = mathMIN(maxX, this->bumpy->numOfCellsAlongXandZ - 1);
-			maxZ = mathMIN(maxZ, this->bumpy->numOfCellsAlongXandZ - 1);
+			maxX = mathMIN(maxX, this->getNumOfCells() - 1);
+			maxZ = mathMIN(maxZ, this->getNumOfCells() - 1);
 		}
 
-		bool intersects(const AABB& aabb) const
+		//numOfCellsAlongXandZ is the number of height values along a row, the cells sit between them
+		uint32 getNumOfCells() const { return this->bumpy->numOfCellsAlongXandZ - 1; }
+
+		float getOriginX() const { return this->bumpy->drift + this->bumpy->originX; }
+		float getOriginZ() const { return this->bumpy->drift + this->bumpy->originZ; }
+
+		float getSample(const uint32& x, const uint32& z) const
 		{
-			if (this->heightFieldType == HeightFieldType::bumpy) {
-				
-				float minX, maxX, minZ, maxZ;
-				gridIndicies(aabb, minX, maxX, minZ, maxZ);
-				if (maxX < 0) return false;
+			if (this->bumpy->quantisedHeights != nullptr) {
+				return this->bumpy->quantisedHeights->getHeight(x, z);
+			}
+			return this->bumpy->heightData[z * this->bumpy->numOfCellsAlongXandZ + x];
+		}
 
-				float maxHeight = -FLT_MAX;
-				float minHeight = FLT_MAX;
+		bool isHole(const uint32& x, const uint32& z) const
+		{
+			return this->bumpy->cellFlags != nullptr && (this->bumpy->cellFlags[z * this->getNumOfCells() + x] & 1) != 0;
+		}
 
-				for (uint32 z = minZ; z <= maxZ; ++z) {
-					for (uint32 x = minX; x <= maxX; ++x) {
+		TriangleDiagonalMode getDiagonalMode(const uint32& x, const uint32& z) const
+		{
+			if (this->bumpy->cellFlags == nullptr) return this->bumpy->diagonalMode;
+			return (this->bumpy->cellFlags[z * this->getNumOfCells() + x] & 2) != 0 ? TriangleDiagonalMode::twoTothree : TriangleDiagonalMode::oneToFour;
+		}
 
-						float h[4];
-						h[0] = this->bumpy->heightData[(z * this->bumpy->numOfCellsAlongXandZ) + x];
-						h[1] = this->bumpy->heightData[((z + 1) * this->bumpy->numOfCellsAlongXandZ) + x];
-						h[2] = this->bumpy->heightData[(z * this->bumpy->numOfCellsAlongXandZ) + (x + 1)];
-						h[3] = this->bumpy->heightData[((z + 1) * this->bumpy->numOfCellsAlongXandZ) + (x + 1)];
+		HeightRange getCellRange(const uint32& x, const uint32& z) const
+		{
+			float h[4] = { this->getSample(x, z), this->getSample(x + 1, z), this->getSample(x, z + 1), this->getSample(x + 1, z + 1) };
+
+			HeightRange range;
+			range.min = mathMIN(mathMIN(h[0], h[1]), mathMIN(h[2], h[3]));
+			range.max = mathMAX(mathMAX(h[0], h[1]), mathMAX(h[2], h[3]));
+			return range;
+		}
 
-						for (byte i = 0; i < 4; ++i) {
-							maxHeight = mathMAX(h[i], maxHeight);
-							minHeight = mathMIN(h[i], minHeight);
+		void buildPyramid()
+		{
+			this->pyramid.clear();
+			this->numOfLevels = 0;
+
+			uint32 numOfCells = this->getNumOfCells();
+			uint32 size = (numOfCells + HEIGHT_PYRAMID_BLOCK - 1) / HEIGHT_PYRAMID_BLOCK;
+
+			while (true) {
+
+				ASSERT(this->numOfLevels < HEIGHT_PYRAMID_MAXIMUM_LEVELS, "heightField is too large");
+
+				byte level = this->numOfLevels++;
+				this->levelOffsets[level] = this->pyramid.size();
+				this->levelSizes[level] = size;
+
+				for (uint32 bz = 0; bz < size; ++bz) {
+					for (uint32 bx = 0; bx < size; ++bx) {
+
+						HeightRange range;
+						if (level == 0) {
+							for (uint32 z = bz * HEIGHT_PYRAMID_BLOCK, endZ = mathMIN(z + HEIGHT_PYRAMID_BLOCK, numOfCells); z < endZ; ++z) {
+								for (uint32 x = bx * HEIGHT_PYRAMID_BLOCK, endX = mathMIN(x + HEIGHT_PYRAMID_BLOCK, numOfCells); x < endX; ++x) {
+									if (this->isHole(x, z) == false) {
+										range.grow(this->getCellRange(x, z));
+									}
+								}
+							}
 						}
+						else {
+							uint32 childSize = this->levelSizes[level - 1];
+							for (uint32 z = bz * 2, endZ = mathMIN(z + 2, childSize); z < endZ; ++z) {
+								for (uint32 x = bx * 2, endX = mathMIN(x + 2, childSize); x < endX; ++x) {
+									range.grow(this->pyramid[this->levelOffsets[level - 1] + z * childSize + x]);
+								}
+							}
+						}
+
+						this->pyramid.pushBack(range);
+					}
+				}
+
+				if (size <= 1) break;
+				size = (size + 1) / 2;
+			}
+		}
+
+		//cellVisitor.visitCell(x, z) is called for every cell whose heights overlap the aabb and returns false to end the query
+		template<typename CellVisitor>
+		void forEachCellOverlapped(const AABB& aabb, CellVisitor& cellVisitor) const
+		{
+			float minX, maxX, minZ, maxZ;
+			gridIndicies(aabb, minX, maxX, minZ, maxZ);
+			if (maxX < 0 || maxZ < 0 || minX > maxX || minZ > maxZ || this->numOfLevels == 0) return;
+
+			uint32 cells[4] = { (uint32)minX, (uint32)maxX, (uint32)minZ, (uint32)maxZ };
+			this->visitBlock(this->numOfLevels - 1, 0, 0, cells, aabb, cellVisitor);
+		}
+
+		template<typename CellVisitor>
+		bool visitBlock(const byte& level, const uint32& bx, const uint32& bz, const uint32* cells, const AABB& aabb, CellVisitor& cellVisitor) const
+		{
+			uint32 span = HEIGHT_PYRAMID_BLOCK << level;
+			uint32 firstX = bx * span;
+			uint32 firstZ = bz * span;
+			if (firstX > cells[1] || firstX + span - 1 < cells[0] || firstZ > cells[3] || firstZ + span - 1 < cells[2]) return true;
+
+			if (this->pyramid[this->levelOffsets[level] + bz * this->levelSizes[level] + bx].overlaps(aabb) == false) return true;
+
+			if (level == 0) {
+				for (uint32 z = mathMAX(firstZ, cells[2]), endZ = mathMIN(firstZ + span - 1, cells[3]); z <= endZ; ++z) {
+					for (uint32 x = mathMAX(firstX, cells[0]), endX = mathMIN(firstX + span - 1, cells[1]); x <= endX; ++x) {
+						if (this->isHole(x, z) == false && this->getCellRange(x, z).overlaps(aabb) && cellVisitor.visitCell(x, z) == false) return false;
 					}
 				}
+				return true;
+			}
 
-				return (aabb.min.y <= maxHeight && aabb.min.y >= minHeight) ||
-					(aabb.max.y <= maxHeight && aabb.max.y >= minHeight) ||
-					(aabb.max.y >= maxHeight && aabb.min.y <= minHeight);
+			uint32 childSize = this->levelSizes[level - 1];
+			for (uint32 z = bz * 2, endZ = mathMIN(z + 2, childSize); z < endZ; ++z) {
+				for (uint32 x = bx * 2, endX = mathMIN(x + 2, childSize); x < endX; ++x) {
+					if (this->visitBlock(level - 1, x, z, cells, aabb, cellVisitor) == false) return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool intersects(const AABB& aabb) const
+		{
+			if (this->heightFieldType == HeightFieldType::bumpy) {
+
+				struct CellFinder {
+					bool found = false;
+					bool visitCell(const uint32& /*x*/, const uint32& /*z*/) { this->found = true; return false; }
+				};
+
+				CellFinder finder;
+				this->forEachCellOverlapped(aabb, finder);
+				return finder.found;
 			}
 			else if (this->heightFieldType == HeightFieldType::flat) {
 
@@ -161,103 +427,322 @@ namespace mech {
 			return false;
 		}
 
-		void getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles) const
+		void getCellTriangles(const uint32& x, const uint32& z, Triangle* t) const
+		{
+			float zCord1 = z * this->bumpy->gridSize + this->getOriginZ();
+			float zCord2 = zCord1 + this->bumpy->gridSize;
+			float xCord1 = x * this->bumpy->gridSize + this->getOriginX();
+			float xCord2 = xCord1 + this->bumpy->gridSize;
+
+			Vec3 a1 = Vec3(xCord1, this->getSample(x, z), zCord1);
+			Vec3 a2 = Vec3(xCord1, this->getSample(x, z + 1), zCord2);
+			Vec3 a3 = Vec3(xCord2, this->getSample(x + 1, z), zCord1);
+			Vec3 a4 = Vec3(xCord2, this->getSample(x + 1, z + 1), zCord2);
+
+			if (this->getDiagonalMode(x, z) == TriangleDiagonalMode::oneToFour) {
+				t[0] = Triangle(a1, a2, a4);
+				t[1] = Triangle(a4, a3, a1);
+			}
+			else {
+				t[0] = Triangle(a1, a2, a3);
+				t[1] = Triangle(a3, a2, a4);
+			}
+		}
+
+		void getFlatTriangles(Triangle* t) const
+		{
+			t[0] = Triangle(Vec3(this->flat->min.x, this->flat->height, this->flat->min.y), Vec3(this->flat->min.x, this->flat->height, this->flat->max.y), Vec3(this->flat->max.x, this->flat->height, this->flat->max.y));
+			t[1] = Triangle(Vec3(this->flat->min.x, this->flat->height, this->flat->min.y), Vec3(this->flat->max.x, this->flat->height, this->flat->max.y), Vec3(this->flat->max.x, this->flat->height, this->flat->min.y));
+		}
+
+		//builds the triangles of the cells a query reaches
+		template<typename Visitor>
+		struct TriangleBuilder {
+			const HeightField* heightField;
+			const AABB& aabb;
+			Visitor& visitor;
+
+			bool visitCell(const uint32& x, const uint32& z)
+			{
+				Triangle t[2];
+				this->heightField->getCellTriangles(x, z, t);
+
+				for (byte i = 0; i < 2; ++i) {
+					if (this->aabb.intersects(t[i]) && this->visitor.visit(t[i]) == false) return false;
+				}
+
+				return true;
+			}
+		};
+
+		//visitor.visit(triangle) is called for every triangle that overlaps the aabb and returns false to end the query
+		template<typename Visitor>
+		void forEachTriangleOverlapped(const AABB& aabb, Visitor& visitor) const
 		{
 			if (this->heightFieldType == HeightFieldType::bumpy) {
+				TriangleBuilder<Visitor> builder = { this, aabb, visitor };
+				this->forEachCellOverlapped(aabb, builder);
+			}
+			else if (this->heightFieldType == HeightFieldType::flat) {
 
-				float minX, maxX, minZ, maxZ;
-				gridIndicies(aabb, minX, maxX, minZ, maxZ);
-				if (maxX < 0) return;
+				Triangle t[2];
+				this->getFlatTriangles(t);
+				for (byte i = 0; i < 2; ++i) {
+					if (aabb.intersects(t[i]) && visitor.visit(t[i]) == false) return;
+				}
+			}
+			else {
+				ASSERT(false, "heightFeild was not initialised");
+			}
+		}
 
-				for (uint32 z = minZ; z <= maxZ; ++z) {
+		void getTrianglesOverlapped(const AABB& aabb, HybridArray<Triangle, 24, uint16>& triangles) const
+		{
+			TriangleCollector collector = { triangles };
+			this->forEachTriangleOverlapped(aabb, collector);
+		}
 
-					float zCord1 = z * this->bumpy->gridSize + this->bumpy->drift;
-					float zCord2 = zCord1 + this->bumpy->gridSize;
+		/*
+			nearest triangle the ray hits before maxT, returns -1 on a miss.
+			the ray is clipped to the bound of the whole field and walks the cells it crosses in order, so the first cell with a hit holds the nearest one
+		*/
+		decimal rayCastTime(const Ray& ray, const decimal& maxT, Triangle& triangleHit) const
+		{
+			if (this->heightFieldType == HeightFieldType::flat) {
 
-					for (uint32 x = minX; x <= maxX; ++x) {
+				Triangle t[2];
+				this->getFlatTriangles(t);
 
-						float xCord1 = x * this->bumpy->gridSize + this->bumpy->drift;
-						float xCord2 = xCord1 + this->bumpy->gridSize;
+				decimal best = decimal(-1.0);
+				for (byte i = 0; i < 2; ++i) {
+					decimal time = ray.rayCastTime(t[i]);
+					if (time >= decimal(0.0) && time <= maxT && (best < decimal(0.0) || time < best)) {
+						best = time;
+						triangleHit = t[i];
+					}
+				}
+				return best;
+			}
 
-						Vec3 a1 = Vec3(xCord1, this->bumpy->heightData[(z * this->bumpy->numOfCellsAlongXandZ) + x], zCord1);
-						Vec3 a2 = Vec3(xCord1, this->bumpy->heightData[((z + 1) * this->bumpy->numOfCellsAlongXandZ) + x], zCord2);
-						Vec3 a3 = Vec3(xCord2, this->bumpy->heightData[(z * this->bumpy->numOfCellsAlongXandZ) + (x + 1)], zCord1);
-						Vec3 a4 = Vec3(xCord2, this->bumpy->heightData[((z + 1) * this->bumpy->numOfCellsAlongXandZ) + (x + 1)], zCord2);
+			ASSERT(this->heightFieldType == HeightFieldType::bumpy, "heightFeild was not initialised");
+			if (this->numOfLevels == 0) return decimal(-1.0);
 
-						Triangle t[2];
-						if (this->bumpy->diagonalMode == TriangleDiagonalMode::oneToFour) {
-							t[0] = Triangle(a1, a2, a4);
-							t[1] = Triangle(a4, a3, a1);
-						}
-						else {
-							t[0] = Triangle(a1, a2, a3);
-							t[1] = Triangle(a3, a2, a4);
-						}
+			uint32 numOfCells = this->getNumOfCells();
+			decimal gridSize = this->bumpy->gridSize;
+			decimal originX = this->getOriginX();
+			decimal originZ = this->getOriginZ();
+			const HeightRange& range = this->pyramid.back();
 
+			Vec3 inverseDirection = getInverseDirection(ray);
+			decimal t = rayEntryTime(ray.origin, inverseDirection, Vec3(originX, range.min, originZ), Vec3(originX + numOfCells * gridSize, range.max, originZ + numOfCells * gridSize), maxT);
+			if (t < decimal(0.0)) return decimal(-1.0);
+
+			Vec3 entry = ray.origin + ray.direction * t;
+			int32 x = (int32)mathMIN(mathMAX((entry.x - originX) / gridSize, decimal(0.0)), decimal(numOfCells - 1));
+			int32 z = (int32)mathMIN(mathMAX((entry.z - originZ) / gridSize, decimal(0.0)), decimal(numOfCells - 1));
+
+			int32 stepX = ray.direction.x > decimal(0.0) ? 1 : -1;
+			int32 stepZ = ray.direction.z > decimal(0.0) ? 1 : -1;
+			decimal deltaX = mathABS(gridSize * inverseDirection.x);
+			decimal deltaZ = mathABS(gridSize * inverseDirection.z);
+			decimal nextX = ray.direction.x == decimal(0.0) ? decimalMAX : (originX + (x + (stepX > 0 ? 1 : 0)) * gridSize - ray.origin.x) * inverseDirection.x;
+			decimal nextZ = ray.direction.z == decimal(0.0) ? decimalMAX : (originZ + (z + (stepZ > 0 ? 1 : 0)) * gridSize - ray.origin.z) * inverseDirection.z;
+
+			while (t <= maxT) {
+
+				decimal exit = mathMIN(mathMIN(nextX, nextZ), maxT);
+
+				if (this->isHole(x, z) == false) {
+
+					//heights the ray spans inside the cell against the heights of the cell
+					decimal y1 = ray.origin.y + ray.direction.y * t;
+					decimal y2 = ray.origin.y + ray.direction.y * exit;
+					HeightRange cellRange = this->getCellRange(x, z);
+
+					if (mathMIN(y1, y2) <= cellRange.max && mathMAX(y1, y2) >= cellRange.min) {
+
+						Triangle triangles[2];
+						this->getCellTriangles(x, z, triangles);
+
+						decimal best = decimal(-1.0);
 						for (byte i = 0; i < 2; ++i) {
-							if (aabb.intersects(t[i])) {
-								triangles.pushBack(t[i]);
+							decimal time = ray.rayCastTime(triangles[i]);
+							if (time >= decimal(0.0) && time <= maxT && (best < decimal(0.0) || time < best)) {
+								best = time;
+								triangleHit = triangles[i];
 							}
 						}
+						if (best >= decimal(0.0)) return best;
 					}
 				}
+
+				if (nextX < nextZ) {
+					x += stepX;
+					t = nextX;
+					nextX += deltaX;
+				}
+				else {
+					z += stepZ;
+					t = nextZ;
+					nextZ += deltaZ;
+				}
+
+				if (x < 0 || z < 0 || x >= (int32)numOfCells || z >= (int32)numOfCells) break;
 			}
-			else if (this->heightFieldType == HeightFieldType::flat) {
 
-				Triangle t[2] = {Triangle(Vec3(this->flat->min.x, this->flat->height, this->flat->min.y), Vec3(this->flat->min.x, this->flat->height, this->flat->max.y), Vec3(this->flat->max.x, this->flat->height, this->flat->max.y)), Triangle(Vec3(this->flat->min.x, this->flat->height, this->flat->min.y), Vec3(this->flat->max.x, this->flat->height, this->flat->max.y), Vec3(this->flat->max.x, this->flat->height, this->flat->min.y))};
+			return decimal(-1.0);
+		}
+
+		/*
+			packet version of rayCastTime, maxT holds the furthest distance of each lane and is lowered to its hits. returns the lanes that hit.
+			the pyramid is walked with the whole packet, blocks and cells are tested against every lane still reaching them
+		*/
+		int32 rayCastPacket(const RayPacket& packet, float* maxT, Triangle* trianglesHit) const
+		{
+			if (this->heightFieldType == HeightFieldType::flat) {
+
+				Triangle t[2];
+				this->getFlatTriangles(t);
+
+				int32 hitMask = 0;
 				for (byte i = 0; i < 2; ++i) {
-					if (aabb.intersects(t[i])) {
-						triangles.pushBack(t[i]);
+					hitMask |= this->rayCastPacket(packet, t[i], packet.activeMask, maxT, trianglesHit);
+				}
+				return hitMask;
+			}
+
+			ASSERT(this->heightFieldType == HeightFieldType::bumpy, "heightFeild was not initialised");
+			if (this->numOfLevels == 0) return 0;
+
+			return this->rayCastPacketBlock(this->numOfLevels - 1, 0, 0, packet, packet.activeMask, maxT, trianglesHit);
+		}
+
+		int32 rayCastPacketBlock(const byte& level, const uint32& bx, const uint32& bz, const RayPacket& packet, int32 lanes, float* maxT, Triangle* trianglesHit) const
+		{
+			uint32 numOfCells = this->getNumOfCells();
+			uint32 span = HEIGHT_PYRAMID_BLOCK << level;
+			uint32 firstX = bx * span;
+			uint32 firstZ = bz * span;
+			uint32 endX = mathMIN(firstX + span, numOfCells);
+			uint32 endZ = mathMIN(firstZ + span, numOfCells);
+			float gridSize = this->bumpy->gridSize;
+			float originX = this->getOriginX();
+			float originZ = this->getOriginZ();
+
+			const HeightRange& range = this->pyramid[this->levelOffsets[level] + bz * this->levelSizes[level] + bx];
+
+			Float4 entry;
+			lanes &= packet.entryTimes(Vec3f(originX + firstX * gridSize, range.min, originZ + firstZ * gridSize), Vec3f(originX + endX * gridSize, range.max, originZ + endZ * gridSize), Float4::load(maxT), entry);
+			if (lanes == 0) return 0;
+
+			//the first lane reaching the block picks the order cells and children are visited in, nearer ones first
+			byte lead = 0;
+			while ((lanes & (1 << lead)) == 0) ++lead;
+			bool backwardsX = packet.rays[lead].direction.x < decimal(0.0);
+			bool backwardsZ = packet.rays[lead].direction.z < decimal(0.0);
+
+			int32 hitMask = 0;
+
+			if (level == 0) {
+				for (uint32 i = 0, countZ = endZ - firstZ; i < countZ; ++i) {
+					for (uint32 j = 0, countX = endX - firstX; j < countX; ++j) {
+
+						uint32 x = backwardsX ? endX - 1 - j : firstX + j;
+						uint32 z = backwardsZ ? endZ - 1 - i : firstZ + i;
+						if (this->isHole(x, z)) continue;
+
+						HeightRange cellRange = this->getCellRange(x, z);
+						int32 cellLanes = packet.entryTimes(Vec3f(originX + x * gridSize, cellRange.min, originZ + z * gridSize), Vec3f(originX + (x + 1) * gridSize, cellRange.max, originZ + (z + 1) * gridSize), Float4::load(maxT), entry) & lanes;
+						if (cellLanes == 0) continue;
+
+						Triangle t[2];
+						this->getCellTriangles(x, z, t);
+						for (byte k = 0; k < 2; ++k) {
+							hitMask |= this->rayCastPacket(packet, t[k], cellLanes, maxT, trianglesHit);
+						}
 					}
 				}
+				return hitMask;
 			}
 
-			ASSERT(false, "heightFeild was not initialised");
+			uint32 childSize = this->levelSizes[level - 1];
+			for (uint32 i = 0; i < 2; ++i) {
+				for (uint32 j = 0; j < 2; ++j) {
+
+					uint32 x = bx * 2 + (backwardsX ? 1 - j : j);
+					uint32 z = bz * 2 + (backwardsZ ? 1 - i : i);
+					if (x >= childSize || z >= childSize) continue;
+
+					hitMask |= this->rayCastPacketBlock(level - 1, x, z, packet, lanes, maxT, trianglesHit);
+				}
+			}
+
+			return hitMask;
+		}
+
+		//tests the lanes against one triangle and keeps it for the lanes it is the nearest hit of
+		static int32 rayCastPacket(const RayPacket& packet, const Triangle& triangle, const int32& lanes, float* maxT, Triangle* trianglesHit)
+		{
+			Float4 times;
+			int32 hits = packet.rayCastTimes(triangle, Float4::load(maxT), times) & lanes;
+			if (hits == 0) return 0;
+
+			float laneTimes[RAY_PACKET_SIZE];
+			times.store(laneTimes);
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+				if ((hits & (1 << lane)) != 0) {
+					maxT[lane] = laneTimes[lane];
+					trianglesHit[lane] = triangle;
+				}
+			}
+			return hits;
 		}
 
 		float getHeight(const float& x, const float& z) const
 		{
 			if (this->heightFieldType == HeightFieldType::bumpy) {
 				
-				float heightFieldX = x - this->bumpy->drift;
-				float heightFieldZ = z - this->bumpy->drift;
+				float heightFieldX = x - this->getOriginX();
+				float heightFieldZ = z - this->getOriginZ();
 
 				int32 gridX = int(heightFieldX / this->bumpy->gridSize);
 				int32 gridZ = int(heightFieldZ / this->bumpy->gridSize);
 
-				if (gridX < 0 || gridX > this->bumpy->numOfCellsAlongXandZ || gridZ < 0 || gridZ > this->bumpy->numOfCellsAlongXandZ) return decimalNAN;
+				int32 numOfCells = this->getNumOfCells();
+				if (gridX < 0 || gridX > numOfCells || gridZ < 0 || gridZ > numOfCells) return decimalNAN;
 
-				gridX = gridX == this->bumpy->numOfCellsAlongXandZ ? gridX - 1 : gridX;
-				gridZ = gridZ == this->bumpy->numOfCellsAlongXandZ ? gridZ - 1 : gridZ;
+				gridX = gridX == numOfCells ? gridX - 1 : gridX;
+				gridZ = gridZ == numOfCells ? gridZ - 1 : gridZ;
+				if (this->isHole(gridX, gridZ)) return decimalNAN;
 
 				float xpos = heightFieldX - gridX * this->bumpy->gridSize;
 				float zpos = heightFieldZ - gridZ * this->bumpy->gridSize;
 
 				Vec3 p1, p2, p3;
-				if (this->bumpy->diagonalMode == TriangleDiagonalMode::oneToFour) {
+				if (this->getDiagonalMode(gridX, gridZ) == TriangleDiagonalMode::oneToFour) {
 
 					if (xpos / this->bumpy->gridSize >= (1 - zpos / this->bumpy->gridSize)) {
-						p1 = Vec3(float(0.0), this->bumpy->heightData[(gridZ * this->bumpy->numOfCellsAlongXandZ) + gridX], float(0.0));
-						p2 = Vec3(float(0.0), this->bumpy->heightData[(gridZ * this->bumpy->numOfCellsAlongXandZ) + (gridX + 1)], this->bumpy->gridSize);
-						p3 = Vec3(this->bumpy->gridSize, this->bumpy->heightData[((gridZ + 1) * this->bumpy->numOfCellsAlongXandZ) + (gridX + 1)], this->bumpy->gridSize);
+						p1 = Vec3(float(0.0), this->getSample(gridX, gridZ), float(0.0));
+						p2 = Vec3(float(0.0), this->getSample(gridX + 1, gridZ), this->bumpy->gridSize);
+						p3 = Vec3(this->bumpy->gridSize, this->getSample(gridX + 1, gridZ + 1), this->bumpy->gridSize);
 					}
 					else {
-						p1 = Vec3(float(0.0), this->bumpy->heightData[(gridZ * this->bumpy->numOfCellsAlongXandZ) + gridX], float(0.0));
-						p2 = Vec3(this->bumpy->gridSize, this->bumpy->heightData[((gridZ + 1) * this->bumpy->numOfCellsAlongXandZ) + (gridX + 1)], this->bumpy->gridSize);
-						p3 = Vec3(this->bumpy->gridSize, this->bumpy->heightData[((gridZ + 1) * this->bumpy->numOfCellsAlongXandZ) + gridX], float(0.0));
+						p1 = Vec3(float(0.0), this->getSample(gridX, gridZ), float(0.0));
+						p2 = Vec3(this->bumpy->gridSize, this->getSample(gridX + 1, gridZ + 1), this->bumpy->gridSize);
+						p3 = Vec3(this->bumpy->gridSize, this->getSample(gridX, gridZ + 1), float(0.0));
 					}
 				}
 				else {
 
 					if (xpos / this->bumpy->gridSize <= (1 - zpos / this->bumpy->gridSize)) {
-						p1 = Vec3(float(0.0), this->bumpy->heightData[(gridZ * this->bumpy->numOfCellsAlongXandZ) + gridX], float(0.0));
-						p2 = Vec3(float(0.0), this->bumpy->heightData[(gridZ * this->bumpy->numOfCellsAlongXandZ) + (gridX + 1)], this->bumpy->gridSize);
-						p3 = Vec3(this->bumpy->gridSize, this->bumpy->heightData[((gridZ + 1) * this->bumpy->numOfCellsAlongXandZ) + gridX], float(0.0));
+						p1 = Vec3(float(0.0), this->getSample(gridX, gridZ), float(0.0));
+						p2 = Vec3(float(0.0), this->getSample(gridX + 1, gridZ), this->bumpy->gridSize);
+						p3 = Vec3(this->bumpy->gridSize, this->getSample(gridX, gridZ + 1), float(0.0));
 					}
 					else {
-						p1 = Vec3(this->bumpy->gridSize, this->bumpy->heightData[((gridZ + 1) * this->bumpy->numOfCellsAlongXandZ) + gridX], float(0.0));
-						p2 = Vec3(float(0.0), this->bumpy->heightData[(gridZ * this->bumpy->numOfCellsAlongXandZ) + (gridX + 1)], this->bumpy->gridSize);
-						p3 = Vec3(this->bumpy->gridSize, this->bumpy->heightData[((gridZ + 1) * this->bumpy->numOfCellsAlongXandZ) + (gridX + 1)], this->bumpy->gridSize);
+						p1 = Vec3(this->bumpy->gridSize, this->getSample(gridX, gridZ + 1), float(0.0));
+						p2 = Vec3(float(0.0), this->getSample(gridX + 1, gridZ), this->bumpy->gridSize);
+						p3 = Vec3(this->bumpy->gridSize, this->getSample(gridX + 1, gridZ + 1), this->bumpy->gridSize);
 					}
 				}
 
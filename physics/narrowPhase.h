@@ -31,9 +31,16 @@
 #include"physicsData.h"
 #include"../geometry/plane.h"
 #include"../geometry/algorithms/GJK.h"
+#include"../geometry/algorithms/EPA.h"
 
 namespace mech {
 
+	//ids of the single point added when clipping leaves no contacts, kept above the face, edge and vertex ids built with pairingFunction
+	constexpr uint32 HULLS_FALLBACK_CONTACT_ID = 0xFFFFFFFE;
+	constexpr uint32 CAPSULE_HULL_FALLBACK_CONTACT_ID = 0xFFFFFFFD;
+	//speculative points take their ids from the top 16th of the range, below the fallback ids
+	constexpr uint32 SPECULATIVE_CONTACT_ID_BASE = 0xF0000000;
+
 	struct NarrowPhase {
 
 		PhysicsData* physicsData = nullptr;
@@ -74,6 +81,8 @@ namespace mech {
 
 		void generateContacts(const Sphere& sphere, const ConvexHull& convexHull, ContactManifold& manifold)
 		{
+			if (convexHull.vertices.size() >= this->physicsData->settings.gjkVertexThreshold && this->generateContactsGJK(sphere, convexHull, manifold)) return;
+
 			BEGIN_PROFILE("NarrowPhase::SphereVsConvexHull");
 
 			Vec3 closest = convexHull.closestPoint(sphere.center);
@@ -115,28 +124,40 @@ namespace mech {
 			END_PROFILE;
 		}
 
-		void generateContacts(const Sphere& sphere, const HybridArray<Triangle, 24, uint16>& triangles, ContactManifold& manifold)
+		//triangles is a TriangleMeshCollider or HeightFieldCollider, the triangles overlapping aabb are streamed to the kernel
+		template<typename Triangles>
+		void generateContacts(const Sphere& sphere, const Triangles& triangles, const AABB& aabb, ContactManifold& manifold)
 		{
 			BEGIN_PROFILE("NarrowPhase::SphereVstriangles");
 
-			for (uint32 x = 0, len = triangles.size(); x < len; ++x) {
+			struct Kernel {
+				const Sphere& sphere;
+				ContactManifold& manifold;
 
-				if (manifold.numPoints == MAXIMUM_CONTACT_POINTS) break;
+				bool visit(const Triangle& triangle)
+				{
+					Vec3 closest = triangle.closestPoint(this->sphere.center);
 
-				Vec3 closest = triangles[x].closestPoint(sphere.center);
+					if (magnitudeSq(closest - this->sphere.center) < square(this->sphere.radius)) {
 
-				if (magnitudeSq(closest - sphere.center) < square(sphere.radius)) {
+						this->manifold.flag = CollisionFlag::PENETRATING;
 
-					manifold.flag = CollisionFlag::PENETRATING;
+						Vec3 n = normalise(closest - this->sphere.center);
+						if (triangle.toPlane().getDistanceFromPlane(this->sphere.center) < decimal(0.0)) {
+							n = -n;
+						}
+						this->manifold.addContact(n, this->sphere.center + n * this->sphere.radius, closest, 1);
 
-					Vec3 n = normalise(closest - sphere.center);
-					if (triangles[x].toPlane().getDistanceFromPlane(sphere.center) < decimal(0.0)) {
-						n = -n;
+						DEBUG_RENDERER_ADD(triangle, WHITE);
 					}
-					manifold.addContact(n, sphere.center + n * sphere.radius, closest, 1);
 
-					DEBUG_RENDERER_ADD(triangles[x], WHITE);
+					return this->manifold.numPoints < MAXIMUM_CONTACT_POINTS;
 				}
+			};
+
+			if (manifold.numPoints < MAXIMUM_CONTACT_POINTS) {
+				Kernel kernel = { sphere, manifold };
+				triangles.forEachTriangleOverlapped(aabb, kernel);
 			}
 
 			END_PROFILE;
@@ -183,6 +204,8 @@ namespace mech {
 
 		void generateContacts(const Capsule& capsule, const ConvexHull& convexHull, ContactManifold& manifold)
 		{
+			if (convexHull.vertices.size() >= this->physicsData->settings.gjkVertexThreshold && this->generateContactsGJK(capsule, convexHull, manifold)) return;
+
 			BEGIN_PROFILE("NarrowPhase::CapsuleVsConvexHull");
 
 			Vec3 closetOnHull = convexHull.closestPoint(capsule.capsuleLine);
@@ -295,46 +318,59 @@ namespace mech {
 			END_PROFILE;
 		}
 
-		void generateContacts(const Capsule& capsule, const HybridArray<Triangle, 24, uint16>& triangles, ContactManifold& manifold)
+		template<typename Triangles>
+		void generateContacts(const Capsule& capsule, const Triangles& triangles, const AABB& aabb, ContactManifold& manifold)
 		{
 			BEGIN_PROFILE("NarrowPhase::CapsuleVstriangles");
 
-			Vec3 dir = capsule.capsuleLine.getDirection();
-			for (uint32 x = 0, len = triangles.size(); x < len; ++x) {
+			struct Kernel {
+				const Capsule& capsule;
+				ContactManifold& manifold;
+				Vec3 dir;
+				uint32 x = 0; //triangles visited so far, keeps contact ids apart
 
-				if (manifold.numPoints == MAXIMUM_CONTACT_POINTS) break;
+				bool visit(const Triangle& triangle)
+				{
+					Vec3 closest2 = triangle.closestPoint(this->capsule.capsuleLine);
+					Vec3 closest1 = this->capsule.capsuleLine.closestPoint(closest2);
 
-				Vec3 closest2 = triangles[x].closestPoint(capsule.capsuleLine);
-				Vec3 closest1 = capsule.capsuleLine.closestPoint(closest2);
-				
-				if (magnitudeSq(closest2 - closest1) < square(capsule.radius)) {
+					if (magnitudeSq(closest2 - closest1) < square(this->capsule.radius)) {
 
-					Plane plane = triangles[x].toPlane();
+						Plane plane = triangle.toPlane();
 
-					if (almostEqual(dotProduct(dir, plane.normal), decimal(0.0))) {
+						if (almostEqual(dotProduct(this->dir, plane.normal), decimal(0.0))) {
 
-						Vec3 closest[2] = { plane.closestPoint(capsule.pointA), plane.closestPoint(capsule.pointB) };
-						for (byte y = 0; y < 2; ++y) {
+							Vec3 closest[2] = { plane.closestPoint(this->capsule.pointA), plane.closestPoint(this->capsule.pointB) };
+							for (byte y = 0; y < 2; ++y) {
 
-							if (manifold.numPoints == MAXIMUM_CONTACT_POINTS) break;
+								if (this->manifold.numPoints == MAXIMUM_CONTACT_POINTS) break;
 
-							if (triangles[x].contains(closest[y])) {
-								manifold.flag = CollisionFlag::PENETRATING;
-								manifold.addContact(-plane.normal, capsule.capsuleLine.closestPoint(closest[y]) + -plane.normal * capsule.radius, closest[y], pairingFunction(y, x));
+								if (triangle.contains(closest[y])) {
+									this->manifold.flag = CollisionFlag::PENETRATING;
+									this->manifold.addContact(-plane.normal, this->capsule.capsuleLine.closestPoint(closest[y]) + -plane.normal * this->capsule.radius, closest[y], pairingFunction(y, this->x));
 
-								DEBUG_RENDERER_ADD(triangles[x], WHITE);
+									DEBUG_RENDERER_ADD(triangle, WHITE);
+								}
 							}
 						}
-					}
-					else {
+						else {
 
-						manifold.flag = CollisionFlag::PENETRATING;
-						Vec3 n = normalise(closest2 - closest1);
-						manifold.addContact(n, closest1 + n * capsule.radius, closest2, pairingFunction(2, x));
+							this->manifold.flag = CollisionFlag::PENETRATING;
+							Vec3 n = normalise(closest2 - closest1);
+							this->manifold.addContact(n, closest1 + n * this->capsule.radius, closest2, pairingFunction(2, this->x));
 
-						DEBUG_RENDERER_ADD(triangles[x], WHITE);
+							DEBUG_RENDERER_ADD(triangle, WHITE);
+						}
 					}
+
+					++this->x;
+					return this->manifold.numPoints < MAXIMUM_CONTACT_POINTS;
 				}
+			};
+
+			if (manifold.numPoints < MAXIMUM_CONTACT_POINTS) {
+				Kernel kernel = { capsule, manifold, capsule.capsuleLine.getDirection() };
+				triangles.forEachTriangleOverlapped(aabb, kernel);
 			}
 
 			END_PROFILE;
@@ -369,6 +405,7 @@ namespace mech {
 				
 						if (d < mathEPSILON) {
 							c.separatingAxisFound = true;
+							c.refFace = x;
 							return c;
 						}
 						else {
@@ -379,19 +416,26 @@ namespace mech {
 						}
 					}
 
+					c.incidentFace = getIncidentFace(convexHull1, convexHull2, c.refFace);
+
+					return c;
+				}
+
+				uint16 getIncidentFace(const ConvexHull& refConvexHull, const ConvexHull& incidentConvexHull, const uint16& refFace)
+				{
 					uint16 incidentFace = -1;
 					decimal least = decimalMAX;
-					Plane refPlane = convexHull1.getFacePlane(c.refFace);
-					for (uint32 x = 0, len = convexHull2.halfEdgeMesh.faces.size(); x < len; ++x) {
+					Plane refPlane = refConvexHull.getFacePlane(refFace);
+					for (uint32 x = 0, len = incidentConvexHull.halfEdgeMesh.faces.size(); x < len; ++x) {
 
-						decimal d = dotProduct(convexHull2.getFaceNormal(x), refPlane.normal) + refPlane.getDistanceFromPlane(convexHull2.getFacePolygon(x).getSupportPoint(-refPlane.normal));
+						decimal d = dotProduct(incidentConvexHull.getFaceNormal(x), refPlane.normal) + refPlane.getDistanceFromPlane(incidentConvexHull.getFacePolygon(x).getSupportPoint(-refPlane.normal));
 						if (d < least) {
 							least = d;
-							c.incidentFace = x;
+							incidentFace = x;
 						}
 					}
 
-					return c;
+					return incidentFace;
 				}
 
 				bool edgesBuildMinkowskiFace(const ConvexHull& convexHull1, const ConvexHull& convexHull2, const uint16& e1, const uint16& e2, const Vec3& dir1, const Vec3& dir2)
@@ -430,6 +474,8 @@ namespace mech {
 
 								if (d < decimal(0.0)) {
 									c.separatingAxisFound = true;
+									c.edge1 = x;
+									c.edge2 = y;
 									return c;
 								}
 								else {
@@ -447,6 +493,37 @@ namespace mech {
 					return c;
 				}
 
+				//signed gap between the hulls along the axis, positive means the axis separates them
+				decimal separationAlongAxis(const ConvexHull& convexHull1, const ConvexHull& convexHull2, const Vec3& axis)
+				{
+					return dotProduct(axis, convexHull2.getSupportPoint(-axis) - convexHull1.getSupportPoint(axis));
+				}
+
+				bool cachedAxisSeparates(const HullVsHullContactCache& cache, const ConvexHull& convexHull1, const ConvexHull& convexHull2, const Vec3& center1, const Vec3& center2, const ColliderIdentifier& identifier1)
+				{
+					bool swap = cache.ID1 != identifier1.colliderID;
+					const ConvexHull& hullA = swap ? convexHull2 : convexHull1;
+					const ConvexHull& hullB = swap ? convexHull1 : convexHull2;
+
+					if (cache.cacheFlags & 0b00000010) {
+						return separationAlongAxis(hullA, hullB, hullA.getFaceNormal(cache.refFace)) > -mathEPSILON;
+					}
+					else if (cache.cacheFlags & 0b00000100) {
+
+						LineSegment e1 = hullA.getEdge(cache.edge1);
+						Vec3 axis = crossProduct(e1.getDirection(), hullB.getEdge(cache.edge2).getDirection());
+						if (almostEqual(magnitudeSq(axis), decimal(0.0))) return false;
+
+						axis = normalise(axis);
+						if (dotProduct((swap ? center2 : center1) - e1.pointA, axis) > decimal(0.0)) {
+							axis = -axis;
+						}
+						return separationAlongAxis(hullA, hullB, axis) > decimal(0.0);
+					}
+
+					return false;
+				}
+
 				void generateEdgeContact(const ConvexHull& convexHull1, const ConvexHull& convexHull2, const ClosestEdges& c, ContactManifold& manifold)
 				{
 					LineSegment e1 = convexHull1.getEdge(c.edge1);
@@ -481,7 +558,8 @@ namespace mech {
 					}
 				}
 
-				void generateFaceContacts(PhysicsData* physicsData, const ConvexHull& convexHull1, const ConvexHull& convexHull2, const ClosestFaces& c, ContactManifold& manifold, const ColliderIdentifier& identifier1)
+				//contacts are generated with convexHull1 as the reference hull, the manifold normal points from convexHull1 to convexHull2
+				void generateFaceContacts(const ConvexHull& convexHull1, const ConvexHull& convexHull2, const ClosestFaces& c, ContactManifold& manifold, const Vec3& refCenter)
 				{
 					Plane refPlane = convexHull1.getFacePlane(c.refFace);
 					Polygon refPolygon = convexHull1.getFacePolygon(c.refFace);
@@ -509,89 +587,127 @@ namespace mech {
 
 					} while (edgeIndex != convexHull1.halfEdgeMesh.faces[c.refFace].edgeIndex);
 
-					ASSERT(manifold.numPoints > 0, "manifold can not be empty!!");
-
 					if (manifold.numPoints > MAXIMUM_CONTACT_POINTS) {
-						manifold.enforce4Contacts(physicsData->convexHullColliders[identifier1.colliderIndex].centerOfMass);
+						manifold.enforce4Contacts(refCenter);
 					}
 				}
 
-				void contactsFromCache(HullVsHullContactCache& cache, PhysicsData* physicsData, const ConvexHull& convexHull1, const ConvexHull& convexHull2, ContactManifold& manifold, const ColliderIdentifier& identifier1)
+				bool contactsFromCache(const HullVsHullContactCache& cache, const ConvexHull& convexHull1, const ConvexHull& convexHull2, const Vec3& center1, const Vec3& center2, ContactManifold& manifold, const ColliderIdentifier& identifier1)
 				{
 					ClosestFaces c;
+					c.refFace = cache.refFace;
+					c.incidentFace = cache.incidentFace;
+
 					if (cache.ID1 == identifier1.colliderID) {
-						c.refFace = cache.refFace;
-						c.incidentFace = cache.incidentFace;
-						generateFaceContacts(physicsData, convexHull1, convexHull2, c, manifold, identifier1);
+						generateFaceContacts(convexHull1, convexHull2, c, manifold, center1);
 					}
 					else {
-						c.incidentFace = cache.refFace;
-						c.refFace = cache.incidentFace;
-						generateFaceContacts(physicsData, convexHull2, convexHull1, c, manifold, identifier1);
+						generateFaceContacts(convexHull2, convexHull1, c, manifold, center2);
+						manifold.revert();
 					}
 
 					if (manifold.numPoints > 0) {
 						manifold.flag = CollisionFlag::PENETRATING;
+						return true;
 					}
-					else {
-						cache.cacheFlags = 0;
-					}
+
+					return false;
 				}
 
-				void contactsFromScratch(HullVsHullContactCache& cache, PhysicsData* physicsData, const ConvexHull& convexHull1, const ConvexHull& convexHull2, ContactManifold& manifold, const ColliderIdentifier& identifier1)
+				void contactsFromScratch(HullVsHullContactCache& cache, const ConvexHull& convexHull1, const ConvexHull& convexHull2, const Vec3& center1, const Vec3& center2, ContactManifold& manifold, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2)
 				{
-					/*
-						--------------cache flags----------------
-						cache is not empty               - 0b00000001
-						minimum axis is a face normal    - 0b00000010
-					*/
-					cache.cacheFlags = 0;
-					cache.cacheFlags |= 0b00000001;
-
-					ClosestFaces cFaces = getClosestFaces(convexHull1, convexHull2);
+					cache.cacheFlags = 0b00000001;
+					cache.ID1 = identifier1.colliderID;
 
-					if (cFaces.separatingAxisFound == false) {
+					ClosestFaces cFaces1 = getClosestFaces(convexHull1, convexHull2);
+					if (cFaces1.separatingAxisFound == true) {
+						cache.cacheFlags |= 0b00001010;
+						cache.refFace = cFaces1.refFace;
+						return;
+					}
 
-						ClosestEdges cEdges = getClosestEdges(convexHull1, convexHull2, physicsData->convexHullColliders[identifier1.colliderIndex].centerOfMass);
+					ClosestFaces cFaces2 = getClosestFaces(convexHull2, convexHull1);
+					if (cFaces2.separatingAxisFound == true) {
+						cache.cacheFlags |= 0b00001010;
+						cache.refFace = cFaces2.refFace;
+						cache.ID1 = identifier2.colliderID;
+						return;
+					}
 
-						if (cEdges.separatingAxisFound == false) {
+					ClosestEdges cEdges = getClosestEdges(convexHull1, convexHull2, center1);
+					if (cEdges.separatingAxisFound == true) {
+						cache.cacheFlags |= 0b00001100;
+						cache.edge1 = cEdges.edge1;
+						cache.edge2 = cEdges.edge2;
+						return;
+					}
 
-							if (cFaces.penetration <= cEdges.penetration) {
+					if (cFaces1.penetration <= cEdges.penetration || cFaces2.penetration <= cEdges.penetration) {
 
-								generateFaceContacts(physicsData, convexHull1, convexHull2, cFaces, manifold, identifier1);
+						if (cFaces1.penetration <= cFaces2.penetration) {
+							generateFaceContacts(convexHull1, convexHull2, cFaces1, manifold, center1);
 
-								cache.cacheFlags |= 0b00000010;
-								cache.refFace = cFaces.refFace;
-								cache.incidentFace = cFaces.incidentFace;
-								cache.ID1 = identifier1.colliderID;
-							}
-							else {
-								generateEdgeContact(convexHull1, convexHull2, cEdges, manifold);
-							}
+							cache.refFace = cFaces1.refFace;
+							cache.incidentFace = cFaces1.incidentFace;
+						}
+						else {
+							generateFaceContacts(convexHull2, convexHull1, cFaces2, manifold, center2);
+							manifold.revert();
 
-							manifold.flag = CollisionFlag::PENETRATING;
+							cache.refFace = cFaces2.refFace;
+							cache.incidentFace = cFaces2.incidentFace;
+							cache.ID1 = identifier2.colliderID;
 						}
+
+						ASSERT(manifold.numPoints > 0, "manifold can not be empty!!");
+						cache.cacheFlags |= 0b00000010;
 					}
+					else {
+						generateEdgeContact(convexHull1, convexHull2, cEdges, manifold);
 
-					cache.ID1 = identifier1.colliderID;
+						cache.cacheFlags |= 0b00000100;
+						cache.edge1 = cEdges.edge1;
+						cache.edge2 = cEdges.edge2;
+					}
+
+					manifold.flag = CollisionFlag::PENETRATING;
 				}
 			};
 
+			Vec3 c1 = this->physicsData->convexHullColliders[identifier1.colliderIndex].centerOfMass;
+			Vec3 c2 = this->physicsData->convexHullColliders[identifier2.colliderIndex].centerOfMass;
+
+			//edge pair SAT is O(E1*E2), large hulls go through GJK/EPA and only fall back to SAT if it fails
+			if ((convexHull1.vertices.size() >= this->physicsData->settings.gjkVertexThreshold || convexHull2.vertices.size() >= this->physicsData->settings.gjkVertexThreshold) && this->generateContactsGJK(convexHull1, convexHull2, manifold, c1)) return;
+
 			BEGIN_PROFILE("NarrowPhase::ConvexHullVsConvexHull");
 
 			HullVsHullContactCache& cache = this->physicsData->hullVsHullContactCache[this->physicsData->hullVsHullContactCache.insert(manifold.ID)].second;
 
-			Vec3 c1 = this->physicsData->convexHullColliders[identifier1.colliderIndex].centerOfMass;
-			Vec3 c2 = this->physicsData->convexHullColliders[identifier2.colliderIndex].centerOfMass;
-
 			TaskExecutor ex;
-			if ((cache.cacheFlags & 0b0000000) && (cache.cacheFlags & 0b00000010) && (mathABS(magnitudeSq(c1 - c2) - magnitudeSq(cache.center1 - cache.center2)) < this->physicsData->settings.minimalDispacement)) {
-				ex.contactsFromCache(cache, this->physicsData, convexHull1, convexHull2, manifold, identifier1);
+			bool cacheHit = false;
+			if (cache.cacheFlags & 0b00000001) {
+
+				//the axis that last separated (or least penetrated) the pair is tried first, temporal coherence makes it very likely to still separate
+				if (ex.cachedAxisSeparates(cache, convexHull1, convexHull2, c1, c2, identifier1)) {
+					cache.cacheFlags |= 0b00001000;
+					cacheHit = true;
+				}
+				else if ((cache.cacheFlags & 0b00001010) == 0b00000010 && (mathABS(magnitudeSq(c1 - c2) - magnitudeSq(cache.center1 - cache.center2)) < this->physicsData->settings.minimalDispacement)) {
+					cacheHit = ex.contactsFromCache(cache, convexHull1, convexHull2, c1, c2, manifold, identifier1);
+				}
+			}
+
+			if (cacheHit == true) {
+				++this->physicsData->statistics.hullVsHullCacheHits;
 			}
 			else {
+				++this->physicsData->statistics.hullVsHullCacheMisses;
+
+				manifold.numPoints = 0;
 				cache.center1 = c1;
 				cache.center2 = c2;
-				ex.contactsFromScratch(cache, this->physicsData, convexHull1, convexHull2, manifold, identifier1);
+				ex.contactsFromScratch(cache, convexHull1, convexHull2, c1, c2, manifold, identifier1, identifier2);
 			}
 
 			cache.retention = this->physicsData->settings.framesToRetainCache;
@@ -611,38 +727,51 @@ namespace mech {
 			manifold.revert();
 		}
 
-		void generateContacts(const ConvexHull& convexHull, const HybridArray<Triangle, 24, uint16>& triangles, ContactManifold& manifold, const ColliderIdentifier& identifier1)
+		template<typename Triangles>
+		void generateContacts(const ConvexHull& convexHull, const Triangles& triangles, const AABB& aabb, ContactManifold& manifold, const ColliderIdentifier& identifier1)
 		{
 			BEGIN_PROFILE("NarrowPhase::ConvexHullVstriangles");
 
-			HybridArray<uint16, 8, uint16> registered;
-			
-			for (uint32 x = 0, len1 = triangles.size(); x < len1; ++x) {
+			//every vertex is registered once, the query stops once the manifold is full
+			struct Kernel {
+				const ConvexHull& convexHull;
+				ContactManifold& manifold;
+				HybridArray<uint16, 8, uint16> registered;
+
+				bool visit(const Triangle& triangle)
+				{
+					if (this->convexHull.intersects(triangle)) {
+
+						Plane plane = triangle.toPlane();
 
-				if (convexHull.intersects(triangles[x])) {
+						for (uint32 y = 0, len = this->convexHull.vertices.size(); y < len; ++y) {
 
-					Plane plane = triangles[x].toPlane();
+							if (this->registered.find(y) == false) {
 
-					for (uint32 y = 0, len2 = convexHull.vertices.size(); y < len2; ++y) {
-						
-						if (registered.find(y) == false) {
+								if (plane.getDistanceFromPlane(this->convexHull.vertices[y]) < decimal(0.0)) {
 
-							if (plane.getDistanceFromPlane(convexHull.vertices[y]) < decimal(0.0)) {
+									Vec3 closest = plane.closestPoint(this->convexHull.vertices[y]);
 
-								Vec3 closest = plane.closestPoint(convexHull.vertices[y]);
+									if (triangle.contains(closest)) {
+										this->manifold.flag = CollisionFlag::PENETRATING;
+										this->manifold.addContact(-plane.normal, this->convexHull.vertices[y], closest, y);
+										this->registered.pushBack(y);
 
-								if (triangles[x].contains(closest)) {
-									manifold.flag = CollisionFlag::PENETRATING;
-									manifold.addContact(-plane.normal, convexHull.vertices[y], closest, y);
-									registered.pushBack(y);
+										DEBUG_RENDERER_ADD(triangle, WHITE);
 
-									DEBUG_RENDERER_ADD(triangles[x], WHITE);
+										if (this->manifold.numPoints == MAXIMUN_MANIFOLD_CONTACT_POINTS) return false;
+									}
 								}
 							}
 						}
 					}
+
+					return true;
 				}
-			}
+			};
+
+			Kernel kernel = { convexHull, manifold, {} };
+			triangles.forEachTriangleOverlapped(aabb, kernel);
 
 			if (manifold.numPoints > MAXIMUM_CONTACT_POINTS) {
 				manifold.enforce4Contacts(this->physicsData->convexHullColliders[identifier1.colliderIndex].bound.getCenter());
@@ -650,8 +779,775 @@ namespace mech {
 
 			END_PROFILE;
 		}
+
+		//box faces are numbered axis * 2, +1 for the face on the negative side of the axis
+		byte getMostAlignedFace(const OBB& box, const Vec3& direction)
+		{
+			byte face = 0;
+			decimal largest = -decimalMAX;
+			for (byte x = 0; x < 3; ++x) {
+				decimal d = dotProduct(box.orientation.getColumn(x), direction);
+				if (mathABS(d) > largest) {
+					largest = mathABS(d);
+					face = x * 2 + (d >= decimal(0.0) ? 0 : 1);
+				}
+			}
+
+			return face;
+		}
+
+		Vec3 getFaceNormal(const OBB& box, const byte& face)
+		{
+			return (face & 1) ? -box.orientation.getColumn(face / 2) : box.orientation.getColumn(face / 2);
+		}
+
+		Plane getFacePlane(const OBB& box, const byte& face)
+		{
+			Vec3 n = this->getFaceNormal(box, face);
+			return Plane(n, dotProduct(n, box.center) + box.halfExtents[face / 2]);
+		}
+
+		void getFacePolygon(const OBB& box, const byte& face, HybridArray<Vec3, 16, byte>& polygon)
+		{
+			byte u = (face / 2 + 1) % 3;
+			byte v = (face / 2 + 2) % 3;
+
+			Vec3 c = box.center + this->getFaceNormal(box, face) * box.halfExtents[face / 2];
+			Vec3 du = box.orientation.getColumn(u) * box.halfExtents[u];
+			Vec3 dv = box.orientation.getColumn(v) * box.halfExtents[v];
+
+			polygon.pushBack(c + du + dv);
+			polygon.pushBack(c - du + dv);
+			polygon.pushBack(c - du - dv);
+			polygon.pushBack(c + du - dv);
+		}
+
+		HybridArray<Plane, 8, byte> getSidePlanes(const OBB& box, const byte& face)
+		{
+			HybridArray<Plane, 8, byte> planes;
+			for (byte x = 0; x < 6; ++x) {
+				if (x / 2 != face / 2) {
+					planes.pushBack(this->getFacePlane(box, x));
+				}
+			}
+
+			return planes;
+		}
+
+		//clips the incident polygon against the side planes of the reference face and keeps the points below it
+		void generateClippedContacts(HybridArray<Vec3, 16, byte>& polygon, const HybridArray<Plane, 8, byte>& sidePlanes, const Plane& refPlane, const Vec3& normal, const bool& refIsShape1, const uint32& faces, ContactManifold& manifold)
+		{
+			for (byte x = 0, len = sidePlanes.size(); x < len && polygon.empty() == false; ++x) {
+				this->clipPolygon(polygon, sidePlanes[x]);
+			}
+
+			byte stride = (byte)(polygon.size() / MAXIMUN_MANIFOLD_CONTACT_POINTS + 1);
+			for (byte x = 0, len = polygon.size(); x < len; x += stride) {
+
+				decimal d = refPlane.getDistanceFromPlane(polygon[x]);
+				if (d <= decimal(0.0)) {
+
+					Vec3 onRef = polygon[x] - refPlane.normal * d;
+					uint32 id = pairingFunction(faces, pairingFunction(x, refIsShape1 ? 0 : 1));
+					if (refIsShape1) {
+						manifold.addContact(normal, onRef, polygon[x], id);
+					}
+					else {
+						manifold.addContact(normal, polygon[x], onRef, id);
+					}
+				}
+			}
+		}
+
+		//15 axis SAT, face contacts come from clipping the incident face against the reference face
+		void generateContacts(const OBB& box1, const OBB& box2, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::BoxVsBox");
+
+			Vec3 axes1[3] = { box1.orientation.getColumn(0), box1.orientation.getColumn(1), box1.orientation.getColumn(2) };
+			Vec3 axes2[3] = { box2.orientation.getColumn(0), box2.orientation.getColumn(1), box2.orientation.getColumn(2) };
+			Vec3 d = box2.center - box1.center;
+
+			//the epsilon keeps near parallel edges from producing a false separating axis
+			decimal absR[3][3];
+			for (byte x = 0; x < 3; ++x) {
+				for (byte y = 0; y < 3; ++y) {
+					absR[x][y] = mathABS(dotProduct(axes1[x], axes2[y])) + mathEPSILON;
+				}
+			}
+
+			decimal separation1 = -decimalMAX;
+			byte axis1 = -1;
+			for (byte x = 0; x < 3; ++x) {
+				decimal s = mathABS(dotProduct(d, axes1[x])) - (box1.halfExtents[x] + box2.halfExtents[0] * absR[x][0] + box2.halfExtents[1] * absR[x][1] + box2.halfExtents[2] * absR[x][2]);
+				if (s > decimal(0.0)) {
+					END_PROFILE;
+					return;
+				}
+				if (s > separation1) {
+					separation1 = s;
+					axis1 = x;
+				}
+			}
+
+			decimal separation2 = -decimalMAX;
+			byte axis2 = -1;
+			for (byte x = 0; x < 3; ++x) {
+				decimal s = mathABS(dotProduct(d, axes2[x])) - (box2.halfExtents[x] + box1.halfExtents[0] * absR[0][x] + box1.halfExtents[1] * absR[1][x] + box1.halfExtents[2] * absR[2][x]);
+				if (s > decimal(0.0)) {
+					END_PROFILE;
+					return;
+				}
+				if (s > separation2) {
+					separation2 = s;
+					axis2 = x;
+				}
+			}
+
+			decimal separation3 = -decimalMAX;
+			byte edge1 = -1;
+			byte edge2 = -1;
+			Vec3 edgeAxis;
+			for (byte x = 0; x < 3; ++x) {
+				for (byte y = 0; y < 3; ++y) {
+
+					Vec3 axis = crossProduct(axes1[x], axes2[y]);
+					decimal length = magnitude(axis);
+					if (length < decimal(0.001)) continue; //parallel edges, the face axes cover them
+
+					axis /= length;
+					decimal r1 = box1.halfExtents[0] * mathABS(dotProduct(axes1[0], axis)) + box1.halfExtents[1] * mathABS(dotProduct(axes1[1], axis)) + box1.halfExtents[2] * mathABS(dotProduct(axes1[2], axis));
+					decimal r2 = box2.halfExtents[0] * mathABS(dotProduct(axes2[0], axis)) + box2.halfExtents[1] * mathABS(dotProduct(axes2[1], axis)) + box2.halfExtents[2] * mathABS(dotProduct(axes2[2], axis));
+					decimal s = mathABS(dotProduct(d, axis)) - r1 - r2;
+					if (s > decimal(0.0)) {
+						END_PROFILE;
+						return;
+					}
+					if (s > separation3) {
+						separation3 = s;
+						edge1 = x;
+						edge2 = y;
+						edgeAxis = axis;
+					}
+				}
+			}
+
+			manifold.flag = CollisionFlag::PENETRATING;
+
+			//faces are preferred unless another axis is clearly better, keeps the contacts from flickering between features
+			decimal faceSeparation = mathMAX(separation1, separation2);
+			if (separation3 > faceSeparation * decimal(0.98) + decimal(0.001)) {
+
+				Vec3 n = dotProduct(edgeAxis, d) < decimal(0.0) ? -edgeAxis : edgeAxis;
+
+				Vec3 p1 = box1.center;
+				Vec3 p2 = box2.center;
+				for (byte x = 0; x < 3; ++x) {
+					if (x != edge1) p1 += axes1[x] * (dotProduct(axes1[x], n) > decimal(0.0) ? box1.halfExtents[x] : -box1.halfExtents[x]);
+					if (x != edge2) p2 += axes2[x] * (dotProduct(axes2[x], n) > decimal(0.0) ? -box2.halfExtents[x] : box2.halfExtents[x]);
+				}
+
+				LineSegment e1 = LineSegment(p1 - axes1[edge1] * box1.halfExtents[edge1], p1 + axes1[edge1] * box1.halfExtents[edge1]);
+				LineSegment e2 = LineSegment(p2 - axes2[edge2] * box2.halfExtents[edge2], p2 + axes2[edge2] * box2.halfExtents[edge2]);
+				Vec3 c1 = e1.closestPoint(e2);
+				manifold.addContact(n, c1, e2.closestPoint(c1), pairingFunction(pairingFunction(edge1, edge2), 6));
+
+				END_PROFILE;
+				return;
+			}
+
+			bool refIsBox1 = separation2 <= separation1 * decimal(0.98) + decimal(0.001);
+			const OBB& refBox = refIsBox1 ? box1 : box2;
+			const OBB& incidentBox = refIsBox1 ? box2 : box1;
+
+			Vec3 toIncident = refIsBox1 ? d : -d;
+			byte refAxis = refIsBox1 ? axis1 : axis2;
+			byte refFace = refAxis * 2 + (dotProduct(refBox.orientation.getColumn(refAxis), toIncident) >= decimal(0.0) ? 0 : 1);
+			Plane refPlane = this->getFacePlane(refBox, refFace);
+			byte incidentFace = this->getMostAlignedFace(incidentBox, -refPlane.normal);
+
+			HybridArray<Vec3, 16, byte> polygon;
+			this->getFacePolygon(incidentBox, incidentFace, polygon);
+			this->generateClippedContacts(polygon, this->getSidePlanes(refBox, refFace), refPlane, refIsBox1 ? refPlane.normal : -refPlane.normal, refIsBox1, pairingFunction(refFace, incidentFace), manifold);
+
+			if (manifold.numPoints == 0) {
+				manifold.flag = CollisionFlag::PROXIMAL;
+			}
+			else if (manifold.numPoints > MAXIMUM_CONTACT_POINTS) {
+				manifold.enforce4Contacts(box1.center);
+			}
+
+			END_PROFILE;
+		}
+
+		void generateContacts(const Sphere& sphere, const OBB& box, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::SphereVsBox");
+
+			Vec3 closest = box.closestPoint(sphere.center);
+			decimal distanceSq = magnitudeSq(closest - sphere.center);
+
+			if (distanceSq < square(sphere.radius)) {
+
+				manifold.flag = CollisionFlag::PENETRATING;
+
+				if (distanceSq > square(mathEPSILON)) {
+					Vec3 n = (closest - sphere.center) / mathSQRT(distanceSq);
+					manifold.addContact(n, sphere.center + n * sphere.radius, closest, 2);
+				}
+				else {
+
+					//the center is inside the box, push it out through the nearest face
+					byte face = -1;
+					decimal least = decimalMAX;
+					for (byte x = 0; x < 6; ++x) {
+						decimal d = -this->getFacePlane(box, x).getDistanceFromPlane(sphere.center);
+						if (d < least) {
+							least = d;
+							face = x;
+						}
+					}
+
+					Vec3 faceNormal = this->getFaceNormal(box, face);
+					manifold.addContact(-faceNormal, sphere.center - faceNormal * sphere.radius, sphere.center + faceNormal * least, 1);
+				}
+			}
+
+			END_PROFILE;
+		}
+
+		void generateContacts(const OBB& box, const Sphere& sphere, ContactManifold& manifold)
+		{
+			generateContacts(sphere, box, manifold);
+			manifold.revert();
+		}
+
+		void generateContacts(const Capsule& capsule, const OBB& box, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::CapsuleVsBox");
+
+			Vec3 onBox = box.closestPoint(capsule.capsuleLine);
+			Vec3 onLine = capsule.capsuleLine.closestPoint(onBox);
+			decimal distanceSq = magnitudeSq(onBox - onLine);
+
+			if (distanceSq < square(capsule.radius)) {
+
+				manifold.flag = CollisionFlag::PENETRATING;
+
+				//n points from the capsule to the box
+				Vec3 n;
+				Vec3 pointOnCapsule;
+				Vec3 pointOnBox;
+				if (distanceSq > square(mathEPSILON)) {
+					n = (onBox - onLine) / mathSQRT(distanceSq);
+					pointOnCapsule = onLine + n * capsule.radius;
+					pointOnBox = onBox;
+				}
+				else {
+
+					//the core segment is inside the box, push it out through the face it penetrates the least
+					Plane facePlane;
+					decimal least = decimalMAX;
+					for (byte x = 0; x < 6; ++x) {
+						Plane plane = this->getFacePlane(box, x);
+						decimal d = -plane.getDistanceFromPlane(capsule.getSupportPoint(-plane.normal));
+						if (d < least) {
+							least = d;
+							facePlane = plane;
+						}
+					}
+
+					n = -facePlane.normal;
+					pointOnCapsule = capsule.getSupportPoint(n);
+					pointOnBox = facePlane.closestPoint(pointOnCapsule);
+				}
+
+				//a capsule lying flat on a face gets two contacts from the segment clipped to that face
+				byte face = this->getMostAlignedFace(box, -n);
+				Vec3 faceNormal = this->getFaceNormal(box, face);
+				if (dotProduct(faceNormal, -n) > decimal(0.95) && mathABS(dotProduct(faceNormal, normalise(capsule.capsuleLine.getDirection()))) < decimal(0.05)) {
+
+					Vec3 a = capsule.pointA;
+					Vec3 b = capsule.pointB;
+
+					if (this->clipSegment(a, b, this->getSidePlanes(box, face))) {
+
+						Plane facePlane = this->getFacePlane(box, face);
+						Vec3 points[2] = { a, b };
+						for (byte x = 0; x < 2; ++x) {
+							if (facePlane.getDistanceFromPlane(points[x]) < capsule.radius) {
+								manifold.addContact(-faceNormal, points[x] - faceNormal * capsule.radius, facePlane.closestPoint(points[x]), pairingFunction(pairingFunction(face, 1), x));
+							}
+						}
+					}
+				}
+
+				if (manifold.numPoints == 0) {
+					manifold.addContact(n, pointOnCapsule, pointOnBox, 3);
+				}
+			}
+
+			END_PROFILE;
+		}
+
+		void generateContacts(const OBB& box, const Capsule& capsule, ContactManifold& manifold)
+		{
+			generateContacts(capsule, box, manifold);
+			manifold.revert();
+		}
+
+		void generateContacts(const OBB& box, const ConvexHull& convexHull, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::BoxVsConvexHull");
+
+			++this->physicsData->statistics.gjkQueries;
+
+			GJKDistanceResult gjkResult = GJKDistance(box, convexHull, this->getGJKCache(manifold.ID));
+			if (gjkResult.overlap == false) {
+				END_PROFILE;
+				return;
+			}
+
+			++this->physicsData->statistics.epaQueries;
+
+			Vec3 n;
+			EPAResult epaResult = EPAPenetration(box, convexHull, gjkResult.simplex);
+			if (epaResult.valid == true) {
+				n = epaResult.normal;
+			}
+			else {
+
+				//face axes of both shapes, the one with the least penetration
+				decimal largest = -decimalMAX;
+				for (byte x = 0; x < 6; ++x) {
+					Vec3 axis = this->getFaceNormal(box, x);
+					decimal s = dotProduct(axis, convexHull.getSupportPoint(-axis) - box.getSupportPoint(axis));
+					if (s > largest) {
+						largest = s;
+						n = axis;
+					}
+				}
+				for (uint16 x = 0, len = convexHull.halfEdgeMesh.faces.size(); x < len; ++x) {
+					Vec3 axis = -convexHull.getFaceNormal(x);
+					decimal s = dotProduct(axis, convexHull.getSupportPoint(-axis) - box.getSupportPoint(axis));
+					if (s > largest) {
+						largest = s;
+						n = axis;
+					}
+				}
+			}
+
+			manifold.flag = CollisionFlag::PENETRATING;
+
+			byte boxFace = this->getMostAlignedFace(box, n);
+			uint16 hullFace = this->getMostAlignedFace(convexHull, -n);
+			bool refIsBox = dotProduct(this->getFaceNormal(box, boxFace), n) >= dotProduct(convexHull.getFaceNormal(hullFace), -n) * decimal(0.98);
+
+			HybridArray<Vec3, 16, byte> polygon;
+			if (refIsBox) {
+				Polygon incidentPolygon = convexHull.getFacePolygon(hullFace);
+				for (byte x = 0, len = incidentPolygon.vertices.size(); x < len; ++x) {
+					polygon.pushBack(incidentPolygon.vertices[x]);
+				}
+				this->generateClippedContacts(polygon, this->getSidePlanes(box, boxFace), this->getFacePlane(box, boxFace), n, true, pairingFunction(boxFace, hullFace), manifold);
+			}
+			else {
+				this->getFacePolygon(box, boxFace, polygon);
+				this->generateClippedContacts(polygon, this->getSidePlanes(convexHull, hullFace), convexHull.getFacePlane(hullFace), n, false, pairingFunction(hullFace, boxFace), manifold);
+			}
+
+			if (manifold.numPoints == 0) {
+				if (epaResult.valid == true) {
+					manifold.addContact(n, epaResult.closest1, epaResult.closest2, pairingFunction(boxFace, hullFace));
+				}
+				else {
+					manifold.flag = CollisionFlag::PROXIMAL;
+				}
+			}
+			else if (manifold.numPoints > MAXIMUM_CONTACT_POINTS) {
+				manifold.enforce4Contacts(box.center);
+			}
+
+			END_PROFILE;
+		}
+
+		void generateContacts(const ConvexHull& convexHull, const OBB& box, ContactManifold& manifold)
+		{
+			generateContacts(box, convexHull, manifold);
+			manifold.revert();
+		}
+
+		template<typename Triangles>
+		void generateContacts(const OBB& box, const Triangles& triangles, const AABB& aabb, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::BoxVstriangles");
+
+			//every corner is registered once, the query stops once all of them are
+			struct Kernel {
+				const OBB& box;
+				ContactManifold& manifold;
+				StackArray<Vec3, 8> vertices;
+				byte registered = 0;
+
+				bool visit(const Triangle& triangle)
+				{
+					if (this->box.intersects(triangle)) {
+
+						Plane plane = triangle.toPlane();
+
+						for (byte y = 0; y < 8; ++y) {
+
+							if ((this->registered & (1 << y)) == 0 && plane.getDistanceFromPlane(this->vertices[y]) < decimal(0.0)) {
+
+								Vec3 closest = plane.closestPoint(this->vertices[y]);
+
+								if (triangle.contains(closest)) {
+									this->manifold.flag = CollisionFlag::PENETRATING;
+									this->manifold.addContact(-plane.normal, this->vertices[y], closest, y);
+									this->registered |= (1 << y);
+
+									DEBUG_RENDERER_ADD(triangle, WHITE);
+								}
+							}
+						}
+					}
+
+					return this->registered != 0xFF;
+				}
+			};
+
+			Kernel kernel = { box, manifold, box.getVertices() };
+			triangles.forEachTriangleOverlapped(aabb, kernel);
+
+			if (manifold.numPoints > MAXIMUM_CONTACT_POINTS) {
+				manifold.enforce4Contacts(box.center);
+			}
+
+			END_PROFILE;
+		}
+
+		GJKSimplexCache& getGJKCache(const uint32& manifoldID)
+		{
+			GJKContactCache& cache = this->physicsData->gjkContactCache[this->physicsData->gjkContactCache.insert(manifoldID)].second;
+			cache.retention = this->physicsData->settings.framesToRetainCache;
+			return cache.simplex;
+		}
+
+		//index of the face whose normal is the most aligned with the direction
+		uint16 getMostAlignedFace(const ConvexHull& convexHull, const Vec3& direction)
+		{
+			uint16 face = -1;
+			decimal largest = -decimalMAX;
+			for (uint16 x = 0, len = convexHull.halfEdgeMesh.faces.size(); x < len; ++x) {
+				decimal d = dotProduct(convexHull.getFaceNormal(x), direction);
+				if (d > largest) {
+					largest = d;
+					face = x;
+				}
+			}
+
+			return face;
+		}
+
+		//planes through the edges of the face, perpendicular to it and facing away from its interior
+		HybridArray<Plane, 8, byte> getSidePlanes(const ConvexHull& convexHull, const uint16& face)
+		{
+			HybridArray<Plane, 8, byte> planes;
+
+			Polygon polygon = convexHull.getFacePolygon(face);
+			Vec3 faceNormal = convexHull.getFaceNormal(face);
+			Vec3 centroid = polygon.getCentroid();
+
+			for (byte x = 0, len = polygon.vertices.size(); x < len; ++x) {
+
+				const Vec3& v0 = polygon.vertices[x];
+				const Vec3& v1 = polygon.vertices[(x + 1) % len];
+
+				Vec3 n = crossProduct(v1 - v0, faceNormal);
+				if (almostEqual(magnitudeSq(n), decimal(0.0))) continue;
+				if (dotProduct(n, centroid - v0) > decimal(0.0)) {
+					n = -n;
+				}
+
+				n = normalise(n);
+				planes.pushBack(Plane(n, dotProduct(n, v0)));
+			}
+
+			return planes;
+		}
+
+		void clipPolygon(HybridArray<Vec3, 16, byte>& polygon, const Plane& plane)
+		{
+			HybridArray<Vec3, 16, byte> clipped;
+			for (byte x = 0, len = polygon.size(); x < len; ++x) {
+
+				const Vec3& a = polygon[x];
+				const Vec3& b = polygon[(x + 1) % len];
+				decimal da = plane.getDistanceFromPlane(a);
+				decimal db = plane.getDistanceFromPlane(b);
+
+				if (da <= decimal(0.0)) {
+					clipped.pushBack(a);
+				}
+				if ((da < decimal(0.0) && db > decimal(0.0)) || (da > decimal(0.0) && db < decimal(0.0))) {
+					clipped.pushBack(a + (b - a) * (da / (da - db)));
+				}
+			}
+
+			polygon.clear();
+			for (byte x = 0, len = clipped.size(); x < len; ++x) {
+				polygon.pushBack(clipped[x]);
+			}
+		}
+
+		//keeps the part of the segment behind every plane, returns false if nothing is left
+		bool clipSegment(Vec3& a, Vec3& b, const HybridArray<Plane, 8, byte>& planes)
+		{
+			for (byte x = 0, len = planes.size(); x < len; ++x) {
+
+				decimal da = planes[x].getDistanceFromPlane(a);
+				decimal db = planes[x].getDistanceFromPlane(b);
+				if (da > decimal(0.0) && db > decimal(0.0)) {
+					return false;
+				}
+				else if (da > decimal(0.0)) {
+					a = a + (b - a) * (da / (da - db));
+				}
+				else if (db > decimal(0.0)) {
+					b = b + (a - b) * (db / (db - da));
+				}
+			}
+
+			return true;
+		}
+
+		//returns false if GJK/EPA could not resolve the pair and SAT should take over
+		bool generateContactsGJK(const ConvexHull& convexHull1, const ConvexHull& convexHull2, ContactManifold& manifold, const Vec3& center1)
+		{
+			BEGIN_PROFILE("NarrowPhase::ConvexHullVsConvexHullGJK");
+
+			++this->physicsData->statistics.gjkQueries;
+
+			GJKDistanceResult gjkResult = GJKDistance(convexHull1, convexHull2, this->getGJKCache(manifold.ID));
+			if (gjkResult.overlap == false) {
+				END_PROFILE;
+				return true;
+			}
+
+			++this->physicsData->statistics.epaQueries;
+
+			EPAResult epaResult = EPAPenetration(convexHull1, convexHull2, gjkResult.simplex);
+			if (epaResult.valid == false) {
+				END_PROFILE;
+				return false;
+			}
+
+			manifold.flag = CollisionFlag::PENETRATING;
+
+			//the reference face is the one most aligned with the EPA normal, the other hull provides the incident face
+			uint16 face1 = this->getMostAlignedFace(convexHull1, epaResult.normal);
+			uint16 face2 = this->getMostAlignedFace(convexHull2, -epaResult.normal);
+			bool refIsHull1 = dotProduct(convexHull1.getFaceNormal(face1), epaResult.normal) >= dotProduct(convexHull2.getFaceNormal(face2), -epaResult.normal) * decimal(0.98);
+
+			const ConvexHull& refConvexHull = refIsHull1 ? convexHull1 : convexHull2;
+			const ConvexHull& incidentConvexHull = refIsHull1 ? convexHull2 : convexHull1;
+			uint16 refFace = refIsHull1 ? face1 : face2;
+			uint16 incidentFace = refIsHull1 ? face2 : face1;
+
+			HybridArray<Vec3, 16, byte> polygon;
+			{
+				Polygon incidentPolygon = incidentConvexHull.getFacePolygon(incidentFace);
+				for (byte x = 0, len = incidentPolygon.vertices.size(); x < len; ++x) {
+					polygon.pushBack(incidentPolygon.vertices[x]);
+				}
+			}
+
+			HybridArray<Plane, 8, byte> sidePlanes = this->getSidePlanes(refConvexHull, refFace);
+			for (byte x = 0, len = sidePlanes.size(); x < len && polygon.empty() == false; ++x) {
+				this->clipPolygon(polygon, sidePlanes[x]);
+			}
+
+			Plane refPlane = refConvexHull.getFacePlane(refFace);
+			byte stride = (byte)(polygon.size() / MAXIMUN_MANIFOLD_CONTACT_POINTS + 1);
+			for (byte x = 0, len = polygon.size(); x < len; x += stride) {
+
+				decimal d = refPlane.getDistanceFromPlane(polygon[x]);
+				if (d <= decimal(0.0)) {
+
+					Vec3 onRef = polygon[x] - refPlane.normal * d;
+					uint32 id = pairingFunction(pairingFunction(refFace, incidentFace), pairingFunction(x, refIsHull1 ? 0 : 1));
+					if (refIsHull1) {
+						manifold.addContact(epaResult.normal, onRef, polygon[x], id);
+					}
+					else {
+						manifold.addContact(epaResult.normal, polygon[x], onRef, id);
+					}
+				}
+			}
+
+			if (manifold.numPoints == 0) {
+				manifold.addContact(epaResult.normal, epaResult.closest1, epaResult.closest2, HULLS_FALLBACK_CONTACT_ID);
+			}
+			else if (manifold.numPoints > MAXIMUM_CONTACT_POINTS) {
+				manifold.enforce4Contacts(center1);
+			}
+
+			END_PROFILE;
+			return true;
+		}
+
+		bool generateContactsGJK(const Capsule& capsule, const ConvexHull& convexHull, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::CapsuleVsConvexHullGJK");
+
+			++this->physicsData->statistics.gjkQueries;
+
+			Vec3 n, pointOnLine, pointOnHull;
+
+			//the capsule is treated as its core segment, the radius is added afterwards
+			GJKDistanceResult gjkResult = GJKDistance(capsule.capsuleLine, convexHull, this->getGJKCache(manifold.ID));
+			if (gjkResult.overlap == false) {
+
+				if (magnitudeSq(gjkResult.closest2 - gjkResult.closest1) >= square(capsule.radius)) {
+					END_PROFILE;
+					return true;
+				}
+
+				n = normalise(gjkResult.closest2 - gjkResult.closest1);
+				pointOnLine = gjkResult.closest1;
+				pointOnHull = gjkResult.closest2;
+			}
+			else {
+
+				++this->physicsData->statistics.epaQueries;
+
+				EPAResult epaResult = EPAPenetration(capsule.capsuleLine, convexHull, gjkResult.simplex);
+				if (epaResult.valid == false) {
+					END_PROFILE;
+					return false;
+				}
+
+				n = epaResult.normal;
+				pointOnLine = epaResult.closest1;
+				pointOnHull = epaResult.closest2;
+			}
+
+			manifold.flag = CollisionFlag::PENETRATING;
+
+			//a capsule lying flat on a face gets two contacts from the segment clipped to that face
+			uint16 face = this->getMostAlignedFace(convexHull, -n);
+			Vec3 faceNormal = convexHull.getFaceNormal(face);
+			if (dotProduct(faceNormal, -n) > decimal(0.95) && mathABS(dotProduct(faceNormal, normalise(capsule.capsuleLine.getDirection()))) < decimal(0.05)) {
+
+				Vec3 a = capsule.pointA;
+				Vec3 b = capsule.pointB;
+
+				if (this->clipSegment(a, b, this->getSidePlanes(convexHull, face))) {
+
+					Plane facePlane = convexHull.getFacePlane(face);
+					Vec3 points[2] = { a, b };
+					for (byte x = 0; x < 2; ++x) {
+						if (facePlane.getDistanceFromPlane(points[x]) < capsule.radius) {
+							manifold.addContact(-faceNormal, points[x] - faceNormal * capsule.radius, facePlane.closestPoint(points[x]), pairingFunction(pairingFunction(face, 1), x));
+						}
+					}
+				}
+			}
+
+			if (manifold.numPoints == 0) {
+				manifold.addContact(n, pointOnLine + n * capsule.radius, pointOnHull, CAPSULE_HULL_FALLBACK_CONTACT_ID);
+			}
+
+			END_PROFILE;
+			return true;
+		}
+
+		bool generateContactsGJK(const Sphere& sphere, const ConvexHull& convexHull, ContactManifold& manifold)
+		{
+			BEGIN_PROFILE("NarrowPhase::SphereVsConvexHullGJK");
+
+			++this->physicsData->statistics.gjkQueries;
+
+			//the sphere is treated as its center point, the radius is added afterwards
+			LineSegment core = LineSegment(sphere.center, sphere.center);
+
+			GJKDistanceResult gjkResult = GJKDistance(core, convexHull, this->getGJKCache(manifold.ID));
+			if (gjkResult.overlap == false) {
+
+				if (magnitudeSq(gjkResult.closest2 - sphere.center) < square(sphere.radius)) {
+					manifold.flag = CollisionFlag::PENETRATING;
+					Vec3 n = normalise(gjkResult.closest2 - sphere.center);
+					manifold.addContact(n, sphere.center + n * sphere.radius, gjkResult.closest2, 2);
+				}
+
+				END_PROFILE;
+				return true;
+			}
+
+			++this->physicsData->statistics.epaQueries;
+
+			EPAResult epaResult = EPAPenetration(core, convexHull, gjkResult.simplex);
+			if (epaResult.valid == false) {
+				END_PROFILE;
+				return false;
+			}
+
+			manifold.flag = CollisionFlag::PENETRATING;
+			manifold.addContact(epaResult.normal, sphere.center + epaResult.normal * sphere.radius, epaResult.closest2, 1);
+
+			END_PROFILE;
+			return true;
+		}
+
+		//adds the closest points of two separated shapes when they are nearer than the margin, penetration is left to the regular contact generation.
+		//featureID tells the pair of shapes apart from the others added to the same manifold so the cached impulses follow the right point
+		template<typename T1, typename T2>
+		void generateSpeculativeContact(const T1& shape1, const T2& shape2, ContactManifold& manifold, const decimal& margin, const uint32& featureID)
+		{
+			BEGIN_PROFILE("NarrowPhase::speculativeContact");
+
+			//the default tolerance reports gaps of about 0.1 as overlaps, which regular contact generation then misses as well
+			GJKDistanceResult gjkResult = GJKDistance(shape1, shape2, Vec3(), mathEPSILON);
+			if (gjkResult.overlap == false) {
+
+				Vec3 d = gjkResult.closest2 - gjkResult.closest1;
+				decimal distanceSq = magnitudeSq(d);
+
+				if (distanceSq < square(margin) && distanceSq > square(mathEPSILON)) {
+
+					decimal distance = mathSQRT(distanceSq);
+					uint32 id = SPECULATIVE_CONTACT_ID_BASE | ((featureID << 4) & 0x0FFFFFF0);
+
+					if (manifold.numPoints < MAXIMUM_CONTACT_POINTS) {
+						manifold.addContact(d / distance, gjkResult.closest1, gjkResult.closest2, id);
+						manifold.flag = CollisionFlag::SPECULATIVE;
+					}
+					else {
+
+						//all constraint slots are taken, replace the farthest point if this one is closer
+						byte farthest = -1;
+						decimal largest = distance;
+						for (byte x = 0; x < manifold.numPoints; ++x) {
+							decimal separation = dotProduct(manifold.contactPoints[x].normal, manifold.contactPoints[x].position[1] - manifold.contactPoints[x].position[0]);
+							if (separation > largest) {
+								largest = separation;
+								farthest = x;
+							}
+						}
+
+						if (isAValidIndex(farthest)) {
+							manifold.contactPoints[farthest].normal = d / distance;
+							manifold.contactPoints[farthest].position[0] = gjkResult.closest1;
+							manifold.contactPoints[farthest].position[1] = gjkResult.closest2;
+							manifold.contactPoints[farthest].ID = id;
+						}
+					}
+				}
+			}
+
+			END_PROFILE;
+		}
 	};
 }
 
 #endif
-
@@ -175,9 +175,7 @@ namespace mech {
 							if (depth == octree->depth) {
 								octree->nodes[childIndex].entities.insert(entityID);
 								nodes.pushBack(childIndex);
-								if (octree->heightFieldLink->intersects(a)) {
-									octree->nodes[childIndex].entities.insert(octree->heightFieldLink->heightFieldID);
-								}
+								octree->heightFieldLink->addHeightFields(a, octree->nodes[childIndex].entities);
 							}
 							else {
 								findNode(octree, childIndex, entityID, entityAABB, depth, nodes);
@@ -454,9 +452,7 @@ namespace mech {
 						if (bound.contains(nodeCenter)) {
 							childIndex = insertChild(octree, parent, bound, x);
 							if (depth == 0) {
-								if (octree->heightFieldLink->intersects(bound)) {
-									octree->nodes[childIndex].entities.insert(octree->heightFieldLink->heightFieldID);
-								}
+								octree->heightFieldLink->addHeightFields(bound, octree->nodes[childIndex].entities);
 							}
 							break;
 						}
@@ -533,9 +529,70 @@ namespace mech {
 		referenceNodes = this->addEntity(entityID, entityAABB);
 	}
 
+	void Octree::addStaticEntity(const uint32& entityID, const AABB& entityAABB)
+	{
+		struct TaskExecuter {
+
+			void addToNode(Octree* octree, const uint16& nodeIndex, const uint32& entityID, const AABB& entityAABB, byte depth)
+			{
+				if (depth == octree->depth) {
+					octree->nodes[nodeIndex].entities.insert(entityID);
+					return;
+				}
+
+				++depth;
+				for (byte x = 0; x < 8; ++x) {
+					if (isAValidIndex(octree->nodes[nodeIndex].children[x].first)) {
+						uint16 childIndex = octree->nodes[nodeIndex].children[x].second;
+						if (octree->nodes[childIndex].bound.intersects(entityAABB)) {
+							addToNode(octree, childIndex, entityID, entityAABB, depth);
+						}
+					}
+				}
+			}
+		};
+
+		ASSERT(this->nodes.empty() == false, "no parent node!!, initialise octree first");
+
+		TaskExecuter ex;
+		if (this->nodes[0].bound.intersects(entityAABB)) {
+			ex.addToNode(this, 0, entityID, entityAABB, 0);
+		}
+	}
+
+	void Octree::eraseStaticEntity(const uint32& entityID, const AABB& entityAABB)
+	{
+		struct TaskExecuter {
+
+			//nodes holding only height fields are terminated when their last other entity leaves, so none are left empty here
+			void eraseFromNode(Octree* octree, const uint16& nodeIndex, const uint32& entityID, const AABB& entityAABB, byte depth)
+			{
+				if (depth == octree->depth) {
+					octree->nodes[nodeIndex].entities.eraseData(entityID);
+					return;
+				}
+
+				++depth;
+				for (byte x = 0; x < 8; ++x) {
+					if (isAValidIndex(octree->nodes[nodeIndex].children[x].first)) {
+						uint16 childIndex = octree->nodes[nodeIndex].children[x].second;
+						if (octree->nodes[childIndex].bound.intersects(entityAABB)) {
+							eraseFromNode(octree, childIndex, entityID, entityAABB, depth);
+						}
+					}
+				}
+			}
+		};
+
+		TaskExecuter ex;
+		if (this->nodes.empty() == false && this->nodes[0].bound.intersects(entityAABB)) {
+			ex.eraseFromNode(this, 0, entityID, entityAABB, 0);
+		}
+	}
+
 	bool Octree::isNodeEmpty(const uint16& index)
 	{
-		return this->nodes[index].entities.empty() || (this->nodes[index].entities.size() == 1 && this->nodes[index].entities.find(this->heightFieldLink->heightFieldID));
+		return this->nodes[index].entities.empty() || this->heightFieldLink->holdsOnlyHeightFields(this->nodes[index].entities);
 	}
 
 	void Octree::terminateNode(const uint16& index)
@@ -37,7 +37,8 @@ namespace mech {
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct OctreeToHeightFieldLink {
 		uint32 heightFieldID = -1;
-		virtual bool intersects(const AABB& aabb) = 0;
+		virtual void addHeightFields(const AABB& nodeBound, HashTable<uint32, uint16>& entities) = 0; //inserts the height fields a new node overlaps
+		virtual bool holdsOnlyHeightFields(const HashTable<uint32, uint16>& entities) = 0;
 	};
 
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -66,6 +67,8 @@ namespace mech {
 		StackArray<uint16, 8> addEntity(const uint32& entityID, const AABB& entityAABB); //returns indicies at which nodes containing component are located
 		void updateEntityDiscrete(const uint32& entityID, const AABB& entityAABB, StackArray<uint16, 8>& referenceNodes);
 		void updateEntityContinous(const uint32& entityID, const AABB& entityAABB, StackArray<uint16, 8>& referenceNodes);
+		void addStaticEntity(const uint32& entityID, const AABB& entityAABB); //inserts the entity into the existing nodes it overlaps, nodes created later get it from the heightFieldLink
+		void eraseStaticEntity(const uint32& entityID, const AABB& entityAABB);
 		bool isNodeEmpty(const uint16& index);
 		void terminateNode(const uint16& index);
 	};
@@ -31,8 +31,11 @@
 #include"octree.h"
 #include"physicsObject.h"
 #include"collision/collider.h"
+#include"collisionFilter.h"
+#include"tiledHeightField.h"
 #include"constraints/constraints.h"
 #include"../containers/AVLTree.h"
+#include"../containers/ringBuffer.h"
 
 namespace mech {
 
@@ -46,59 +49,149 @@ namespace mech {
 		byte velocityIterations = 5;
 		byte positionIterations = 3;
 		byte framesToRetainCache = 10;
+		uint32 gjkVertexThreshold = 32; //hulls with at least this many vertices use GJK/EPA instead of SAT
+		decimal contactBreakingDistance = decimal(0.02); //persistent contact points that separate or slide further than this are dropped
+		decimal contactRotationTolerance = decimal(0.9998); //cosine of half the relative rotation after which a persistent manifold is rebuilt
+		bool persistentManifolds = true;
+		uint32 maxTOIEvents = 256; //time of impact events handled per step, bodies past the budget fall back to speculative contacts
+		uint32 maxTOIIterations = 20000; //root finder iterations spent per step on time of impact queries
+		bool speculativeContacts = false; //every body uses speculative contacts instead of time of impact sub-stepping, see RigidBody::setSpeculativeContacts for single bodies
+		uint32 contactEventCapacity = 1024; //contact events kept until they are read, the oldest are overwritten once the buffer is full
 	};
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	class PhysicsData {
+	//counters are reset at the start of every PhysicsWorld::update
+	struct PhysicsStatistics {
+		uint32 hullVsHullCacheHits = 0; //pairs resolved from the cached axis / cached faces
+		uint32 hullVsHullCacheMisses = 0; //pairs that needed a full SAT query
+		uint32 gjkQueries = 0; //convex pairs routed through GJK/EPA
+		uint32 epaQueries = 0;
+		uint32 persistentManifoldHits = 0; //pairs whose contacts were refreshed without running the narrowphase
+		uint32 persistentManifoldRebuilds = 0;
+		uint32 speculativeContacts = 0; //contact points generated ahead of an impact
+		uint32 toiEvents = 0; //impacts the continous collision detection advanced bodies to
+		uint32 toiIterations = 0;
+		uint32 toiFallbacks = 0; //fast bodies handled with speculative contacts because the budget ran out
+		uint32 contactEventsOverwritten = 0; //contact events lost because the buffer was full
+	};
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class SensorEventType : byte { enter = 0, stay = 1, exit = 2 };
 
-	private:
+	//see SensorDetector
+	struct SensorEvent {
+		uint32 sensorID = -1;
+		uint32 colliderID = -1; //a compound is reported as a whole
+		SensorEventType type = SensorEventType::enter;
 
-		const AABB& (PhysicsData::* mAABBPtrs[5]) (const uint32&) = {};
-		void (PhysicsData::* mErasePtrs[5]) (const uint32&) = {};
+		SensorEvent() {}
+		SensorEvent(const uint32& sensor, const uint32& collider, const SensorEventType& t) : sensorID(sensor), colliderID(collider), type(t) {}
+	};
 
-		const AABB& convexHullAABB(const uint32& colliderIndex) { return this->convexHullColliders[colliderIndex].bound; }
-		const AABB& sphereAABB(const uint32& colliderIndex) { return this->sphereColliders[colliderIndex].bound; }
-		const AABB& capsuleAABB(const uint32& colliderIndex) { return this->capsuleColliders[colliderIndex].bound; }
-		const AABB& compoundAABB(const uint32& colliderIndex) { return this->compoundColliders[colliderIndex].bound; }
-		const AABB& triangleMeshAABB(const uint32& colliderIndex) { return this->triangleMeshColliders[colliderIndex].bound; }
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class ContactEventType : byte { begin = 0, persist = 1, end = 2 };
+
+	//see ContactEventRecorder
+	struct ContactEvent {
+		Vec3 point = nanVEC3; //average of the contact points
+		Vec3 normal = nanVEC3; //points from the first collider to the second
+		decimal impulse = decimal(0.0); //sum of the normal impulses the solver applied this step
+		uint32 colliderID1 = -1; //a compound is reported as a whole
+		uint32 colliderID2 = -1;
+		ContactEventType type = ContactEventType::begin;
+
+		ContactEvent() {}
+	};
 
-		void eraseConvexHull(const uint32& colliderIndex) { this->convexHullColliders.eraseDataAtIndex(colliderIndex); }
-		void eraseSphere(const uint32& colliderIndex) { this->sphereColliders.eraseDataAtIndex(colliderIndex); }
-		void eraseCapsule(const uint32& colliderIndex) { this->capsuleColliders.eraseDataAtIndex(colliderIndex); }
-		void eraseCompoundCollider(const uint32& colliderIndex) { this->compoundColliders.eraseDataAtIndex(colliderIndex); }
-		void eraseTriangleMesh(const uint32& colliderIndex) { this->triangleMeshColliders.eraseDataAtIndex(colliderIndex); }
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	class PhysicsData {
 
 	public:
 
-		PhysicsData()
-		{
-			this->mAABBPtrs[0] = &PhysicsData::convexHullAABB;
-			this->mAABBPtrs[1] = &PhysicsData::sphereAABB;
-			this->mAABBPtrs[2] = &PhysicsData::capsuleAABB;
-			this->mAABBPtrs[3] = &PhysicsData::compoundAABB;
-			this->mAABBPtrs[4] = &PhysicsData::triangleMeshAABB;
-
-			this->mErasePtrs[0] = &PhysicsData::eraseConvexHull;
-			this->mErasePtrs[1] = &PhysicsData::eraseSphere;
-			this->mErasePtrs[2] = &PhysicsData::eraseCapsule;
-			this->mErasePtrs[3] = &PhysicsData::eraseCompoundCollider;
-			this->mErasePtrs[4] = &PhysicsData::eraseTriangleMesh;
-		}
+		PhysicsData() {}
 
 		PhysicsData(const PhysicsData&) = delete;
 		PhysicsData& operator=(const PhysicsData&) = delete;
 
 		const AABB& getColliderAABB(const uint32& id)
 		{
-			return (this->*mAABBPtrs[(uint32)(this->colliderIdentifiers[id].type)])(this->colliderIdentifiers[id].colliderIndex);
+			const ColliderIdentifier& identifier = this->colliderIdentifiers[id];
+			switch (identifier.type) {
+			case ColliderType::convexHull: return this->convexHullColliders[identifier.colliderIndex].bound;
+			case ColliderType::sphere: return this->sphereColliders[identifier.colliderIndex].bound;
+			case ColliderType::capsule: return this->capsuleColliders[identifier.colliderIndex].bound;
+			case ColliderType::compound: return this->compoundColliders[identifier.colliderIndex].bound;
+			case ColliderType::box: return this->boxColliders[identifier.colliderIndex].bound;
+			default: break;
+			}
+			ASSERT(identifier.type == ColliderType::triangleMesh, "collider has no bound");
+			return this->triangleMeshColliders[identifier.colliderIndex].bound;
+		}
+
+		//forgets the contacts cached for a pair, the components of a compound are paired on their own
+		void eraseContactCaches(const uint32& id1, const uint32& id2)
+		{
+			const ColliderIdentifier& identifier2 = this->colliderIdentifiers[id2];
+			if (identifier2.type == ColliderType::compound) {
+				const CompoundCollider& compoundCollider = this->compoundColliders[identifier2.colliderIndex];
+				for (byte x = 0, len = compoundCollider.components.size(); x < len; ++x) {
+					this->eraseContactCaches(id1, compoundCollider.components[x]);
+				}
+			}
+
+			uint32 manifoldID = pairingFunction(id1, id2);
+			this->contactImpulseCache.eraseData(Pair<uint32, ContactConstraint::ImpulseCache>(manifoldID));
+			this->hullVsHullContactCache.eraseData(Pair<uint32, HullVsHullContactCache>(manifoldID));
+			this->gjkContactCache.eraseData(Pair<uint32, GJKContactCache>(manifoldID));
+			this->persistentManifolds.eraseData(Pair<uint32, PersistentManifold>(manifoldID));
+		}
+
+		//forgets everything kept for the pairs a motionless collider formed so its id can be reused, only bodies pair with it
+		void eraseStaticPairs(const uint32& id)
+		{
+			for (auto it = this->physicsObjects.begin(), end = this->physicsObjects.end(); it != end; ++it) {
+
+				uint32 bodyID = it.data().rigidBody.colliderID;
+				this->eraseContactCaches(id, bodyID);
+
+				HybridArray<uint32, 4, byte> ids;
+				ids.pushBack(bodyID);
+				const ColliderIdentifier& identifier = this->colliderIdentifiers[bodyID];
+				if (identifier.type == ColliderType::compound) {
+					const CompoundCollider& compoundCollider = this->compoundColliders[identifier.colliderIndex];
+					for (byte x = 0, len = compoundCollider.components.size(); x < len; ++x) {
+						ids.pushBack(compoundCollider.components[x]);
+					}
+				}
+
+				for (byte x = 0, len = ids.size(); x < len; ++x) {
+					this->finishedCollisions.eraseData(Pair<uint32, CollisionFlag>(pairingFunction(id, ids[x])));
+					this->contactPairs.eraseData(Pair<uint64, bool>(CollisionFilter::getPairKey(id, ids[x])));
+				}
+			}
+
+			this->collisionFilter.eraseCollider(id);
 		}
 
 		void erase(const uint32& id)
 		{ 
-			if (this->colliderIdentifiers[id].state == ColliderMotionState::dynamic) {
-				this->physicsObjects.eraseDataAtIndex(this->colliderIdentifiers[id].objectIndex);
+			const ColliderIdentifier& identifier = this->colliderIdentifiers[id];
+			if (identifier.state != ColliderMotionState::motionless) {
+				this->physicsObjects.eraseDataAtIndex(identifier.objectIndex);
+			}
+			switch (identifier.type) {
+			case ColliderType::convexHull: this->convexHullColliders.eraseDataAtIndex(identifier.colliderIndex); break;
+			case ColliderType::sphere: this->sphereColliders.eraseDataAtIndex(identifier.colliderIndex); break;
+			case ColliderType::capsule: this->capsuleColliders.eraseDataAtIndex(identifier.colliderIndex); break;
+			case ColliderType::compound: this->compoundColliders.eraseDataAtIndex(identifier.colliderIndex); break;
+			case ColliderType::box: this->boxColliders.eraseDataAtIndex(identifier.colliderIndex); break;
+			case ColliderType::triangleMesh: this->triangleMeshColliders.eraseDataAtIndex(identifier.colliderIndex); break;
+			default: break;
+			}
+			if (identifier.isSensor) {
+				this->sensors.eraseData(id);
 			}
-			(this->*mErasePtrs[(uint32)(this->colliderIdentifiers[id].type)])(this->colliderIdentifiers[id].colliderIndex);
+			this->collisionFilter.eraseCollider(id);
 			this->colliderIdentifiers.eraseDataAtIndex(id);
 		}
 
@@ -112,22 +205,35 @@ namespace mech {
 		RigidArray<AVLTree<uint32, uint32>, uint16> islands; //RigidArray<AVLTree<colliderID, ............
 
 		HeightFieldCollider heightFieldCollider;
+		TiledHeightField tiledHeightField; //resident tiles are height field colliders whose colliderIndex is their slot
 		RigidArray<ConvexHullCollider, uint32> convexHullColliders;
 		RigidArray<SphereCollider, uint32> sphereColliders;
 		RigidArray<CapsuleCollider, uint32> capsuleColliders;
 		RigidArray<CompoundCollider, uint32> compoundColliders;
+		RigidArray<BoxCollider, uint32> boxColliders;
 		RigidArray<TriangleMeshCollider, uint32> triangleMeshColliders;
 
 		DynamicArray<ContactConstraint, uint32> contactConstraints;
 		HashTable<Pair<uint32, ContactConstraint::ImpulseCache>, uint32> contactImpulseCache; //HashTable<Pair<manifoldID, ContactConstraint::ImpulseCache>............
 		HashTable<Pair<uint32, HullVsHullContactCache>, uint32> hullVsHullContactCache; //HashTable<Pair<manifoldID, HullVsHullContactCache>............
+		HashTable<Pair<uint32, GJKContactCache>, uint32> gjkContactCache; //HashTable<Pair<manifoldID, GJKContactCache>............
+		HashTable<Pair<uint32, PersistentManifold>, uint32> persistentManifolds; //HashTable<Pair<manifoldID, PersistentManifold>............
+		CollisionFilter collisionFilter;
 		HashTable<Pair<uint32, CollisionFlag>, uint32> finishedCollisions; //HashTable<Pair<manifoldID, CollisionFlag>............
+		HashTable<uint32, uint32> sensors; //collider ids of the sensors, they are not in the octree
+		HashTable<Pair<uint64, bool>, uint32> sensorOverlaps; //HashTable<Pair<(sensor ID << 32) | collider ID, found this step>............
+		DynamicArray<SensorEvent, uint32> sensorEvents; //refilled by every PhysicsWorld::update
+		HashTable<Pair<uint64, bool>, uint32> contactPairs; //HashTable<Pair<CollisionFilter::getPairKey(...), touched this step>............ pairs that report contact events
+		RingBuffer<ContactEvent, uint32> contactEvents;
+		DynamicArray<uint32, uint32> continousBodies; //object indices of the bodies waiting for continous collision detection
 
 		RigidArray<HingeConstraint, uint16> hingeConstraints;
 		RigidArray<ConeConstraint, uint16> coneConstraints;
 		RigidArray<MotorConstraint, uint16> motorConstraints;
 
 		PhysicsSettings settings;
+		PhysicsStatistics statistics;
+		decimal deltaTime = decimal(0.0); //duration of the step in progress
 	};
 }
 
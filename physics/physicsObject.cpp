@@ -31,12 +31,6 @@
 
 namespace mech {
 
-	void PhysicsObject::diableCollision(PhysicsData* physicsData, const uint32& otherID)
-	{
-		this->disabledCollisions.pushBack(otherID);
-		physicsData->physicsObjects[physicsData->colliderIdentifiers[otherID].objectIndex].disabledCollisions.pushBack(this->rigidBody.colliderID);
-	}
-
 	void PhysicsObject::addToIsland(PhysicsData* physicsData, const uint32& otherID)
 	{
 		PhysicsObject& otherObject = physicsData->physicsObjects[physicsData->colliderIdentifiers[otherID].objectIndex];
@@ -69,6 +63,19 @@ namespace mech {
 		}
 	}
 
+	//wakes the whole island, a body woken on its own would be put back to sleep by the rest
+	void PhysicsObject::wakeUp(PhysicsData* physicsData)
+	{
+		if (isAValidIndex(this->islandIndex)) {
+			for (auto it = physicsData->islands[this->islandIndex].begin(), end = physicsData->islands[this->islandIndex].end(); it != end; ++it) {
+				physicsData->physicsObjects[physicsData->colliderIdentifiers[it.data()].objectIndex].rigidBody.activate();
+			}
+		}
+		else {
+			this->rigidBody.activate();
+		}
+	}
+
 	void PhysicsObject::initialise(PhysicsData* physicsData, const const uint32& id, const decimal& mass, const Mat3x3& tensor, const Transform3D& offset)
 	{
 		this->rigidBody.colliderID = id;
@@ -76,7 +83,5 @@ namespace mech {
 		this->rigidBody.setTensor(tensor);
 		this->rigidBody.setMass(mass);
 		this->rigidBody.setTransform(offset);
-
-		this->disabledCollisions.pushBack(id);
 	}
 }
@@ -37,14 +37,13 @@ namespace mech {
 
 		RigidBody rigidBody;
 		StackArray<uint16, 8> nodesIntersected; //StackArray<node index, ...
-		StackArray<uint32, 4> disabledCollisions; //StackArray<collider ID, ...
 		uint32 islandIndex = -1;
 
 		PhysicsObject() {}
 
 		void initialise(PhysicsData* physicsData, const uint32& id, const decimal& mass, const Mat3x3& tensor, const Transform3D& offset);
-		void diableCollision(PhysicsData* physicsData, const uint32& otherID);
 		void addToIsland(PhysicsData* physicsData, const uint32& otherID);
+		void wakeUp(PhysicsData* physicsData);
 	};
 }
 
@@ -45,15 +45,26 @@ namespace mech {
 		
 		this->mCacheManager.physicsData = &this->mPhysicsData;
 
+		this->mSensorDetector.physicsData = &this->mPhysicsData;
+
+		this->mContactEventRecorder.physicsData = &this->mPhysicsData;
+
+		this->mSceneQuery.physicsData = &this->mPhysicsData;
+
 		this->mPhysicsData.settings.rigidBodySettings = getRigidBodySettings();
 
-		this->mHeightFieldTest.heightField = &this->mPhysicsData.heightFieldCollider.collider;
+		this->mHeightFieldTest.physicsData = &this->mPhysicsData;
 	}
 	
 	void PhysicsWorld::update(const decimal& deltaTime)
 	{
 		BEGIN_PROFILE("PhysicsWorld::update");
 
+		this->mPhysicsData.statistics = PhysicsStatistics();
+		this->mPhysicsData.deltaTime = deltaTime;
+
+		this->streamHeightFieldTiles();
+
 		for (auto it = this->mPhysicsData.physicsObjects.begin(), end = this->mPhysicsData.physicsObjects.end(); it != end;) {
 
 			BEGIN_PROFILE("PhysicsObjectUpdateLoop");
@@ -75,7 +86,11 @@ namespace mech {
 			END_PROFILE;
 		}
 
+		this->mBroadPhase.resolveTimeOfImpactEvents(deltaTime);
+
 		this->mConstraintSolver.solve(deltaTime);
+		this->mContactEventRecorder.update();
+		this->mSensorDetector.update();
 		this->mCacheManager.update();
 
 #if mech_ENABLE_DEBUG_RENDERER
@@ -84,6 +99,10 @@ namespace mech {
 			DEBUG_RENDERER_ADD(it.data().bound, BLACK);
 		}
 
+		for (auto it = this->mPhysicsData.compoundColliders.begin(), end = this->mPhysicsData.compoundColliders.end(); it != end; ++it) {
+			refreshComponents(&this->mPhysicsData, it.data());
+			DEBUG_RENDERER_ADD(it.data().bound, BLUE);
+		}
 		for (auto it = this->mPhysicsData.convexHullColliders.begin(), end = this->mPhysicsData.convexHullColliders.end(); it != end; ++it) {
 			DEBUG_RENDERER_ADD(it.data().bound, BLUE);
 		}
@@ -93,7 +112,7 @@ namespace mech {
 		for (auto it = this->mPhysicsData.capsuleColliders.begin(), end = this->mPhysicsData.capsuleColliders.end(); it != end; ++it) {
 			DEBUG_RENDERER_ADD(it.data().bound, BLUE);
 		}
-		for (auto it = this->mPhysicsData.compoundColliders.begin(), end = this->mPhysicsData.compoundColliders.end(); it != end; ++it) {
+		for (auto it = this->mPhysicsData.boxColliders.begin(), end = this->mPhysicsData.boxColliders.end(); it != end; ++it) {
 			DEBUG_RENDERER_ADD(it.data().bound, BLUE);
 		}
 		for (auto it = this->mPhysicsData.triangleMeshColliders.begin(), end = this->mPhysicsData.triangleMeshColliders.end(); it != end; ++it) {
@@ -138,6 +157,70 @@ namespace mech {
 		physicsData->colliderIdentifiers[colliderID].objectIndex = objectIndex;
 		physicsData->colliderIdentifiers[colliderID].material = material;
 		physicsData->colliderIdentifiers[colliderID].state = state;
+
+		if (state == ColliderMotionState::kinematic) {
+			physicsData->physicsObjects[objectIndex].rigidBody.makeKinematic();
+		}
+	}
+
+	bool PhysicsWorld::initialiseTiledHeightField(const char* path, const TiledHeightFieldSettings& settings, const PhysicsMaterial& material)
+	{
+		return this->mPhysicsData.tiledHeightField.open(path, settings, material);
+	}
+
+	//maps in the tiles around every body before they move, a tile is only evicted once the budget is reached and it was not needed this frame
+	void PhysicsWorld::streamHeightFieldTiles()
+	{
+		TiledHeightField& tiledHeightField = this->mPhysicsData.tiledHeightField;
+		if (tiledHeightField.isOpen() == false) return;
+
+		BEGIN_PROFILE("PhysicsWorld::streamHeightFieldTiles");
+
+		++tiledHeightField.frame;
+		decimal margin = tiledHeightField.settings.streamingMargin;
+
+		for (auto it = this->mPhysicsData.physicsObjects.begin(), end = this->mPhysicsData.physicsObjects.end(); it != end; ++it) {
+
+			AABB aabb = this->mPhysicsData.getColliderAABB(it.data().rigidBody.colliderID);
+			aabb.min -= Vec3(margin, margin, margin);
+			aabb.max += Vec3(margin, margin, margin);
+
+			HybridArray<uint32, 16, uint32> tileIndices;
+			tiledHeightField.getTilesOverlapped(aabb, tileIndices);
+
+			for (auto it2 = tileIndices.begin(), end2 = tileIndices.end(); it2 != end2; ++it2) {
+
+				uint32 slot = tiledHeightField.findSlot(it2.data());
+				if (isAValidIndex(slot) == false) {
+
+					if (tiledHeightField.freeSlots.empty()) {
+
+						uint32 candidate = tiledHeightField.getEvictionCandidate();
+						ASSERT(isAValidIndex(candidate), "every resident tile is near a body, raise TiledHeightFieldSettings::maxResidentTiles");
+						if (isAValidIndex(candidate) == false) continue;
+
+						TiledHeightField::Tile& evicted = tiledHeightField.tiles[candidate];
+						this->mPhysicsData.octree.eraseStaticEntity(evicted.colliderID, evicted.bound);
+						this->mPhysicsData.eraseStaticPairs(evicted.colliderID);
+						this->mPhysicsData.colliderIdentifiers.eraseDataAtIndex(evicted.colliderID);
+						tiledHeightField.evict(candidate);
+					}
+
+					slot = tiledHeightField.load(it2.data());
+					if (isAValidIndex(slot) == false) continue;
+
+					uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::heightField));
+					setUp(&this->mPhysicsData, colliderID, slot, -1, tiledHeightField.material, ColliderMotionState::motionless);
+
+					tiledHeightField.tiles[slot].colliderID = colliderID;
+					this->mPhysicsData.octree.addStaticEntity(colliderID, tiledHeightField.tiles[slot].bound);
+				}
+
+				tiledHeightField.tiles[slot].lastUsed = tiledHeightField.frame;
+			}
+		}
+
+		END_PROFILE;
 	}
 
 	uint32 PhysicsWorld::addSphere(const Sphere& sphere, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset)
@@ -148,7 +231,7 @@ namespace mech {
 		this->mPhysicsData.sphereColliders[colliderIndex].transform(offset);
 
 		uint32 objectIndex = -1;
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			objectIndex = this->mPhysicsData.physicsObjects.insert(PhysicsObject());
 			decimal mass = material.density * this->mPhysicsData.sphereColliders[colliderIndex].getVolume();
 			this->mPhysicsData.physicsObjects[objectIndex].initialise(&this->mPhysicsData, colliderID, mass, calculateTensor(mass, this->mPhysicsData.sphereColliders[colliderIndex].collider), offset);
@@ -157,7 +240,7 @@ namespace mech {
 		setUp(&this->mPhysicsData, colliderID, colliderIndex, objectIndex, material, state);
 
 		StackArray<uint16, 8> nodes = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			this->mPhysicsData.physicsObjects[objectIndex].nodesIntersected = nodes;
 		}
 
@@ -172,7 +255,7 @@ namespace mech {
 		this->mPhysicsData.capsuleColliders[colliderIndex].transform(offset);
 
 		uint32 objectIndex = -1;
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			objectIndex = this->mPhysicsData.physicsObjects.insert(PhysicsObject());
 			this->mPhysicsData.physicsObjects[objectIndex].initialise(&this->mPhysicsData, colliderID, material.density * this->mPhysicsData.capsuleColliders[colliderIndex].getVolume(), calculateTensor(material.density, this->mPhysicsData.capsuleColliders[colliderIndex].collider), offset);
 		}
@@ -180,7 +263,7 @@ namespace mech {
 		setUp(&this->mPhysicsData, colliderID, colliderIndex, objectIndex, material, state);
 
 		StackArray<uint16, 8> nodes = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			this->mPhysicsData.physicsObjects[objectIndex].nodesIntersected = nodes;
 		}
 
@@ -195,7 +278,7 @@ namespace mech {
 		this->mPhysicsData.convexHullColliders[colliderIndex].transform(offset);
 
 		uint32 objectIndex = -1;
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			objectIndex = this->mPhysicsData.physicsObjects.insert(PhysicsObject());
 			decimal mass = material.density * this->mPhysicsData.convexHullColliders[colliderIndex].getVolume();
 			this->mPhysicsData.physicsObjects[objectIndex].initialise(&this->mPhysicsData, colliderID, mass, calculateTensor(mass, this->mPhysicsData.convexHullColliders[colliderIndex].collider.vertices.toDynamicArray()), offset);
@@ -204,7 +287,31 @@ namespace mech {
 		setUp(&this->mPhysicsData, colliderID, colliderIndex, objectIndex, material, state);
 
 		StackArray<uint16, 8> nodes = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
+			this->mPhysicsData.physicsObjects[objectIndex].nodesIntersected = nodes;
+		}
+
+		return colliderID;
+	}
+
+	uint32 PhysicsWorld::addBox(const OBB& box, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset)
+	{
+		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::box));
+		uint32 colliderIndex = this->mPhysicsData.boxColliders.insert(BoxCollider(box));
+
+		this->mPhysicsData.boxColliders[colliderIndex].transform(offset);
+
+		uint32 objectIndex = -1;
+		if (state != ColliderMotionState::motionless) {
+			objectIndex = this->mPhysicsData.physicsObjects.insert(PhysicsObject());
+			decimal mass = material.density * this->mPhysicsData.boxColliders[colliderIndex].getVolume();
+			this->mPhysicsData.physicsObjects[objectIndex].initialise(&this->mPhysicsData, colliderID, mass, calculateTensor(mass, box), offset);
+		}
+
+		setUp(&this->mPhysicsData, colliderID, colliderIndex, objectIndex, material, state);
+
+		StackArray<uint16, 8> nodes = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
+		if (state != ColliderMotionState::motionless) {
 			this->mPhysicsData.physicsObjects[objectIndex].nodesIntersected = nodes;
 		}
 
@@ -213,18 +320,143 @@ namespace mech {
 
 	uint32 PhysicsWorld::addTriangleMesh(const TriangleMesh& mesh, const ColliderMotionState& state, const PhysicsMaterial& material)
 	{
-		ASSERT(state == ColliderMotionState::motionless, "dynamic triangle meshes are not supported!!");
+		ASSERT(state == ColliderMotionState::motionless, "dynamic triangle meshes are not supported, move them with setTriangleMeshTransform!!");
 
 		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::triangleMesh));
 		uint32 colliderIndex = this->mPhysicsData.triangleMeshColliders.insert(TriangleMeshCollider(mesh));
 
 		setUp(&this->mPhysicsData, colliderID, colliderIndex, -1, material, state);
 
-		StackArray<uint16, 8> nodes = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
+		this->mPhysicsData.triangleMeshColliders[colliderIndex].nodesIntersected = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
 		
 		return colliderID;
 	}
 
+	//contacts against the old pose or shape of a mesh are dropped and the bodies around it woken, both where it was and where it is now
+	void releaseMeshContacts(PhysicsData* physicsData, const uint32& meshID, const StackArray<uint16, 8>& nodesIntersected)
+	{
+		for (byte x = 0, len = nodesIntersected.size(); x < len; ++x) {
+
+			Octree::Node& node = physicsData->octree.nodes[nodesIntersected[x]];
+			for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
+
+				const ColliderIdentifier& identifier = physicsData->colliderIdentifiers[it.data()];
+				if (identifier.state == ColliderMotionState::motionless) continue;
+
+				physicsData->eraseContactCaches(meshID, it.data());
+				physicsData->physicsObjects[identifier.objectIndex].wakeUp(physicsData);
+			}
+		}
+	}
+
+	void PhysicsWorld::setTriangleMeshTransform(const uint32& id, const Transform3D& transform)
+	{
+		ASSERT(this->mPhysicsData.colliderIdentifiers[id].type == ColliderType::triangleMesh, "collider is not a triangle mesh");
+
+		TriangleMeshCollider& collider = this->mPhysicsData.triangleMeshColliders[this->mPhysicsData.colliderIdentifiers[id].colliderIndex];
+		releaseMeshContacts(&this->mPhysicsData, id, collider.nodesIntersected);
+
+		collider.setTransform(transform);
+		this->mPhysicsData.octree.updateEntityDiscrete(id, collider.bound, collider.nodesIntersected);
+
+		releaseMeshContacts(&this->mPhysicsData, id, collider.nodesIntersected);
+	}
+
+	void PhysicsWorld::deformTriangleMesh(const uint32& id, const decimal* triangleData)
+	{
+		ASSERT(this->mPhysicsData.colliderIdentifiers[id].type == ColliderType::triangleMesh, "collider is not a triangle mesh");
+
+		TriangleMeshCollider& collider = this->mPhysicsData.triangleMeshColliders[this->mPhysicsData.colliderIdentifiers[id].colliderIndex];
+		releaseMeshContacts(&this->mPhysicsData, id, collider.nodesIntersected);
+
+		collider.collider.refit(triangleData);
+		if (collider.collider.needsRebuild()) {
+			collider.collider.rebuild(triangleData);
+		}
+
+		collider.updateBound();
+		this->mPhysicsData.octree.updateEntityDiscrete(id, collider.bound, collider.nodesIntersected);
+
+		releaseMeshContacts(&this->mPhysicsData, id, collider.nodesIntersected);
+	}
+
+	void setUpSensor(PhysicsData* physicsData, const uint32& colliderID, const uint32& colliderIndex)
+	{
+		setUp(physicsData, colliderID, colliderIndex, -1, PhysicsMaterial(), ColliderMotionState::motionless);
+		physicsData->colliderIdentifiers[colliderID].isSensor = true;
+		physicsData->sensors.insert(colliderID);
+	}
+
+	uint32 PhysicsWorld::addSensor(const Sphere& sphere, const Transform3D& offset)
+	{
+		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::sphere));
+		uint32 colliderIndex = this->mPhysicsData.sphereColliders.insert(SphereCollider(sphere));
+		this->mPhysicsData.sphereColliders[colliderIndex].transform(offset);
+
+		setUpSensor(&this->mPhysicsData, colliderID, colliderIndex);
+		return colliderID;
+	}
+
+	uint32 PhysicsWorld::addSensor(const Capsule& capsule, const Transform3D& offset)
+	{
+		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::capsule));
+		uint32 colliderIndex = this->mPhysicsData.capsuleColliders.insert(CapsuleCollider(capsule));
+		this->mPhysicsData.capsuleColliders[colliderIndex].transform(offset);
+
+		setUpSensor(&this->mPhysicsData, colliderID, colliderIndex);
+		return colliderID;
+	}
+
+	uint32 PhysicsWorld::addSensor(const ConvexHull& convexHull, const Transform3D& offset)
+	{
+		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::convexHull));
+		uint32 colliderIndex = this->mPhysicsData.convexHullColliders.insert(ConvexHullCollider(convexHull));
+		this->mPhysicsData.convexHullColliders[colliderIndex].transform(offset);
+
+		setUpSensor(&this->mPhysicsData, colliderID, colliderIndex);
+		return colliderID;
+	}
+
+	uint32 PhysicsWorld::addSensor(const OBB& box, const Transform3D& offset)
+	{
+		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::box));
+		uint32 colliderIndex = this->mPhysicsData.boxColliders.insert(BoxCollider(box));
+		this->mPhysicsData.boxColliders[colliderIndex].transform(offset);
+
+		setUpSensor(&this->mPhysicsData, colliderID, colliderIndex);
+		return colliderID;
+	}
+
+	void PhysicsWorld::setCollisionLayer(const uint32& id, const byte& layer, const uint32& layerMask)
+	{
+		ASSERT(layer < MAXIMUM_COLLISION_LAYERS, "invalid collision layer");
+
+		ColliderIdentifier& identifier = this->mPhysicsData.colliderIdentifiers[id];
+		identifier.layer = layer;
+		identifier.layerMask = layerMask;
+
+		if (identifier.type == ColliderType::compound) {
+			const CompoundCollider& compound = this->mPhysicsData.compoundColliders[identifier.colliderIndex];
+			for (byte x = 0, len = compound.components.size(); x < len; ++x) {
+				this->mPhysicsData.colliderIdentifiers[compound.components[x]].layer = layer;
+				this->mPhysicsData.colliderIdentifiers[compound.components[x]].layerMask = layerMask;
+			}
+		}
+	}
+
+	void PhysicsWorld::setContactReporting(const uint32& id, const bool& reportsContacts)
+	{
+		ColliderIdentifier& identifier = this->mPhysicsData.colliderIdentifiers[id];
+		identifier.reportsContacts = reportsContacts;
+
+		if (identifier.type == ColliderType::compound) {
+			const CompoundCollider& compound = this->mPhysicsData.compoundColliders[identifier.colliderIndex];
+			for (byte x = 0, len = compound.components.size(); x < len; ++x) {
+				this->mPhysicsData.colliderIdentifiers[compound.components[x]].reportsContacts = reportsContacts;
+			}
+		}
+	}
+
 	uint32 PhysicsWorld::addCompoundCollider(const DynamicArray<Pair<ConvexHull, Transform3D>, uint32> convexHulls, const DynamicArray<Pair<Sphere, Transform3D>, uint32> spheres, const DynamicArray<Pair<Capsule, Transform3D>, uint32> capsules, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset)
 	{
 		uint32 colliderID = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::compound));
@@ -236,79 +468,76 @@ namespace mech {
 		/////////////////////////////////////////////////////////////
 
 		uint32 objectIndex = -1;
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			objectIndex = this->mPhysicsData.physicsObjects.insert(PhysicsObject());
 			this->mPhysicsData.colliderIdentifiers[colliderID].objectIndex = objectIndex;
 		}
 
-		this->mPhysicsData.compoundColliders[colliderIndex].bound = AABB(offset.position, offset.position);
+		this->mPhysicsData.compoundColliders[colliderIndex].worldTransform = offset;
 		for (uint32 x = 0, len = convexHulls.size(); x < len; ++x) {
 
 			uint32 id = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::convexHull));
 			uint32 c = this->mPhysicsData.convexHullColliders.insert(ConvexHullCollider(convexHulls[x].first));
-			this->mPhysicsData.convexHullColliders[c].transform(offset * convexHulls[x].second);
+			this->mPhysicsData.convexHullColliders[c].transform(convexHulls[x].second);
+			AABB localBound = this->mPhysicsData.convexHullColliders[c].bound;
+			this->mPhysicsData.convexHullColliders[c].transform(offset);
 
 			setUp(&this->mPhysicsData, id, c, objectIndex, material, state);
-
-			this->mPhysicsData.compoundColliders[colliderIndex].bound.max = maxVec(this->mPhysicsData.compoundColliders[colliderIndex].bound.max, this->mPhysicsData.convexHullColliders[c].bound.max);
-			this->mPhysicsData.compoundColliders[colliderIndex].bound.min = minVec(this->mPhysicsData.compoundColliders[colliderIndex].bound.min, this->mPhysicsData.convexHullColliders[c].bound.min);
+			this->mPhysicsData.colliderIdentifiers[id].compoundID = colliderID;
 
 			decimal m = material.density * this->mPhysicsData.convexHullColliders[c].getVolume();
 			mass += m;
 			tensor += calculateTensor(m, this->mPhysicsData.convexHullColliders[c].collider.vertices.toDynamicArray());
 
-			this->mPhysicsData.compoundColliders[colliderIndex].components.pushBack(id);
+			this->mPhysicsData.compoundColliders[colliderIndex].addComponent(id, localBound);
 		}
 
 		for (uint32 x = 0, len = spheres.size(); x < len; ++x) {
 
 			uint32 id = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::sphere));
 			uint32 c = this->mPhysicsData.sphereColliders.insert(SphereCollider(spheres[x].first));
-			this->mPhysicsData.sphereColliders[c].transform(offset * spheres[x].second);
+			this->mPhysicsData.sphereColliders[c].transform(spheres[x].second);
+			AABB localBound = this->mPhysicsData.sphereColliders[c].bound;
+			this->mPhysicsData.sphereColliders[c].transform(offset);
 
 			setUp(&this->mPhysicsData, id, c, objectIndex, material, state);
-
-			this->mPhysicsData.compoundColliders[colliderIndex].bound.max = maxVec(this->mPhysicsData.compoundColliders[colliderIndex].bound.max, this->mPhysicsData.sphereColliders[c].bound.max);
-			this->mPhysicsData.compoundColliders[colliderIndex].bound.min = minVec(this->mPhysicsData.compoundColliders[colliderIndex].bound.min, this->mPhysicsData.sphereColliders[c].bound.min);
+			this->mPhysicsData.colliderIdentifiers[id].compoundID = colliderID;
 
 			decimal m = material.density * this->mPhysicsData.sphereColliders[c].getVolume();
 			mass += m;
 			tensor += calculateTensor(m, this->mPhysicsData.sphereColliders[c].collider);
 
-			this->mPhysicsData.compoundColliders[colliderIndex].components.pushBack(id);
+			this->mPhysicsData.compoundColliders[colliderIndex].addComponent(id, localBound);
 		}
 
 		for (uint32 x = 0, len = capsules.size(); x < len; ++x) {
 
 			uint32 id = this->mPhysicsData.colliderIdentifiers.insert(ColliderIdentifier(ColliderType::capsule));
 			uint32 c = this->mPhysicsData.capsuleColliders.insert(CapsuleCollider(capsules[x].first));
-			this->mPhysicsData.capsuleColliders[c].transform(offset * capsules[x].second);
+			this->mPhysicsData.capsuleColliders[c].transform(capsules[x].second);
+			AABB localBound = this->mPhysicsData.capsuleColliders[c].bound;
+			this->mPhysicsData.capsuleColliders[c].transform(offset);
 
 			setUp(&this->mPhysicsData, id, c, objectIndex, material, state);
-
-			this->mPhysicsData.compoundColliders[colliderIndex].bound.max = maxVec(this->mPhysicsData.compoundColliders[colliderIndex].bound.max, this->mPhysicsData.capsuleColliders[c].bound.max);
-			this->mPhysicsData.compoundColliders[colliderIndex].bound.min = minVec(this->mPhysicsData.compoundColliders[colliderIndex].bound.min, this->mPhysicsData.capsuleColliders[c].bound.min);
+			this->mPhysicsData.colliderIdentifiers[id].compoundID = colliderID;
 
 			mass += material.density * this->mPhysicsData.capsuleColliders[c].getVolume();
 			tensor += calculateTensor(material.density, this->mPhysicsData.capsuleColliders[c].collider);
 
-			this->mPhysicsData.compoundColliders[colliderIndex].components.pushBack(id);
+			this->mPhysicsData.compoundColliders[colliderIndex].addComponent(id, localBound);
 		}
 
+		this->mPhysicsData.compoundColliders[colliderIndex].buildTree();
 		this->mPhysicsData.compoundColliders[colliderIndex].convexRadius = this->mPhysicsData.compoundColliders[colliderIndex].bound.getRadius();
 
-		if (state == ColliderMotionState::dynamic) {
-			for (auto it = this->mPhysicsData.compoundColliders[colliderIndex].components.begin(), end = this->mPhysicsData.compoundColliders[colliderIndex].components.end(); it != end; ++it) {
-				this->mPhysicsData.physicsObjects[objectIndex].disabledCollisions.pushBack(it.data());
-			}
-
+		if (state != ColliderMotionState::motionless) {
 			this->mPhysicsData.physicsObjects[objectIndex].initialise(&this->mPhysicsData, colliderID, mass, tensor, offset);
 		}
 
 		setUp(&this->mPhysicsData, colliderID, colliderIndex, objectIndex, material, state);
 
 		StackArray<uint16, 8> nodes = this->mPhysicsData.octree.addEntity(colliderID, this->mPhysicsData.getColliderAABB(colliderID));
-		if (state == ColliderMotionState::dynamic) {
+		if (state != ColliderMotionState::motionless) {
 			this->mPhysicsData.physicsObjects[objectIndex].nodesIntersected = nodes;
 		}
 
@@ -31,15 +31,36 @@
 #include"constraintSolver.h"
 #include"broadPhase.h"
 #include"cacheManager.h"
+#include"sensorDetector.h"
+#include"contactEventRecorder.h"
+#include"sceneQuery.h"
 
 namespace mech {
 
 	struct HeightFieldTest : public OctreeToHeightFieldLink {
-		HeightField* heightField = nullptr;
+		PhysicsData* physicsData = nullptr;
 
-		bool intersects(const AABB& aabb) override
+		void addHeightFields(const AABB& nodeBound, HashTable<uint32, uint16>& entities) override
 		{
-			return this->heightField->intersects(aabb);
+			if (isAValidIndex(this->heightFieldID) && this->physicsData->heightFieldCollider.intersects(nodeBound)) {
+				entities.insert(this->heightFieldID);
+			}
+
+			TiledHeightField& tiledHeightField = this->physicsData->tiledHeightField;
+			for (uint32 x = 0, len = tiledHeightField.tiles.size(); x < len; ++x) {
+				const TiledHeightField::Tile& tile = tiledHeightField.tiles[x];
+				if (isAValidIndex(tile.colliderID) && tile.bound.intersects(nodeBound) && tile.collider.intersects(nodeBound)) {
+					entities.insert(tile.colliderID);
+				}
+			}
+		}
+
+		bool holdsOnlyHeightFields(const HashTable<uint32, uint16>& entities) override
+		{
+			for (auto it = entities.begin(), end = entities.end(); it != end; ++it) {
+				if (this->physicsData->colliderIdentifiers[it.data()].type != ColliderType::heightField) return false;
+			}
+			return true;
 		}
 	};
 
@@ -53,8 +74,13 @@ namespace mech {
 		NarrowPhase mNarrowPhase;
 		ConstraintSolver mConstraintSolver;
 		CacheManager mCacheManager;
+		SensorDetector mSensorDetector;
+		ContactEventRecorder mContactEventRecorder;
+		SceneQuery mSceneQuery;
 		HeightFieldTest mHeightFieldTest;
 
+		void streamHeightFieldTiles();
+
 	public:
 		PhysicsWorld();
 		PhysicsWorld(const PhysicsWorld&) = delete;
@@ -65,25 +91,66 @@ namespace mech {
 		void initialiseOctree(const AABB& bounds, const byte& depth);
 		void initialiseHeightField(BumpyTerrainParameters* parameters, const PhysicsMaterial& material);
 		void initialiseHeightField(FlatTerrainParameters* parameters, const PhysicsMaterial& material);
+		bool initialiseTiledHeightField(const char* path, const TiledHeightFieldSettings& settings, const PhysicsMaterial& material); //see TiledHeightField::write, returns false if the file could not be mapped
 
 		//colliders
 		uint32 addSphere(const Sphere& sphere, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset = Transform3D()); //returns id of the collider
 		uint32 addCapsule(const Capsule& capsule, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset = Transform3D()); //returns id of the collider
 		uint32 addConvexHull(const ConvexHull& convexHull, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset = Transform3D()); //returns id of the collider
+		uint32 addBox(const OBB& box, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset = Transform3D()); //returns id of the collider
 		uint32 addTriangleMesh(const TriangleMesh& mesh, const ColliderMotionState& state, const PhysicsMaterial& material); //returns id of the collider
+		void setTriangleMeshTransform(const uint32& id, const Transform3D& transform); //moves the mesh, its triangles stay in local space
+		void deformTriangleMesh(const uint32& id, const decimal* triangleData); //mesh has to be cooked deformable, see TriangleMesh::refit
 		uint32 addCompoundCollider(const DynamicArray<Pair<ConvexHull, Transform3D>, uint32> convexHulls, const DynamicArray<Pair<Sphere, Transform3D>, uint32> spheres, const DynamicArray<Pair<Capsule, Transform3D>, uint32> capsules, const ColliderMotionState& state, const PhysicsMaterial& material, const Transform3D& offset = Transform3D()); //returns id of the collider
 
+		//sensors, see SensorDetector. they never move and only report the moving colliders they overlap
+		uint32 addSensor(const Sphere& sphere, const Transform3D& offset = Transform3D()); //returns id of the collider
+		uint32 addSensor(const Capsule& capsule, const Transform3D& offset = Transform3D()); //returns id of the collider
+		uint32 addSensor(const ConvexHull& convexHull, const Transform3D& offset = Transform3D()); //returns id of the collider
+		uint32 addSensor(const OBB& box, const Transform3D& offset = Transform3D()); //returns id of the collider
+		const DynamicArray<SensorEvent, uint32>& getSensorEvents() const { return this->mPhysicsData.sensorEvents; } //events of the last update
+
+		//contact events, see ContactEventRecorder. events are kept across updates until they are popped, PhysicsSettings::contactEventCapacity sizes the buffer
+		void setContactReporting(const uint32& id, const bool& reportsContacts); //components of a compound follow it
+		RingBuffer<ContactEvent, uint32>& getContactEvents() { return this->mPhysicsData.contactEvents; }
+
+		//queries, see SceneQuery
+		bool raycast(const Ray& ray, const decimal& maxDistance, RaycastHit& hit, const QueryFilter& filter = QueryFilter(), const RaycastMode& mode = RaycastMode::closest) { return this->mSceneQuery.raycast(ray, maxDistance, hit, filter, mode); }
+		uint32 raycastAll(const Ray& ray, const decimal& maxDistance, DynamicArray<RaycastHit, uint32>& hits, const QueryFilter& filter = QueryFilter()) { return this->mSceneQuery.raycastAll(ray, maxDistance, hits, filter); }
+		void raycastPacket(const Ray* rays, const decimal& maxDistance, RaycastHit* hits, const QueryFilter& filter = QueryFilter(), const RaycastMode& mode = RaycastMode::closest) { this->mSceneQuery.raycastPacket(rays, maxDistance, hits, filter, mode); }
+		void raycastBatch(const Ray* rays, const uint32& numOfRays, const decimal& maxDistance, RaycastHit* hits, const QueryFilter& filter = QueryFilter(), const RaycastMode& mode = RaycastMode::closest, const byte& numOfThreads = 1) { this->mSceneQuery.raycastBatch(rays, numOfRays, maxDistance, hits, filter, mode, numOfThreads); }
+
+		//shape is a Sphere, Capsule, OBB or ConvexHull in its own space
+		template<typename Shape>
+		uint32 overlap(const Shape& shape, const Transform3D& transform, const QueryFilter& filter, uint32* colliderIDs, const uint32& maxResults) { return this->mSceneQuery.overlap(shape, transform, filter, colliderIDs, maxResults); }
+		template<typename Shape>
+		bool shapeCast(const Shape& shape, const Transform3D& from, const Vec3& to, const QueryFilter& filter, RaycastHit& hit) { return this->mSceneQuery.shapeCast(shape, from, to, filter, hit); }
+		template<typename Shape>
+		void overlapBatch(const Shape* shapes, const Transform3D* transforms, const uint32& numOfQueries, const QueryFilter& filter, uint32* colliderIDs, const uint32& maxResultsPerQuery, uint32* counts, const byte& numOfThreads = 1) { this->mSceneQuery.overlapBatch(shapes, transforms, numOfQueries, filter, colliderIDs, maxResultsPerQuery, counts, numOfThreads); }
+		template<typename Shape>
+		void shapeCastBatch(const Shape* shapes, const Transform3D* from, const Vec3* to, const uint32& numOfQueries, const QueryFilter& filter, RaycastHit* hits, const byte& numOfThreads = 1) { this->mSceneQuery.shapeCastBatch(shapes, from, to, numOfQueries, filter, hits, numOfThreads); }
+
 		//constraints
 		void addHingeConstraint(const HingeConstraint::Parameters& parameters) { this->mConstraintSolver.add(parameters); }
 		void addConeConstraint(const ConeConstraint::Parameters& parameters) { this->mConstraintSolver.add(parameters); }
 		void addMotorConstraint(const MotorConstraint::Parameters& parameters) { this->mConstraintSolver.add(parameters); }
 
+		//collision filtering, see CollisionFilter
+		void setCollisionLayer(const uint32& id, const byte& layer, const uint32& layerMask = 0xFFFFFFFF); //components of a compound follow it
+		void setLayerCollision(const byte& layer1, const byte& layer2, const bool& collide) { this->mPhysicsData.collisionFilter.setLayerCollision(layer1, layer2, collide); }
+		void ignoreCollision(const uint32& id1, const uint32& id2) { this->mPhysicsData.collisionFilter.ignorePair(id1, id2); }
+		void restoreCollision(const uint32& id1, const uint32& id2) { this->mPhysicsData.collisionFilter.restorePair(id1, id2); }
+
 		bool isObjectIntheWorld(const uint32& id) { return this->mPhysicsData.colliderIdentifiers.isIndexOccupied(id); }
 		void erase(const uint32& id) { this->mPhysicsData.erase(id); }
 
+		void setKinematicTarget(const uint32& id, const Transform3D& target) { ASSERT(isAValidIndex(this->mPhysicsData.colliderIdentifiers[id].objectIndex), "motionless colliders can not be kinematic"); this->getRigidBody(id)->setKinematicTarget(target); } //reached by the end of the next update
+		void setKinematicVelocity(const uint32& id, const Vec3& linear, const Vec3& angular) { ASSERT(isAValidIndex(this->mPhysicsData.colliderIdentifiers[id].objectIndex), "motionless colliders can not be kinematic"); this->getRigidBody(id)->setKinematicVelocity(linear, angular); }
+
 		RigidBody* getRigidBody(const uint32& id) { return &this->mPhysicsData.physicsObjects[this->mPhysicsData.colliderIdentifiers[id].objectIndex].rigidBody; }
 		const ColliderIdentifier* getColliderIdentifier(const uint32& id) { return &this->mPhysicsData.colliderIdentifiers[id]; }
 		PhysicsSettings* getPhysicsSettings() { return &this->mPhysicsData.settings; }
+		const PhysicsStatistics* getPhysicsStatistics() { return &this->mPhysicsData.statistics; }
 	};
 }
 
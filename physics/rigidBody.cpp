@@ -27,60 +27,10 @@
 
 #include"rigidBody.h"
 
-#include"physicsData.h"
+#include"colliderDispatch.h"
 
 namespace mech {
 
-	struct ColliderTransformer {
-		
-		void transformConvexHull(PhysicsData* physicsData, const uint32& colliderIndex, const Transform3D& t)
-		{ 
-			physicsData->convexHullColliders[colliderIndex].transform(t);
-		}
-
-		void transformSphere(PhysicsData* physicsData, const uint32& colliderIndex, const Transform3D& t)
-		{ 
-			physicsData->sphereColliders[colliderIndex].transform(t);
-		}
-
-		void transformCapsule(PhysicsData* physicsData, const uint32& colliderIndex, const Transform3D& t)
-		{ 
-			physicsData->capsuleColliders[colliderIndex].transform(t);
-		}
-
-		void transformCompoundCollider(PhysicsData* physicsData, const uint32& colliderIndex, const Transform3D& t)
-		{
-			for (byte x = 0, len = physicsData->compoundColliders[colliderIndex].components.size(); x < len; ++x) {
-				(this->*transformPtrs[(uint32)(physicsData->colliderIdentifiers[physicsData->compoundColliders[colliderIndex].components[x]].type)])(physicsData, physicsData->colliderIdentifiers[physicsData->compoundColliders[colliderIndex].components[x]].colliderIndex, t);
-			}
-
-			physicsData->compoundColliders[colliderIndex].bound = physicsData->getColliderAABB(physicsData->compoundColliders[colliderIndex].components[0]);
-			for (byte x = 1, len = physicsData->compoundColliders[colliderIndex].components.size(); x < len; ++x) {
-			
-				const AABB& aabb = physicsData->getColliderAABB(physicsData->compoundColliders[colliderIndex].components[x]);
-				physicsData->compoundColliders[colliderIndex].bound.max = maxVec(physicsData->compoundColliders[colliderIndex].bound.max, aabb.max);
-				physicsData->compoundColliders[colliderIndex].bound.min = minVec(physicsData->compoundColliders[colliderIndex].bound.min, aabb.min);
-			}
-		}
-
-		void (ColliderTransformer::*transformPtrs[4]) (PhysicsData*, const uint32&, const Transform3D&);
-
-		ColliderTransformer()
-		{
-			transformPtrs[0] = &ColliderTransformer::transformConvexHull;
-			transformPtrs[1] = &ColliderTransformer::transformSphere;
-			transformPtrs[2] = &ColliderTransformer::transformCapsule;
-			transformPtrs[3] = &ColliderTransformer::transformCompoundCollider;
-		}
-
-		void transform(PhysicsData* physicsData, const uint32& colliderID, const Transform3D& t)
-		{
-			(this->*transformPtrs[(uint32)(physicsData->colliderIdentifiers[colliderID].type)])(physicsData, physicsData->colliderIdentifiers[colliderID].colliderIndex, t);
-		}
-	};
-	ColliderTransformer colliderTransformer;
-
-
 	RigidBodySettings rbSettings;
 	
 	RigidBodySettings* getRigidBodySettings()
@@ -95,6 +45,13 @@ namespace mech {
 
 	void RigidBody::update(PhysicsData* physicsData, const decimal& deltaTime)
 	{
+		this->prevTime = decimal(0.0);
+
+		if (this->isKinematic()) {
+			this->updateKinematic(physicsData, deltaTime);
+			return;
+		}
+
 		BEGIN_PROFILE("RigidBody::update");
 
 		this->deltaPosition += this->linearVelocity * deltaTime;
@@ -121,7 +78,7 @@ namespace mech {
 		this->transform.position += this->deltaPosition;
 		this->transform.orientation = normalise(rotationQuaternion(this->deltaOrientaion) * this->transform.orientation);
 		
-		colliderTransformer.transform(physicsData, this->colliderID, this->transform * getInverse(this->prevTransform));
+		ColliderTransformer::transformCollider(physicsData, this->colliderID, this->transform * getInverse(this->prevTransform));
 
 		this->linearVelocity += (rbSettings.gravity + this->forceAccumulated * this->invMass) * deltaTime;
 		this->angularVelocity += (this->invInertiaTensor * this->torqueAccumulated) * deltaTime;
@@ -133,11 +90,49 @@ namespace mech {
 		END_PROFILE;
 	}
 
+	//no forces, gravity or damping, the body goes to sleep once it has nowhere to go
+	void RigidBody::updateKinematic(PhysicsData* physicsData, const decimal& deltaTime)
+	{
+		if (this->flags & 0b00010000) {
+			this->linearVelocity = (this->kinematicTarget.position - this->transform.position) / deltaTime;
+			this->angularVelocity = rotationVector(this->kinematicTarget.orientation * getConjugate(this->transform.orientation)) / deltaTime;
+			this->flags = (this->flags & 0b11101111) | 0b00100000;
+		}
+		else if (this->flags & 0b00100000) {
+			this->linearVelocity = Vec3();
+			this->angularVelocity = Vec3();
+			this->flags &= 0b11011111;
+		}
+
+		this->clearForces();
+
+		if (this->linearVelocity == Vec3() && this->angularVelocity == Vec3()) {
+			this->prevTransform = this->transform;
+			this->deactivate();
+			return;
+		}
+
+		this->advance(physicsData, deltaTime);
+	}
+
 	void RigidBody::subStep(PhysicsData* physicsData, const decimal& t)
 	{
 		Transform3D trans = Transform3DRange(this->prevTransform, this->transform).interpolate(t);
 		this->transform = trans * this->transform;
-		colliderTransformer.transform(physicsData, this->colliderID, trans);
+		++this->motionVersion;
+		ColliderTransformer::transformCollider(physicsData, this->colliderID, trans);
+	}
+
+	//moves the body along its current velocities, the transform it leaves becomes the previous transform
+	void RigidBody::advance(PhysicsData* physicsData, const decimal& deltaTime)
+	{
+		this->prevTransform = this->transform;
+
+		this->transform.position += this->linearVelocity * deltaTime;
+		this->transform.orientation = normalise(rotationQuaternion(this->angularVelocity * deltaTime) * this->transform.orientation);
+		++this->motionVersion;
+
+		ColliderTransformer::transformCollider(physicsData, this->colliderID, this->transform * getInverse(this->prevTransform));
 	}
 
 	void RigidBody::addForce(const Vec3& force)
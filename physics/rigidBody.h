@@ -55,6 +55,10 @@ namespace mech {
 			------rigid body flags---------
 			body can go to sleep            - 0b00000001
 			body is active                  - 0b00000010
+			body uses speculative contacts  - 0b00000100
+			body is kinematic               - 0b00001000
+			kinematic target is pending     - 0b00010000
+			velocities came from a target   - 0b00100000
 		*/
 
 		Transform3D transform;
@@ -66,16 +70,21 @@ namespace mech {
 		Vec3 torqueAccumulated;
 		Vec3 deltaPosition;
 		Vec3 deltaOrientaion;
+		Transform3D kinematicTarget;
 		decimal motion = decimal(0.0);
+		decimal prevTime = decimal(0.0); //fraction of the step prevTransform belongs to, later than 0 once the body has handled an impact
 		decimal invMass = decimal(0.0);
 		uint32 colliderID = -1;
+		uint32 motionVersion = 0; //bumped whenever the path of the body through the step changes
 		byte flags = 0b00000011;
 
 		RigidBody();
 		~RigidBody() {}
 
 		void update(PhysicsData* physicsData, const decimal& deltaTime);
+		void updateKinematic(PhysicsData* physicsData, const decimal& deltaTime);
 		void subStep(PhysicsData* physicsData, const decimal& t);
+		void advance(PhysicsData* physicsData, const decimal& deltaTime);
 		void addForce(const Vec3& force);
 		void addForceAtPoint(const Vec3& force, const Vec3& point);
 		void updatePositionAndOrientaion(const Vec3& deltaPos, const Vec3& deltaOrient);
@@ -87,6 +96,8 @@ namespace mech {
 
 		bool isActive() { return this->flags & 0b00000010; }
 		bool canSleep() { return this->flags & 0b00000001; }
+		bool usesSpeculativeContacts() { return this->flags & 0b00000100; }
+		bool isKinematic() { return this->flags & 0b00001000; }
 	
 		Mat4x4 getTransformMatrix() const { return this->transform.toMatrix(); }
 		Vec3 getDisplacement() { return this->transform.position - this->prevTransform.position; }
@@ -94,6 +105,11 @@ namespace mech {
 		void setTransform(const Transform3D& transform) { this->transform = transform; }
 		void setMass(const decimal& mass) { this->invMass = decimal(1.0) / mass; }
 		void setTensor(const Mat3x3& tensor) { this->invInertiaTensor = getInverse(tensor); }
+		//kinematic bodies have infinite mass and only move as they are told, a target is reached in one step and the body stops after it
+		void makeKinematic() { this->invMass = decimal(0.0); this->invInertiaTensor = Mat3x3(decimal(0.0)); this->flags |= 0b00001000; }
+		void setKinematicTarget(const Transform3D& target) { ASSERT(this->isKinematic(), "only kinematic bodies take a target"); this->kinematicTarget = target; this->flags |= 0b00010000; this->activate(); }
+		void setKinematicVelocity(const Vec3& linear, const Vec3& angular) { ASSERT(this->isKinematic(), "only kinematic bodies take a velocity this way"); this->linearVelocity = linear; this->angularVelocity = angular; this->flags &= 0b11001111; this->activate(); }
+		void setSpeculativeContacts(const bool& enable) { if (enable) this->flags |= 0b00000100; else this->flags &= 0b11111011; }
 	};
 }
 
@@ -0,0 +1,1323 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef SCENEQUERY_H
+#define SCENEQUERY_H
+
+#include"colliderDispatch.h"
+#include"../geometry/plane.h"
+#include"../geometry/point.h"
+#include"../geometry/algorithms/GJK.h"
+#include"../core/workerPool.h"
+
+namespace mech {
+
+#define MAXIMUM_QUERY_THREADS 16
+#define MAXIMUM_SWEEP_ITERATIONS 20
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class RaycastMode : byte { closest = 0, any = 1 }; //any stops at the first hit found, which is not always the nearest
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct QueryFilter {
+		uint32 ignoredID = -1; //usually the collider the query is made for
+		bool includeMotionless = true;
+		bool includeDynamic = true;
+		bool includeKinematic = true;
+		bool includeHeightFields = true;
+		uint32 layerMask = 0xFFFFFFFF; //bit x is set when colliders on layer x are reported
+		bool (*callback)(const ColliderIdentifier& identifier, void* userData) = nullptr; //returns false to skip a collider, batches call it from several threads
+		void* userData = nullptr;
+
+		bool accepts(const ColliderIdentifier& identifier) const
+		{
+			if (identifier.colliderID == this->ignoredID || (this->layerMask & (1u << identifier.layer)) == 0) return false;
+			if (identifier.type == ColliderType::heightField) {
+				if (this->includeHeightFields == false) return false;
+			}
+			else if ((identifier.state == ColliderMotionState::motionless && this->includeMotionless == false) || (identifier.state == ColliderMotionState::dynamic && this->includeDynamic == false) ||
+				(identifier.state == ColliderMotionState::kinematic && this->includeKinematic == false)) {
+				return false;
+			}
+			return this->callback == nullptr || this->callback(identifier, this->userData);
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct RaycastHit {
+		Vec3 point = nanVEC3;
+		Vec3 normal = nanVEC3; //faces the ray
+		decimal distance = decimal(-1.0);
+		uint32 colliderID = -1; //the component for compound colliders
+
+		bool hasHit() const { return isAValidIndex(this->colliderID); }
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//a shape moved by a transform without copying it, GJK only asks it for support points
+	template<typename Shape>
+	struct PlacedShape {
+		const Shape* shape;
+		Transform3D transform;
+		Quaternion inverseOrientation;
+
+		PlacedShape(const Shape& s, const Transform3D& t) : shape(&s), transform(t), inverseOrientation(getInverse(t.orientation)) {}
+
+		Vec3 getSupportPoint(const Vec3& direction) const { return this->transform * this->shape->getSupportPoint(this->inverseOrientation * direction); }
+
+		AABB toAABB() const
+		{
+			Vec3 min, max;
+			for (byte i = 0; i < 3; ++i) {
+				Vec3 axis;
+				axis[i] = decimal(1.0);
+				max[i] = this->getSupportPoint(axis)[i];
+				min[i] = this->getSupportPoint(-axis)[i];
+			}
+			return AABB(min, max);
+		}
+
+		template<typename Other>
+		bool intersects(const Other& other) const { return GJKOverlap(*this, other); }
+
+		//round shapes are tested by their core, GJK converges slowly on curved surfaces
+		bool intersects(const Sphere& sphere) const { return this->isWithin(Point(sphere.center), sphere.radius); }
+		bool intersects(const Capsule& capsule) const { return this->isWithin(capsule.capsuleLine, capsule.radius); }
+
+	private:
+
+		template<typename Core>
+		bool isWithin(const Core& core, const decimal& radius) const
+		{
+			GJKDistanceResult r = GJKDistance(*this, core, Vec3(), mathEPSILON);
+			return r.overlap || magnitudeSq(r.closest1 - r.closest2) <= square(radius);
+		}
+	};
+
+	template<typename Shape>
+	struct TranslatedShape {
+		const Shape& shape;
+		Vec3 offset;
+
+		Vec3 getSupportPoint(const Vec3& direction) const { return this->shape.getSupportPoint(direction) + this->offset; }
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/*
+		shapes accepted by overlap and shapeCast. Placed is the shape in world space, sweeps move its Core, which is inflated by a radius for
+		spheres and capsules
+	*/
+	template<typename Shape>
+	struct QueryShapeTraits {};
+
+	template<>
+	struct QueryShapeTraits<Sphere> {
+		typedef Sphere Placed;
+		typedef Point Core;
+		static Placed place(const Sphere& sphere, const Transform3D& transform) { return sphere.transformed(transform); }
+		static Core getCore(const Placed& placed) { return Point(placed.center); }
+		static decimal getRadius(const Placed& placed) { return placed.radius; }
+	};
+
+	template<>
+	struct QueryShapeTraits<Capsule> {
+		typedef Capsule Placed;
+		typedef LineSegment Core;
+		static Placed place(const Capsule& capsule, const Transform3D& transform) { return capsule.transformed(transform); }
+		static Core getCore(const Placed& placed) { return placed.capsuleLine; }
+		static decimal getRadius(const Placed& placed) { return placed.radius; }
+	};
+
+	template<>
+	struct QueryShapeTraits<OBB> {
+		typedef OBB Placed;
+		typedef OBB Core;
+		static Placed place(const OBB& obb, const Transform3D& transform) { return obb.transformed(transform); }
+		static Core getCore(const Placed& placed) { return placed; }
+		static decimal getRadius(const Placed& /*placed*/) { return decimal(0.0); }
+	};
+
+	template<>
+	struct QueryShapeTraits<ConvexHull> {
+		typedef PlacedShape<ConvexHull> Placed;
+		typedef PlacedShape<ConvexHull> Core;
+		static Placed place(const ConvexHull& convexHull, const Transform3D& transform) { return Placed(convexHull, transform); }
+		static Core getCore(const Placed& placed) { return placed; }
+		static decimal getRadius(const Placed& /*placed*/) { return decimal(0.0); }
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/*
+		queries against the colliders in the world. rays walk the octree front to back, the children of a node are visited in the order
+		the ray enters them and a branch is left once it starts past the nearest hit. triangle meshes walk their BVH the same way and
+		height fields step through the cells the ray crosses. height fields are tested first, they cover cells the octree has no nodes for
+	*/
+	struct SceneQuery {
+
+		PhysicsData* physicsData = nullptr;
+		WorkerPool workerPool; //batches run on these threads, they are started by the first batch that needs them
+
+		SceneQuery() {}
+		SceneQuery(const SceneQuery&) = delete;
+		SceneQuery& operator=(const SceneQuery&) = delete;
+
+		//directions are expected to be normalised, distances are measured along them
+		bool raycast(const Ray& ray, const decimal& maxDistance, RaycastHit& hit, const QueryFilter& filter = QueryFilter(), const RaycastMode& mode = RaycastMode::closest)
+		{
+			BEGIN_PROFILE("SceneQuery::raycast");
+			bool hasHit = this->castRay(ray, maxDistance, hit, filter, mode);
+			END_PROFILE;
+
+			return hasHit;
+		}
+
+		//nearest hit on every collider the ray reaches, in no particular order
+		uint32 raycastAll(const Ray& ray, const decimal& maxDistance, DynamicArray<RaycastHit, uint32>& hits, const QueryFilter& filter = QueryFilter())
+		{
+			BEGIN_PROFILE("SceneQuery::raycastAll");
+
+			uint32 first = hits.size();
+			AllHitsCollector collector = { hits, maxDistance, false };
+			this->traceRay(ray, filter, collector);
+
+			END_PROFILE;
+
+			return hits.size() - first;
+		}
+
+		//RAY_PACKET_SIZE rays traced together, for coherent rays such as sensor fans and vision cones. hits[x] is the result of rays[x]
+		void raycastPacket(const Ray* rays, const decimal& maxDistance, RaycastHit* hits, const QueryFilter& filter = QueryFilter(), const RaycastMode& mode = RaycastMode::closest)
+		{
+			BEGIN_PROFILE("SceneQuery::raycastPacket");
+			this->castPacket(rays, maxDistance, hits, filter, mode);
+			END_PROFILE;
+		}
+
+		/*
+			hits[x] is the result of rays[x], the rays are split evenly between the calling thread and numOfThreads - 1 workers.
+			runs of RAY_PACKET_SIZE coherent rays are traced as packets, the others one at a time
+		*/
+		void raycastBatch(const Ray* rays, const uint32& numOfRays, const decimal& maxDistance, RaycastHit* hits, const QueryFilter& filter = QueryFilter(), const RaycastMode& mode = RaycastMode::closest, const byte& numOfThreads = 1)
+		{
+			BEGIN_PROFILE("SceneQuery::raycastBatch");
+
+			struct TaskExecuter {
+				SceneQuery* sceneQuery;
+				const Ray* rays;
+				decimal maxDistance;
+				RaycastHit* hits;
+				const QueryFilter& filter;
+				RaycastMode mode;
+
+				void run(const uint32 first, const uint32 last)
+				{
+					uint32 x = first;
+					while (x + RAY_PACKET_SIZE <= last) {
+						if (RayPacket::isCoherent(this->rays + x)) {
+							this->sceneQuery->castPacket(this->rays + x, this->maxDistance, this->hits + x, this->filter, this->mode);
+							x += RAY_PACKET_SIZE;
+						}
+						else {
+							this->sceneQuery->castRay(this->rays[x], this->maxDistance, this->hits[x], this->filter, this->mode);
+							++x;
+						}
+					}
+					for (; x < last; ++x) {
+						this->sceneQuery->castRay(this->rays[x], this->maxDistance, this->hits[x], this->filter, this->mode);
+					}
+				}
+			};
+
+			TaskExecuter executer = { this, rays, maxDistance, hits, filter, mode };
+			this->runBatch(executer, numOfRays, numOfThreads);
+
+			END_PROFILE;
+		}
+
+		/*
+			colliders overlapping a sphere, capsule, OBB or convex hull given in its own space and placed by transform.
+			writes the ids of at most maxResults of them (the components for compound colliders) and returns how many were written, nothing is allocated
+		*/
+		template<typename Shape>
+		uint32 overlap(const Shape& shape, const Transform3D& transform, const QueryFilter& filter, uint32* colliderIDs, const uint32& maxResults)
+		{
+			BEGIN_PROFILE("SceneQuery::overlap");
+			uint32 count = this->findOverlaps(shape, transform, filter, colliderIDs, maxResults);
+			END_PROFILE;
+
+			return count;
+		}
+
+		/*
+			first collider a shape touches while it moves from from.position to "to" without rotating. hit.distance is the distance travelled,
+			hit.normal faces the motion and a shape that starts overlapping a collider hits it at distance 0
+		*/
+		template<typename Shape>
+		bool shapeCast(const Shape& shape, const Transform3D& from, const Vec3& to, const QueryFilter& filter, RaycastHit& hit)
+		{
+			BEGIN_PROFILE("SceneQuery::shapeCast");
+			bool hasHit = this->castShape(shape, from, to, filter, hit);
+			END_PROFILE;
+
+			return hasHit;
+		}
+
+		//colliderIDs holds maxResultsPerQuery ids for every query, counts[x] is the number found by query x
+		template<typename Shape>
+		void overlapBatch(const Shape* shapes, const Transform3D* transforms, const uint32& numOfQueries, const QueryFilter& filter, uint32* colliderIDs, const uint32& maxResultsPerQuery, uint32* counts, const byte& numOfThreads = 1)
+		{
+			BEGIN_PROFILE("SceneQuery::overlapBatch");
+
+			struct TaskExecuter {
+				SceneQuery* sceneQuery;
+				const Shape* shapes;
+				const Transform3D* transforms;
+				const QueryFilter& filter;
+				uint32* colliderIDs;
+				uint32 maxResultsPerQuery;
+				uint32* counts;
+
+				void run(const uint32 first, const uint32 last)
+				{
+					for (uint32 x = first; x < last; ++x) {
+						this->counts[x] = this->sceneQuery->findOverlaps(this->shapes[x], this->transforms[x], this->filter, this->colliderIDs + x * this->maxResultsPerQuery, this->maxResultsPerQuery);
+					}
+				}
+			};
+
+			TaskExecuter executer = { this, shapes, transforms, filter, colliderIDs, maxResultsPerQuery, counts };
+			this->runBatch(executer, numOfQueries, numOfThreads);
+
+			END_PROFILE;
+		}
+
+		//hits[x] is the result of sweeping shapes[x] from from[x] to to[x]
+		template<typename Shape>
+		void shapeCastBatch(const Shape* shapes, const Transform3D* from, const Vec3* to, const uint32& numOfQueries, const QueryFilter& filter, RaycastHit* hits, const byte& numOfThreads = 1)
+		{
+			BEGIN_PROFILE("SceneQuery::shapeCastBatch");
+
+			struct TaskExecuter {
+				SceneQuery* sceneQuery;
+				const Shape* shapes;
+				const Transform3D* from;
+				const Vec3* to;
+				const QueryFilter& filter;
+				RaycastHit* hits;
+
+				void run(const uint32 first, const uint32 last)
+				{
+					for (uint32 x = first; x < last; ++x) {
+						this->sceneQuery->castShape(this->shapes[x], this->from[x], this->to[x], this->filter, this->hits[x]);
+					}
+				}
+			};
+
+			TaskExecuter executer = { this, shapes, from, to, filter, hits };
+			this->runBatch(executer, numOfQueries, numOfThreads);
+
+			END_PROFILE;
+		}
+
+	private:
+
+		//the query entry points without profiling, batches call these from their workers and are profiled as a whole on the calling thread
+		bool castRay(const Ray& ray, const decimal& maxDistance, RaycastHit& hit, const QueryFilter& filter, const RaycastMode& mode)
+		{
+			ClosestHitCollector collector;
+			collector.maxDistance = maxDistance;
+			collector.anyHit = mode == RaycastMode::any;
+
+			this->traceRay(ray, filter, collector);
+			hit = collector.hit;
+
+			return hit.hasHit();
+		}
+
+		void castPacket(const Ray* rays, const decimal& maxDistance, RaycastHit* hits, const QueryFilter& filter, const RaycastMode& mode)
+		{
+			PacketCollector collector = { RayPacket(rays), hits, {}, mode == RaycastMode::any };
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+				hits[lane] = RaycastHit();
+				collector.maxT[lane] = (float)mathMIN(maxDistance, decimal(FLT_MAX));
+			}
+
+			this->tracePacket(filter, collector);
+		}
+
+		template<typename Shape>
+		uint32 findOverlaps(const Shape& shape, const Transform3D& transform, const QueryFilter& filter, uint32* colliderIDs, const uint32& maxResults)
+		{
+			typedef typename QueryShapeTraits<Shape>::Placed Placed;
+			Placed placed = QueryShapeTraits<Shape>::place(shape, transform);
+
+			ShapeOverlap<Placed> query = { placed, placed.toAABB(), colliderIDs, maxResults, 0 };
+			this->traceOverlap(query, filter);
+
+			return query.count;
+		}
+
+		template<typename Shape>
+		bool castShape(const Shape& shape, const Transform3D& from, const Vec3& to, const QueryFilter& filter, RaycastHit& hit)
+		{
+			typedef typename QueryShapeTraits<Shape>::Placed Placed;
+			typedef typename QueryShapeTraits<Shape>::Core Core;
+			Placed placed = QueryShapeTraits<Shape>::place(shape, from);
+
+			ShapeSweep<Core> sweep(QueryShapeTraits<Shape>::getCore(placed), QueryShapeTraits<Shape>::getRadius(placed), to - from.position, placed.toAABB(), this->physicsData->settings.linearSlop);
+
+			this->traceSweep(sweep, filter);
+			hit = sweep.hit;
+
+			return hit.hasHit();
+		}
+
+		//splits the queries evenly between the calling thread and numOfThreads - 1 pooled workers, task.run(first, last) handles a range
+		template<typename Task>
+		void runBatch(Task& task, const uint32& numOfQueries, const byte& numOfThreads)
+		{
+			//components are brought to their compounds up front so the workers only read
+			for (auto it = this->physicsData->compoundColliders.begin(), end = this->physicsData->compoundColliders.end(); it != end; ++it) {
+				refreshComponents(this->physicsData, it.data());
+			}
+
+			this->workerPool.run(task, numOfQueries, numOfThreads > MAXIMUM_QUERY_THREADS ? MAXIMUM_QUERY_THREADS : numOfThreads);
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		//colliders a ray or packet query has tested, one per thread so batches do not share it. a collider is marked with the
+		//stamp of the query, so nothing is cleared between queries
+		struct VisitedColliders {
+			DynamicArray<uint32, uint32> stamps;
+			uint32 stamp = 0;
+
+			static VisitedColliders& begin(const uint32& numOfColliders)
+			{
+				static thread_local VisitedColliders visited;
+
+				while (visited.stamps.size() < numOfColliders) {
+					visited.stamps.pushBack(0);
+				}
+
+				if (++visited.stamp == 0) {
+					for (uint32 x = 0, len = visited.stamps.size(); x < len; ++x) {
+						visited.stamps[x] = 0;
+					}
+					visited.stamp = 1;
+				}
+
+				return visited;
+			}
+
+			//false when the collider was already tested by this query
+			bool visit(const uint32& colliderID)
+			{
+				if (this->stamps[colliderID] == this->stamp) return false;
+				this->stamps[colliderID] = this->stamp;
+				return true;
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		struct ClosestHitCollector {
+			RaycastHit hit;
+			decimal maxDistance = decimal(0.0);
+			bool anyHit = false;
+
+			bool add(const RaycastHit& newHit)
+			{
+				this->hit = newHit;
+				this->maxDistance = newHit.distance;
+				return this->anyHit == false;
+			}
+		};
+
+		struct AllHitsCollector {
+			DynamicArray<RaycastHit, uint32>& hits;
+			decimal maxDistance;
+			bool anyHit;
+
+			bool add(const RaycastHit& newHit)
+			{
+				this->hits.pushBack(newHit);
+				return true;
+			}
+		};
+
+		//lanes leave the packet once they need nothing more, in any mode that is their first hit
+		struct PacketCollector {
+			RayPacket packet;
+			RaycastHit* hits;
+			float maxT[RAY_PACKET_SIZE];
+			bool anyHit;
+
+			void add(const byte& lane, const RaycastHit& newHit)
+			{
+				this->hits[lane] = newHit;
+				this->maxT[lane] = (float)newHit.distance;
+				if (this->anyHit) {
+					this->packet.activeMask &= ~(1 << lane);
+				}
+			}
+		};
+
+		struct RayCaster {
+			SceneQuery* sceneQuery;
+			const Ray& ray;
+			decimal maxDistance;
+			bool anyHit;
+			uint32 colliderIndex;
+			RaycastHit hit;
+
+			template<ColliderType type>
+			void visit()
+			{
+				this->sceneQuery->rayCast(ColliderTraits<type>::get(this->sceneQuery->physicsData, this->colliderIndex), this->ray, this->maxDistance, this->anyHit, this->hit);
+			}
+		};
+
+		struct PacketCaster {
+			SceneQuery* sceneQuery;
+			uint32 colliderIndex;
+			uint32 colliderID;
+			int32 lanes;
+			PacketCollector& collector;
+
+			template<ColliderType type>
+			void visit()
+			{
+				this->sceneQuery->rayCastPacket(ColliderTraits<type>::get(this->sceneQuery->physicsData, this->colliderIndex), this->colliderID, this->lanes, this->collector);
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		template<typename Collector>
+		void traceRay(const Ray& ray, const QueryFilter& filter, Collector& collector)
+		{
+			Vec3 inverseDirection = getInverseDirection(ray);
+
+			//height fields first, a near terrain hit prunes most of the octree
+			if (filter.includeHeightFields) {
+
+				const ColliderIdentifier* heightField = this->findHeightField();
+				if (heightField != nullptr && filter.accepts(*heightField) && this->rayCastCollider(*heightField, ray, collector) == false) return;
+
+				TiledHeightField& tiledHeightField = this->physicsData->tiledHeightField;
+				for (uint32 x = 0, len = tiledHeightField.tiles.size(); x < len; ++x) {
+
+					const TiledHeightField::Tile& tile = tiledHeightField.tiles[x];
+					if (isAValidIndex(tile.colliderID) == false || rayEntryTime(ray.origin, inverseDirection, tile.bound.min, tile.bound.max, collector.maxDistance) < decimal(0.0)) continue;
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[tile.colliderID];
+					if (filter.accepts(identifier) && this->rayCastCollider(identifier, ray, collector) == false) return;
+				}
+			}
+
+			if (this->physicsData->octree.nodes.empty()) return;
+
+			VisitedColliders& tested = VisitedColliders::begin(this->physicsData->colliderIdentifiers.internalSize());
+			if (rayEntryTime(ray.origin, inverseDirection, this->physicsData->octree.nodes[0].bound.min, this->physicsData->octree.nodes[0].bound.max, collector.maxDistance) >= decimal(0.0)) {
+				this->traceNode(0, ray, inverseDirection, filter, collector, tested);
+			}
+		}
+
+		//returns false once the collector needs nothing more
+		template<typename Collector>
+		bool traceNode(const uint16& nodeIndex, const Ray& ray, const Vec3& inverseDirection, const QueryFilter& filter, Collector& collector, VisitedColliders& tested)
+		{
+			const Octree::Node& node = this->physicsData->octree.nodes[nodeIndex];
+
+			if (node.children.empty()) {
+				for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[it.data()];
+					if (identifier.type == ColliderType::heightField || tested.visit(identifier.colliderID) == false) continue;
+
+					if (filter.accepts(identifier) && this->rayCastCollider(identifier, ray, collector) == false) return false;
+				}
+				return true;
+			}
+
+			//children in the order the ray enters them
+			Pair<decimal, uint16> order[8];
+			byte count = 0;
+			for (byte x = 0; x < 8; ++x) {
+
+				if (isAValidIndex(node.children[x].first) == false) continue;
+
+				uint16 childIndex = node.children[x].second;
+				decimal t = rayEntryTime(ray.origin, inverseDirection, this->physicsData->octree.nodes[childIndex].bound.min, this->physicsData->octree.nodes[childIndex].bound.max, collector.maxDistance);
+				if (t < decimal(0.0)) continue;
+
+				byte y = count++;
+				for (; y > 0 && order[y - 1].first > t; --y) {
+					order[y] = order[y - 1];
+				}
+				order[y] = Pair<decimal, uint16>(t, childIndex);
+			}
+
+			for (byte x = 0; x < count; ++x) {
+				if (order[x].first > collector.maxDistance) break;
+				if (this->traceNode(order[x].second, ray, inverseDirection, filter, collector, tested) == false) return false;
+			}
+
+			return true;
+		}
+
+		template<typename Collector>
+		bool rayCastCollider(const ColliderIdentifier& identifier, const Ray& ray, Collector& collector)
+		{
+			if (identifier.type == ColliderType::compound) {
+
+				CompoundCollider& compoundCollider = this->physicsData->compoundColliders[identifier.colliderIndex];
+				if (compoundCollider.tree.empty() || rayEntryTime(ray.origin, getInverseDirection(ray), compoundCollider.bound.min, compoundCollider.bound.max, collector.maxDistance) < decimal(0.0)) return true;
+
+				//distances are the same in the local space of the compound, so its tree is walked with the local ray
+				Ray localRay = ray.transformed(getInverse(compoundCollider.worldTransform));
+				return this->rayCastComponents(compoundCollider, 0, localRay.origin, getInverseDirection(localRay), ray, collector);
+			}
+
+			RayCaster caster = { this, ray, collector.maxDistance, collector.anyHit, identifier.colliderIndex, RaycastHit() };
+			dispatch(identifier.type, caster);
+
+			if (caster.hit.distance < decimal(0.0)) return true;
+
+			caster.hit.colliderID = identifier.colliderID;
+			return collector.add(caster.hit);
+		}
+
+		//a branch of the tree is left once the ray enters it past the nearest hit, only the components reached are brought up to date
+		template<typename Collector>
+		bool rayCastComponents(CompoundCollider& compoundCollider, const uint16& nodeIndex, const Vec3& localOrigin, const Vec3& localInverseDirection, const Ray& ray, Collector& collector)
+		{
+			const CompoundCollider::Node& node = compoundCollider.tree[nodeIndex];
+			if (rayEntryTime(localOrigin, localInverseDirection, node.bound.min, node.bound.max, collector.maxDistance) < decimal(0.0)) return true;
+
+			if (isAValidIndex(node.component)) {
+				refreshComponent(this->physicsData, compoundCollider, node.component);
+				return this->rayCastCollider(this->physicsData->colliderIdentifiers[compoundCollider.components[node.component]], ray, collector);
+			}
+
+			return this->rayCastComponents(compoundCollider, node.left, localOrigin, localInverseDirection, ray, collector) &&
+				this->rayCastComponents(compoundCollider, node.right, localOrigin, localInverseDirection, ray, collector);
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		void tracePacket(const QueryFilter& filter, PacketCollector& collector)
+		{
+			if (filter.includeHeightFields) {
+
+				const ColliderIdentifier* heightField = this->findHeightField();
+				if (heightField != nullptr && filter.accepts(*heightField)) {
+					this->rayCastPacketCollider(*heightField, collector.packet.activeMask, collector);
+				}
+
+				TiledHeightField& tiledHeightField = this->physicsData->tiledHeightField;
+				for (uint32 x = 0, len = tiledHeightField.tiles.size(); x < len && collector.packet.activeMask != 0; ++x) {
+
+					const TiledHeightField::Tile& tile = tiledHeightField.tiles[x];
+					if (isAValidIndex(tile.colliderID) == false) continue;
+
+					Float4 entry;
+					int32 lanes = collector.packet.entryTimes(Vec3f(tile.bound.min), Vec3f(tile.bound.max), Float4::load(collector.maxT), entry);
+					if (lanes == 0) continue;
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[tile.colliderID];
+					if (filter.accepts(identifier)) {
+						this->rayCastPacketCollider(identifier, lanes, collector);
+					}
+				}
+			}
+
+			if (this->physicsData->octree.nodes.empty() || collector.packet.activeMask == 0) return;
+
+			VisitedColliders& tested = VisitedColliders::begin(this->physicsData->colliderIdentifiers.internalSize());
+			this->tracePacketNode(0, collector.packet.activeMask, filter, collector, tested);
+		}
+
+		//returns false once every lane is done
+		bool tracePacketNode(const uint16& nodeIndex, int32 lanes, const QueryFilter& filter, PacketCollector& collector, VisitedColliders& tested)
+		{
+			const Octree::Node& node = this->physicsData->octree.nodes[nodeIndex];
+
+			Float4 entry;
+			lanes &= collector.packet.entryTimes(Vec3f(node.bound.min), Vec3f(node.bound.max), Float4::load(collector.maxT), entry);
+			if (lanes == 0) return true;
+
+			if (node.children.empty()) {
+				for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[it.data()];
+					if (identifier.type == ColliderType::heightField || tested.visit(identifier.colliderID) == false) continue;
+
+					if (filter.accepts(identifier)) {
+						this->rayCastPacketCollider(identifier, lanes & collector.packet.activeMask, collector);
+						if (collector.packet.activeMask == 0) return false;
+					}
+				}
+				return true;
+			}
+
+			//children in the order the first lane reaches their centers, every child tests the lanes again when it is visited
+			byte lead = 0;
+			while ((lanes & (1 << lead)) == 0) ++lead;
+			const Ray& leadRay = collector.packet.rays[lead];
+
+			Pair<decimal, uint16> order[8];
+			byte count = 0;
+			for (byte x = 0; x < 8; ++x) {
+
+				if (isAValidIndex(node.children[x].first) == false) continue;
+
+				uint16 childIndex = node.children[x].second;
+				decimal d = dotProduct(this->physicsData->octree.nodes[childIndex].bound.getCenter() - leadRay.origin, leadRay.direction);
+
+				byte y = count++;
+				for (; y > 0 && order[y - 1].first > d; --y) {
+					order[y] = order[y - 1];
+				}
+				order[y] = Pair<decimal, uint16>(d, childIndex);
+			}
+
+			for (byte x = 0; x < count; ++x) {
+				if (this->tracePacketNode(order[x].second, lanes & collector.packet.activeMask, filter, collector, tested) == false) return false;
+			}
+
+			return true;
+		}
+
+		void rayCastPacketCollider(const ColliderIdentifier& identifier, const int32& lanes, PacketCollector& collector)
+		{
+			if (lanes == 0) return;
+
+			if (identifier.type == ColliderType::compound) {
+
+				CompoundCollider& compoundCollider = this->physicsData->compoundColliders[identifier.colliderIndex];
+
+				Float4 entry;
+				int32 compoundLanes = collector.packet.entryTimes(Vec3f(compoundCollider.bound.min), Vec3f(compoundCollider.bound.max), Float4::load(collector.maxT), entry) & lanes;
+
+				for (byte x = 0, len = compoundCollider.components.size(); x < len && compoundLanes != 0; ++x) {
+					refreshComponent(this->physicsData, compoundCollider, x);
+					this->rayCastPacketCollider(this->physicsData->colliderIdentifiers[compoundCollider.components[x]], compoundLanes, collector);
+					compoundLanes &= collector.packet.activeMask;
+				}
+				return;
+			}
+
+			PacketCaster caster = { this, identifier.colliderIndex, identifier.colliderID, lanes, collector };
+			dispatch(identifier.type, caster);
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		//the ids found are also the colliders already tested, a collider that spans several leaves and is rejected is tested again
+		template<typename Placed>
+		struct ShapeOverlap {
+			const Placed& placed;
+			AABB bound;
+			uint32* colliderIDs;
+			uint32 maxResults;
+			uint32 count;
+
+			bool isFull() const { return this->count >= this->maxResults; }
+
+			bool contains(const uint32& colliderID) const
+			{
+				for (uint32 x = 0; x < this->count; ++x) {
+					if (this->colliderIDs[x] == colliderID) return true;
+				}
+				return false;
+			}
+		};
+
+		template<typename Placed>
+		struct Overlapper {
+			SceneQuery* sceneQuery;
+			const ShapeOverlap<Placed>& query;
+			uint32 colliderIndex;
+			bool overlaps;
+
+			template<ColliderType type>
+			void visit()
+			{
+				this->overlaps = shapesOverlap(this->query.placed, this->query.bound, ColliderTraits<type>::get(this->sceneQuery->physicsData, this->colliderIndex));
+			}
+		};
+
+		template<typename Placed>
+		struct TriangleOverlapFinder {
+			const Placed& placed;
+			bool found;
+
+			bool visit(const Triangle& triangle)
+			{
+				this->found = this->placed.intersects(triangle);
+				return this->found == false;
+			}
+		};
+
+		template<typename Placed>
+		void traceOverlap(ShapeOverlap<Placed>& query, const QueryFilter& filter)
+		{
+			if (query.isFull()) return;
+
+			if (filter.includeHeightFields) {
+
+				const ColliderIdentifier* heightField = this->findHeightField();
+				if (heightField != nullptr && filter.accepts(*heightField)) {
+					this->overlapCollider(*heightField, query);
+				}
+
+				TiledHeightField& tiledHeightField = this->physicsData->tiledHeightField;
+				for (uint32 x = 0, len = tiledHeightField.tiles.size(); x < len && query.isFull() == false; ++x) {
+
+					const TiledHeightField::Tile& tile = tiledHeightField.tiles[x];
+					if (isAValidIndex(tile.colliderID) == false || tile.bound.intersects(query.bound) == false) continue;
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[tile.colliderID];
+					if (filter.accepts(identifier)) {
+						this->overlapCollider(identifier, query);
+					}
+				}
+			}
+
+			if (this->physicsData->octree.nodes.empty() || query.isFull()) return;
+
+			this->overlapNode(0, query, filter);
+		}
+
+		//returns false once the output is full
+		template<typename Placed>
+		bool overlapNode(const uint16& nodeIndex, ShapeOverlap<Placed>& query, const QueryFilter& filter)
+		{
+			const Octree::Node& node = this->physicsData->octree.nodes[nodeIndex];
+			if (node.bound.intersects(query.bound) == false) return true;
+
+			if (node.children.empty()) {
+				for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[it.data()];
+					if (identifier.type == ColliderType::heightField || filter.accepts(identifier) == false) continue;
+
+					this->overlapCollider(identifier, query);
+					if (query.isFull()) return false;
+				}
+				return true;
+			}
+
+			for (byte x = 0; x < 8; ++x) {
+				if (isAValidIndex(node.children[x].first) && this->overlapNode(node.children[x].second, query, filter) == false) return false;
+			}
+
+			return true;
+		}
+
+		template<typename Placed>
+		void overlapCollider(const ColliderIdentifier& identifier, ShapeOverlap<Placed>& query)
+		{
+			if (identifier.type == ColliderType::compound) {
+
+				CompoundCollider& compoundCollider = this->physicsData->compoundColliders[identifier.colliderIndex];
+				if (compoundCollider.bound.intersects(query.bound) == false) return;
+
+				for (byte x = 0, len = compoundCollider.components.size(); x < len && query.isFull() == false; ++x) {
+					refreshComponent(this->physicsData, compoundCollider, x);
+					this->overlapCollider(this->physicsData->colliderIdentifiers[compoundCollider.components[x]], query);
+				}
+				return;
+			}
+
+			if (query.isFull() || query.contains(identifier.colliderID)) return;
+
+			Overlapper<Placed> overlapper = { this, query, identifier.colliderIndex, false };
+			dispatch(identifier.type, overlapper);
+
+			if (overlapper.overlaps) {
+				query.colliderIDs[query.count++] = identifier.colliderID;
+			}
+		}
+
+		template<typename Placed, typename Collider>
+		static bool shapesOverlap(const Placed& placed, const AABB& bound, const Collider& collider)
+		{
+			return collider.bound.intersects(bound) && placed.intersects(collider.collider);
+		}
+
+		template<typename Placed>
+		static bool shapesOverlap(const Placed& /*placed*/, const AABB& /*bound*/, const CompoundCollider& /*collider*/)
+		{
+			ASSERT(false, "compound colliders are tested through their components");
+			return false;
+		}
+
+		template<typename Placed>
+		static bool shapesOverlap(const Placed& placed, const AABB& bound, const TriangleMeshCollider& collider)
+		{
+			if (collider.bound.intersects(bound) == false) return false;
+
+			TriangleOverlapFinder<Placed> finder = { placed, false };
+			collider.forEachTriangleOverlapped(bound, finder);
+			return finder.found;
+		}
+
+		template<typename Placed>
+		static bool shapesOverlap(const Placed& placed, const AABB& bound, const HeightFieldCollider& collider)
+		{
+			TriangleOverlapFinder<Placed> finder = { placed, false };
+			collider.forEachTriangleOverlapped(bound, finder);
+			return finder.found;
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		/*
+			the bound of the shape swept along the motion culls nodes and colliders, moving it is a ray against boxes grown by its half extents.
+			fractions are of the whole motion
+		*/
+		template<typename Core>
+		struct ShapeSweep {
+			Core core;
+			decimal radius;
+			Vec3 displacement;
+			Vec3 center;
+			Vec3 halfExtents;
+			Vec3 inverseDisplacement;
+			AABB sweptBound;
+			decimal length;
+			decimal fraction; //lowered to the nearest hit
+			decimal slop;
+			RaycastHit hit;
+
+			ShapeSweep(const Core& c, const decimal& r, const Vec3& d, const AABB& bound, const decimal& linearSlop) : core(c), radius(r), displacement(d)
+			{
+				this->center = bound.getCenter();
+				this->halfExtents = (bound.max - bound.min) * decimal(0.5);
+				this->inverseDisplacement = Vec3(decimal(1.0) / this->displacement.x, decimal(1.0) / this->displacement.y, decimal(1.0) / this->displacement.z);
+				this->sweptBound = AABB(minVec(bound.min, bound.min + this->displacement), maxVec(bound.max, bound.max + this->displacement));
+				this->length = magnitude(this->displacement);
+				this->fraction = decimal(1.0);
+				this->slop = linearSlop;
+			}
+
+			//fraction at which the bound of the shape reaches the box, -1 if it does not before the nearest hit
+			decimal entryFraction(const AABB& box) const
+			{
+				return rayEntryTime(this->center, this->inverseDisplacement, box.min - this->halfExtents, box.max + this->halfExtents, this->fraction);
+			}
+		};
+
+		template<typename Core>
+		struct Sweeper {
+			SceneQuery* sceneQuery;
+			ShapeSweep<Core>& sweep;
+			uint32 colliderIndex;
+			uint32 colliderID;
+
+			template<ColliderType type>
+			void visit()
+			{
+				sweepShape(ColliderTraits<type>::get(this->sceneQuery->physicsData, this->colliderIndex), this->colliderID, this->sweep);
+			}
+		};
+
+		template<typename Core>
+		struct TriangleSweeper {
+			ShapeSweep<Core>& sweep;
+			uint32 colliderID;
+
+			bool visit(const Triangle& triangle)
+			{
+				sweepCore(this->sweep, triangle, decimal(0.0), this->colliderID);
+				return true;
+			}
+		};
+
+		template<typename Core>
+		void traceSweep(ShapeSweep<Core>& sweep, const QueryFilter& filter)
+		{
+			if (filter.includeHeightFields) {
+
+				const ColliderIdentifier* heightField = this->findHeightField();
+				if (heightField != nullptr && filter.accepts(*heightField)) {
+					this->sweepCollider(*heightField, sweep);
+				}
+
+				TiledHeightField& tiledHeightField = this->physicsData->tiledHeightField;
+				for (uint32 x = 0, len = tiledHeightField.tiles.size(); x < len; ++x) {
+
+					const TiledHeightField::Tile& tile = tiledHeightField.tiles[x];
+					if (isAValidIndex(tile.colliderID) == false || sweep.entryFraction(tile.bound) < decimal(0.0)) continue;
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[tile.colliderID];
+					if (filter.accepts(identifier)) {
+						this->sweepCollider(identifier, sweep);
+					}
+				}
+			}
+
+			if (this->physicsData->octree.nodes.empty()) return;
+
+			if (sweep.entryFraction(this->physicsData->octree.nodes[0].bound) >= decimal(0.0)) {
+				this->sweepNode(0, sweep, filter);
+			}
+		}
+
+		//children in the order the shape reaches them, like traceNode
+		template<typename Core>
+		void sweepNode(const uint16& nodeIndex, ShapeSweep<Core>& sweep, const QueryFilter& filter)
+		{
+			const Octree::Node& node = this->physicsData->octree.nodes[nodeIndex];
+
+			if (node.children.empty()) {
+				for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
+
+					const ColliderIdentifier& identifier = this->physicsData->colliderIdentifiers[it.data()];
+					if (identifier.type != ColliderType::heightField && filter.accepts(identifier)) {
+						this->sweepCollider(identifier, sweep);
+					}
+				}
+				return;
+			}
+
+			Pair<decimal, uint16> order[8];
+			byte count = 0;
+			for (byte x = 0; x < 8; ++x) {
+
+				if (isAValidIndex(node.children[x].first) == false) continue;
+
+				uint16 childIndex = node.children[x].second;
+				decimal t = sweep.entryFraction(this->physicsData->octree.nodes[childIndex].bound);
+				if (t < decimal(0.0)) continue;
+
+				byte y = count++;
+				for (; y > 0 && order[y - 1].first > t; --y) {
+					order[y] = order[y - 1];
+				}
+				order[y] = Pair<decimal, uint16>(t, childIndex);
+			}
+
+			for (byte x = 0; x < count; ++x) {
+				if (order[x].first > sweep.fraction) break;
+				this->sweepNode(order[x].second, sweep, filter);
+			}
+		}
+
+		template<typename Core>
+		void sweepCollider(const ColliderIdentifier& identifier, ShapeSweep<Core>& sweep)
+		{
+			if (identifier.type == ColliderType::compound) {
+
+				CompoundCollider& compoundCollider = this->physicsData->compoundColliders[identifier.colliderIndex];
+				if (sweep.entryFraction(compoundCollider.bound) < decimal(0.0)) return;
+
+				for (byte x = 0, len = compoundCollider.components.size(); x < len; ++x) {
+					refreshComponent(this->physicsData, compoundCollider, x);
+					this->sweepCollider(this->physicsData->colliderIdentifiers[compoundCollider.components[x]], sweep);
+				}
+				return;
+			}
+
+			Sweeper<Core> sweeper = { this, sweep, identifier.colliderIndex, identifier.colliderID };
+			dispatch(identifier.type, sweeper);
+		}
+
+		template<typename Core>
+		static void sweepShape(const SphereCollider& collider, const uint32& colliderID, ShapeSweep<Core>& sweep)
+		{
+			if (sweep.entryFraction(collider.bound) >= decimal(0.0)) {
+				sweepCore(sweep, Point(collider.collider.center), collider.collider.radius, colliderID);
+			}
+		}
+
+		template<typename Core>
+		static void sweepShape(const CapsuleCollider& collider, const uint32& colliderID, ShapeSweep<Core>& sweep)
+		{
+			if (sweep.entryFraction(collider.bound) >= decimal(0.0)) {
+				sweepCore(sweep, collider.collider.capsuleLine, collider.collider.radius, colliderID);
+			}
+		}
+
+		template<typename Core>
+		static void sweepShape(const BoxCollider& collider, const uint32& colliderID, ShapeSweep<Core>& sweep)
+		{
+			if (sweep.entryFraction(collider.bound) >= decimal(0.0)) {
+				sweepCore(sweep, collider.collider, decimal(0.0), colliderID);
+			}
+		}
+
+		template<typename Core>
+		static void sweepShape(const ConvexHullCollider& collider, const uint32& colliderID, ShapeSweep<Core>& sweep)
+		{
+			if (sweep.entryFraction(collider.bound) >= decimal(0.0)) {
+				sweepCore(sweep, collider.collider, decimal(0.0), colliderID);
+			}
+		}
+
+		template<typename Core>
+		static void sweepShape(const CompoundCollider& /*collider*/, const uint32& /*colliderID*/, ShapeSweep<Core>& /*sweep*/)
+		{
+			ASSERT(false, "compound colliders are swept against through their components");
+		}
+
+		template<typename Core>
+		static void sweepShape(const TriangleMeshCollider& collider, const uint32& colliderID, ShapeSweep<Core>& sweep)
+		{
+			if (sweep.entryFraction(collider.bound) < decimal(0.0)) return;
+
+			TriangleSweeper<Core> sweeper = { sweep, colliderID };
+			collider.forEachTriangleOverlapped(sweep.sweptBound, sweeper);
+		}
+
+		template<typename Core>
+		static void sweepShape(const HeightFieldCollider& collider, const uint32& colliderID, ShapeSweep<Core>& sweep)
+		{
+			TriangleSweeper<Core> sweeper = { sweep, colliderID };
+			collider.forEachTriangleOverlapped(sweep.sweptBound, sweeper);
+		}
+
+		/*
+			conservative advancement of the core towards the target. the plane through the closest points separates the shapes, so the core
+			can move the gap between them divided by how fast it closes on that plane without passing through the target
+		*/
+		template<typename Core, typename Target>
+		static void sweepCore(ShapeSweep<Core>& sweep, const Target& target, const decimal& targetRadius, const uint32& colliderID)
+		{
+			decimal radius = sweep.radius + targetRadius;
+			decimal t = decimal(0.0);
+			Vec3 normal = sweep.length > mathEPSILON ? -sweep.displacement / sweep.length : Vec3(decimal(0.0), decimal(1.0), decimal(0.0));
+			Vec3 point = nanVEC3;
+
+			for (byte iterations = 0; iterations < MAXIMUM_SWEEP_ITERATIONS; ++iterations) {
+
+				TranslatedShape<Core> moved = { sweep.core, sweep.displacement * t };
+				GJKDistanceResult r = GJKDistance(moved, target, Vec3(), mathEPSILON);
+				if (r.overlap) {
+					point = r.closest2;
+					break;
+				}
+
+				Vec3 separation = r.closest1 - r.closest2;
+				decimal distance = magnitude(separation);
+				if (distance > mathEPSILON) {
+					normal = separation / distance;
+				}
+				point = r.closest2 + normal * targetRadius;
+
+				decimal gap = distance - radius;
+				decimal closingSpeed = -dotProduct(sweep.displacement, normal);
+				if (gap <= sweep.slop) {
+					if (gap >= decimal(0.0) && closingSpeed <= mathEPSILON) return; //touching and moving apart
+					break;
+				}
+				if (closingSpeed <= mathEPSILON) return;
+
+				t += gap / closingSpeed;
+				if (t > sweep.fraction) return;
+			}
+
+			if (t > sweep.fraction) return;
+
+			sweep.fraction = t;
+			sweep.hit.distance = t * sweep.length;
+			sweep.hit.point = point;
+			sweep.hit.normal = normal;
+			sweep.hit.colliderID = colliderID;
+		}
+
+		const ColliderIdentifier* findHeightField() const
+		{
+			const OctreeToHeightFieldLink* link = this->physicsData->octree.heightFieldLink;
+			if (link == nullptr || isAValidIndex(link->heightFieldID) == false) return nullptr;
+
+			return &this->physicsData->colliderIdentifiers[link->heightFieldID];
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		//hit.distance stays -1 on a miss
+		static void setHit(const Ray& ray, const decimal& t, const decimal& maxDistance, const Vec3& normal, RaycastHit& hit)
+		{
+			if (t < decimal(0.0) || t > maxDistance) return;
+
+			hit.distance = t;
+			hit.point = ray.origin + ray.direction * t;
+			hit.normal = dotProduct(normal, ray.direction) > decimal(0.0) ? -normal : normal;
+		}
+
+		static bool missesBound(const Ray& ray, const AABB& bound, const decimal& maxDistance)
+		{
+			return rayEntryTime(ray.origin, getInverseDirection(ray), bound.min, bound.max, maxDistance) < decimal(0.0);
+		}
+
+		void rayCast(const SphereCollider& collider, const Ray& ray, const decimal& maxDistance, const bool& /*anyHit*/, RaycastHit& hit)
+		{
+			if (missesBound(ray, collider.bound, maxDistance)) return;
+
+			decimal t = ray.rayCastTime(collider.collider);
+			if (t < decimal(0.0)) return;
+
+			setHit(ray, t, maxDistance, normalise(ray.origin + ray.direction * t - collider.collider.center), hit);
+		}
+
+		void rayCast(const CapsuleCollider& collider, const Ray& ray, const decimal& maxDistance, const bool& /*anyHit*/, RaycastHit& hit)
+		{
+			if (missesBound(ray, collider.bound, maxDistance)) return;
+
+			decimal t = ray.rayCastTime(collider.collider);
+			if (t < decimal(0.0)) return;
+
+			Vec3 point = ray.origin + ray.direction * t;
+			setHit(ray, t, maxDistance, normalise(point - collider.collider.capsuleLine.closestPoint(point)), hit);
+		}
+
+		void rayCast(const BoxCollider& collider, const Ray& ray, const decimal& maxDistance, const bool& /*anyHit*/, RaycastHit& hit)
+		{
+			if (missesBound(ray, collider.bound, maxDistance)) return;
+
+			decimal t = ray.rayCastTime(collider.collider);
+			if (t < decimal(0.0)) return;
+
+			//the face hit is the one the point is furthest out towards relative to the extents
+			const OBB& obb = collider.collider;
+			Vec3 offset = ray.origin + ray.direction * t - obb.center;
+			Vec3 normal;
+			decimal largest = -decimalMAX;
+			for (byte i = 0; i < 3; ++i) {
+				Vec3 axis = obb.orientation.getColumn(i);
+				decimal d = dotProduct(axis, offset) / obb.halfExtents[i];
+				if (mathABS(d) > largest) {
+					largest = mathABS(d);
+					normal = d < decimal(0.0) ? -axis : axis;
+				}
+			}
+			setHit(ray, t, maxDistance, normal, hit);
+		}
+
+		void rayCast(const ConvexHullCollider& collider, const Ray& ray, const decimal& maxDistance, const bool& /*anyHit*/, RaycastHit& hit)
+		{
+			if (missesBound(ray, collider.bound, maxDistance)) return;
+
+			decimal t = ray.rayCastTime(collider.collider);
+			if (t < decimal(0.0)) return;
+
+			Vec3 point = ray.origin + ray.direction * t;
+			Vec3 normal;
+			decimal largest = -decimalMAX;
+			for (uint32 x = 0, len = collider.collider.halfEdgeMesh.faces.size(); x < len; ++x) {
+				Plane plane = collider.collider.getFacePlane(x);
+				decimal d = plane.getDistanceFromPlane(point);
+				if (d > largest) {
+					largest = d;
+					normal = plane.normal;
+				}
+			}
+			setHit(ray, t, maxDistance, normal, hit);
+		}
+
+		void rayCast(const CompoundCollider& /*collider*/, const Ray& /*ray*/, const decimal& /*maxDistance*/, const bool& /*anyHit*/, RaycastHit& /*hit*/)
+		{
+			ASSERT(false, "compound colliders are cast through their components");
+		}
+
+		void rayCast(const TriangleMeshCollider& collider, const Ray& ray, const decimal& maxDistance, const bool& anyHit, RaycastHit& hit)
+		{
+			if (missesBound(ray, collider.bound, maxDistance)) return;
+
+			Triangle triangle;
+			decimal t = collider.rayCastTime(ray, maxDistance, triangle, anyHit);
+			if (t >= decimal(0.0)) {
+				setHit(ray, t, maxDistance, triangle.toPlane().normal, hit);
+			}
+		}
+
+		void rayCast(const HeightFieldCollider& collider, const Ray& ray, const decimal& maxDistance, const bool& anyHit, RaycastHit& hit)
+		{
+			Triangle triangle;
+			decimal t = collider.rayCastTime(ray, maxDistance, triangle, anyHit);
+			if (t >= decimal(0.0)) {
+				setHit(ray, t, maxDistance, triangle.toPlane().normal, hit);
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		//convex shapes are cast one lane at a time, their single tests have little to share between lanes
+		template<typename Collider>
+		void rayCastPacket(const Collider& collider, const uint32& colliderID, const int32& lanes, PacketCollector& collector)
+		{
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+
+				if ((lanes & (1 << lane)) == 0) continue;
+
+				RaycastHit hit;
+				this->rayCast(collider, collector.packet.rays[lane], decimal(collector.maxT[lane]), collector.anyHit, hit);
+				if (hit.distance >= decimal(0.0)) {
+					hit.colliderID = colliderID;
+					collector.add(lane, hit);
+				}
+			}
+		}
+
+		void rayCastPacket(const TriangleMeshCollider& collider, const uint32& colliderID, const int32& lanes, PacketCollector& collector)
+		{
+			RayPacket packet = collector.packet;
+			Float4 entry;
+			packet.activeMask = lanes & packet.entryTimes(Vec3f(collider.bound.min), Vec3f(collider.bound.max), Float4::load(collector.maxT), entry);
+			if (packet.activeMask == 0) return;
+
+			float maxT[RAY_PACKET_SIZE];
+			Triangle triangles[RAY_PACKET_SIZE];
+			std::memcpy(maxT, collector.maxT, sizeof(maxT));
+
+			addPacketHits(collider.rayCastPacket(packet, maxT, triangles, collector.anyHit), maxT, triangles, colliderID, collector);
+		}
+
+		void rayCastPacket(const HeightFieldCollider& collider, const uint32& colliderID, const int32& lanes, PacketCollector& collector)
+		{
+			RayPacket packet = collector.packet;
+			packet.activeMask = lanes;
+
+			float maxT[RAY_PACKET_SIZE];
+			Triangle triangles[RAY_PACKET_SIZE];
+			std::memcpy(maxT, collector.maxT, sizeof(maxT));
+
+			addPacketHits(collider.rayCastPacket(packet, maxT, triangles, collector.anyHit), maxT, triangles, colliderID, collector);
+		}
+
+		static void addPacketHits(const int32& hitMask, const float* maxT, const Triangle* triangles, const uint32& colliderID, PacketCollector& collector)
+		{
+			for (byte lane = 0; lane < RAY_PACKET_SIZE; ++lane) {
+
+				if ((hitMask & (1 << lane)) == 0) continue;
+
+				RaycastHit hit;
+				setHit(collector.packet.rays[lane], decimal(maxT[lane]), decimalMAX, triangles[lane].toPlane().normal, hit);
+				hit.colliderID = colliderID;
+				collector.add(lane, hit);
+			}
+		}
+	};
+}
+
+#endif
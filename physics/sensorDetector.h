@@ -0,0 +1,211 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef SENSORDETECTOR_H
+#define SENSORDETECTOR_H
+
+#include"colliderDispatch.h"
+
+namespace mech {
+
+	/*
+		sensors are kept out of the octree so they never meet each other, after every step each sensor walks the octree for the moving colliders its bound reaches.
+		a pair is a boolean intersection test between the geometries, no manifold or constraint is made for it.
+		pairs whose body sleeps are kept without a test, pairs that were not found again end with an exit event (also when either collider was erased)
+	*/
+	struct SensorDetector {
+
+		PhysicsData* physicsData = nullptr;
+
+		SensorDetector() {}
+		SensorDetector(const SensorDetector&) = delete;
+		SensorDetector& operator=(const SensorDetector&) = delete;
+
+		void update()
+		{
+			BEGIN_PROFILE("SensorDetector::update");
+
+			this->physicsData->sensorEvents.shallowClear(false);
+
+			if (this->physicsData->sensors.empty() == false && this->physicsData->octree.nodes.empty() == false) {
+
+				HashTable<uint32, uint32> candidates;
+				for (auto it = this->physicsData->sensors.begin(), end = this->physicsData->sensors.end(); it != end; ++it) {
+
+					const ColliderIdentifier& sensor = this->physicsData->colliderIdentifiers[it.data()];
+					const AABB& bound = this->physicsData->getColliderAABB(sensor.colliderID);
+
+					candidates.shallowClear(false);
+					this->findCandidates(0, bound, candidates);
+
+					for (auto it2 = candidates.begin(), end2 = candidates.end(); it2 != end2; ++it2) {
+						this->handlePair(sensor, bound, this->physicsData->colliderIdentifiers[it2.data()]);
+					}
+				}
+			}
+
+			for (auto it = this->physicsData->sensorOverlaps.begin(), end = this->physicsData->sensorOverlaps.end(); it != end;) {
+
+				if (it.data().second == true) {
+					it.data().second = false;
+					++it;
+				}
+				else {
+					auto temp = it.data();
+					++it;
+					this->physicsData->sensorEvents.pushBack(SensorEvent((uint32)(temp.first >> 32), (uint32)temp.first, SensorEventType::exit));
+					this->physicsData->sensorOverlaps.eraseData(temp);
+				}
+			}
+
+			END_PROFILE;
+		}
+
+	private:
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		template<typename Collider1, typename Collider2>
+		static bool collidersIntersect(const Collider1& collider1, const Collider2& collider2)
+		{
+			return collider1.collider.intersects(collider2.collider);
+		}
+
+		template<typename Collider2>
+		static bool collidersIntersect(const CompoundCollider&, const Collider2&)
+		{
+			ASSERT(false, "compound colliders are tested through their components");
+			return false;
+		}
+
+		template<typename Collider1>
+		static bool collidersIntersect(const Collider1&, const CompoundCollider&)
+		{
+			ASSERT(false, "sensors can not be compound colliders");
+			return false;
+		}
+
+		static bool collidersIntersect(const CompoundCollider&, const CompoundCollider&)
+		{
+			ASSERT(false, "sensors can not be compound colliders");
+			return false;
+		}
+
+		//the first type is the body, the second the sensor
+		struct SensorTester {
+			PhysicsData* physicsData;
+			uint32 colliderIndex1;
+			uint32 colliderIndex2;
+			ColliderType type2;
+			bool intersects;
+
+			template<ColliderType type1>
+			void visit()
+			{
+				SecondTypeDispatcher<SensorTester, type1> dispatcher = { *this };
+				dispatchMovable(this->type2, dispatcher);
+			}
+
+			template<ColliderType type1, ColliderType type2>
+			void visit()
+			{
+				this->intersects = collidersIntersect(ColliderTraits<type1>::get(this->physicsData, this->colliderIndex1), ColliderTraits<type2>::get(this->physicsData, this->colliderIndex2));
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		void findCandidates(const uint16& nodeIndex, const AABB& bound, HashTable<uint32, uint32>& candidates)
+		{
+			const Octree::Node& node = this->physicsData->octree.nodes[nodeIndex];
+			if (node.bound.intersects(bound) == false) return;
+
+			if (node.children.empty()) {
+				for (auto it = node.entities.begin(), end = node.entities.end(); it != end; ++it) {
+					if (candidates.find(it.data()) == nullptr) {
+						candidates.insert(it.data());
+					}
+				}
+				return;
+			}
+
+			for (byte x = 0; x < 8; ++x) {
+				if (isAValidIndex(node.children[x].first)) {
+					this->findCandidates(node.children[x].second, bound, candidates);
+				}
+			}
+		}
+
+		void handlePair(const ColliderIdentifier& sensor, const AABB& bound, const ColliderIdentifier& identifier)
+		{
+			if (identifier.state == ColliderMotionState::motionless || this->physicsData->collisionFilter.passesFilters(sensor, identifier) == false) return;
+
+			uint64 key = ((uint64)sensor.colliderID << 32) | identifier.colliderID;
+			Pair<uint64, bool>* overlap = this->physicsData->sensorOverlaps.find(Pair<uint64, bool>(key));
+
+			if (overlap != nullptr && this->physicsData->physicsObjects[identifier.objectIndex].rigidBody.isActive() == false) {
+				overlap->second = true;
+				this->physicsData->sensorEvents.pushBack(SensorEvent(sensor.colliderID, identifier.colliderID, SensorEventType::stay));
+				return;
+			}
+
+			if (this->overlapsSensor(identifier, sensor, bound) == false) return;
+
+			if (overlap != nullptr) {
+				overlap->second = true;
+				this->physicsData->sensorEvents.pushBack(SensorEvent(sensor.colliderID, identifier.colliderID, SensorEventType::stay));
+			}
+			else {
+				this->physicsData->sensorOverlaps.insert(Pair<uint64, bool>(key, true));
+				this->physicsData->sensorEvents.pushBack(SensorEvent(sensor.colliderID, identifier.colliderID, SensorEventType::enter));
+			}
+		}
+
+		bool overlapsSensor(const ColliderIdentifier& identifier, const ColliderIdentifier& sensor, const AABB& bound)
+		{
+			if (identifier.type == ColliderType::compound) {
+
+				CompoundCollider& compoundCollider = this->physicsData->compoundColliders[identifier.colliderIndex];
+				if (compoundCollider.bound.intersects(bound) == false) return false;
+
+				//only the components the tree finds near the sensor are brought up to date and tested
+				HybridArray<uint32, 16, byte> componentIDs;
+				getComponentsOverlapped(this->physicsData, compoundCollider, bound, componentIDs);
+				for (byte x = 0, len = componentIDs.size(); x < len; ++x) {
+					if (this->overlapsSensor(this->physicsData->colliderIdentifiers[componentIDs[x]], sensor, bound)) return true;
+				}
+				return false;
+			}
+
+			if (this->physicsData->getColliderAABB(identifier.colliderID).intersects(bound) == false) return false;
+
+			SensorTester tester = { this->physicsData, identifier.colliderIndex, sensor.colliderIndex, sensor.type, false };
+			dispatchMovable(identifier.type, tester);
+			return tester.intersects;
+		}
+	};
+}
+
+#endif
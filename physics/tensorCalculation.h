@@ -44,6 +44,22 @@ namespace mech {
 		return tensor;
 	}
 
+	//solid box, the principal moments are rotated into the orientation of the box
+	Mat3x3 calculateTensor(const decimal& mass, const OBB& box)
+	{
+		Mat3x3 tensor;
+
+		decimal x = square(box.halfExtents.x);
+		decimal y = square(box.halfExtents.y);
+		decimal z = square(box.halfExtents.z);
+
+		tensor.rowXcol(0, 0) = mass * (y + z) / decimal(3.0);
+		tensor.rowXcol(1, 1) = mass * (x + z) / decimal(3.0);
+		tensor.rowXcol(2, 2) = mass * (x + y) / decimal(3.0);
+
+		return box.orientation * tensor * getTranspose(box.orientation);
+	}
+
 	Mat3x3 calculateTensor(const decimal& mass, const DynamicArray<Vec3, uint32>& points)
 	{
 		Mat3x3 tensor;
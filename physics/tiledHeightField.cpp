@@ -0,0 +1,333 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#include"tiledHeightField.h"
+
+#include<fstream>
+
+#if defined(mechPLATFORM_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include<windows.h>
+#else
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+namespace mech {
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	uint64 getMappingGranularity()
+	{
+#if defined(mechPLATFORM_WINDOWS)
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwAllocationGranularity;
+#else
+		return (uint64)sysconf(_SC_PAGE_SIZE);
+#endif
+	}
+
+	bool MappedFile::open(const char* path)
+	{
+		this->close();
+
+#if defined(mechPLATFORM_WINDOWS)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = GetFileSizeEx(file, &fileSize) ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+		if (mapping == NULL) {
+			CloseHandle(file);
+			return false;
+		}
+
+		this->fileHandle = file;
+		this->mappingHandle = mapping;
+		this->size = (uint64)fileSize.QuadPart;
+#else
+		int32 fd = ::open(path, O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat status;
+		if (fstat(fd, &status) != 0) {
+			::close(fd);
+			return false;
+		}
+
+		this->descriptor = fd;
+		this->size = (uint64)status.st_size;
+#endif
+
+		return this->size != 0;
+	}
+
+	void MappedFile::close()
+	{
+#if defined(mechPLATFORM_WINDOWS)
+		if (this->mappingHandle != nullptr) CloseHandle(this->mappingHandle);
+		if (this->fileHandle != nullptr) CloseHandle(this->fileHandle);
+#else
+		if (this->descriptor >= 0) ::close(this->descriptor);
+#endif
+
+		this->fileHandle = nullptr;
+		this->mappingHandle = nullptr;
+		this->descriptor = -1;
+		this->size = 0;
+	}
+
+	const byte* MappedFile::map(const uint64& offset, const uint64& length, MappedView& view) const
+	{
+		ASSERT(offset + length <= this->size, "range is outside the file");
+
+		uint64 granularity = getMappingGranularity();
+		uint64 first = offset - offset % granularity;
+		uint64 viewSize = offset - first + length;
+
+#if defined(mechPLATFORM_WINDOWS)
+		void* address = MapViewOfFile(this->mappingHandle, FILE_MAP_READ, (DWORD)(first >> 32), (DWORD)(first & 0xFFFFFFFF), (SIZE_T)viewSize);
+		if (address == NULL) return nullptr;
+#else
+		void* address = mmap(nullptr, viewSize, PROT_READ, MAP_PRIVATE, this->descriptor, (off_t)first);
+		if (address == MAP_FAILED) return nullptr;
+#endif
+
+		view.address = address;
+		view.size = viewSize;
+
+		return (const byte*)address + (offset - first);
+	}
+
+	void MappedFile::unmap(MappedView& view) const
+	{
+		if (view.address == nullptr) return;
+
+#if defined(mechPLATFORM_WINDOWS)
+		UnmapViewOfFile(view.address);
+#else
+		munmap(view.address, view.size);
+#endif
+
+		view.address = nullptr;
+		view.size = 0;
+	}
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	bool TiledHeightField::open(const char* path, const TiledHeightFieldSettings& tiledSettings, const PhysicsMaterial& tiledMaterial)
+	{
+		this->close();
+
+		if (this->file.open(path) == false || this->file.size < sizeof(TiledHeightFieldHeader)) {
+			this->file.close();
+			return false;
+		}
+
+		MappedView headerView;
+		const byte* headerData = this->file.map(0, sizeof(TiledHeightFieldHeader), headerView);
+		if (headerData == nullptr) {
+			this->file.close();
+			return false;
+		}
+		std::memcpy(&this->header, headerData, sizeof(TiledHeightFieldHeader));
+		this->file.unmap(headerView);
+
+		uint64 numOfTiles = (uint64)this->header.tilesAlongX * this->header.tilesAlongZ;
+		if (this->header.magic != TILED_HEIGHT_FIELD_MAGIC || this->header.version != TILED_HEIGHT_FIELD_VERSION || this->header.sizeInBytes != this->file.size ||
+			numOfTiles == 0 || this->header.cellsPerTile == 0 || this->header.cellsPerTile >= 65535 ||
+			this->header.pointsAlongX <= (uint64)(this->header.tilesAlongX - 1) * this->header.cellsPerTile + 1 || this->header.pointsAlongX > (uint64)this->header.tilesAlongX * this->header.cellsPerTile + 1 ||
+			this->header.pointsAlongZ <= (uint64)(this->header.tilesAlongZ - 1) * this->header.cellsPerTile + 1 || this->header.pointsAlongZ > (uint64)this->header.tilesAlongZ * this->header.cellsPerTile + 1 ||
+			this->header.tableOffset + numOfTiles * sizeof(TiledHeightFieldRecord) > this->file.size) {
+			this->file.close();
+			return false;
+		}
+
+		this->records = (const TiledHeightFieldRecord*)this->file.map(this->header.tableOffset, numOfTiles * sizeof(TiledHeightFieldRecord), this->tableView);
+		if (this->records == nullptr) {
+			this->file.close();
+			return false;
+		}
+
+		this->settings = tiledSettings;
+		this->material = tiledMaterial;
+		this->frame = 0;
+
+		//the slots never grow past this so the parameters the height fields point to stay put
+		this->tiles.resize(this->settings.maxResidentTiles);
+		for (uint32 x = 0; x < this->settings.maxResidentTiles; ++x) {
+			this->tiles.pushBack(Tile());
+			this->freeSlots.pushBack(this->settings.maxResidentTiles - 1 - x);
+		}
+
+		return true;
+	}
+
+	void TiledHeightField::close()
+	{
+		for (uint32 x = 0, len = this->tiles.size(); x < len; ++x) {
+			this->file.unmap(this->tiles[x].view);
+		}
+		this->tiles.clear();
+		this->freeSlots.clear();
+		this->residentTiles.shallowClear(false);
+
+		this->file.unmap(this->tableView);
+		this->records = nullptr;
+		this->file.close();
+	}
+
+	uint32 TiledHeightField::load(const uint32& tileIndex)
+	{
+		ASSERT(isAValidIndex(this->findSlot(tileIndex)) == false, "tile is already resident");
+
+		if (this->freeSlots.empty()) return -1;
+
+		uint32 numOfPoints = this->header.cellsPerTile + 1;
+		const float* heights = (const float*)this->file.map(this->records[tileIndex].dataOffset, (uint64)numOfPoints * numOfPoints * sizeof(float), this->tiles[this->freeSlots.back()].view);
+		if (heights == nullptr) return -1;
+
+		uint32 slot = this->freeSlots.back();
+		this->freeSlots.popBack();
+
+		Tile& tile = this->tiles[slot];
+		tile.tileIndex = tileIndex;
+		tile.lastUsed = this->frame;
+		tile.bound = this->getTileBound(tileIndex);
+
+		tile.parameters = BumpyTerrainParameters();
+		tile.parameters.heightData = (float*)heights; //read only, HeightField never writes its heights
+		tile.parameters.gridSize = this->header.gridSize;
+		tile.parameters.originX = tile.bound.min.x;
+		tile.parameters.originZ = tile.bound.min.z;
+		tile.parameters.numOfCellsAlongXandZ = (uint16)numOfPoints;
+		tile.parameters.diagonalMode = this->settings.diagonalMode;
+
+		//the padding of tiles at the far edges must not collide, flags also carry the diagonal since they override diagonalMode
+		uint32 cellsAlongX = this->getCellsAlongX(tileIndex % this->header.tilesAlongX);
+		uint32 cellsAlongZ = this->getCellsAlongZ(tileIndex / this->header.tilesAlongX);
+		tile.cellFlags.shallowClear(false);
+		if (cellsAlongX < this->header.cellsPerTile || cellsAlongZ < this->header.cellsPerTile) {
+
+			byte diagonal = this->settings.diagonalMode == TriangleDiagonalMode::twoTothree ? 0b00000010 : 0;
+			tile.cellFlags.reserve(this->header.cellsPerTile * this->header.cellsPerTile);
+			for (uint32 z = 0; z < this->header.cellsPerTile; ++z) {
+				for (uint32 x = 0; x < this->header.cellsPerTile; ++x) {
+					tile.cellFlags.pushBack(x < cellsAlongX && z < cellsAlongZ ? diagonal : 0b00000001);
+				}
+			}
+			tile.parameters.cellFlags = tile.cellFlags.data();
+		}
+
+		tile.collider.collider.initialise(&tile.parameters);
+
+		this->residentTiles.insert(Pair<uint32, uint32>(tileIndex, slot));
+
+		return slot;
+	}
+
+	void TiledHeightField::evict(const uint32& slot)
+	{
+		Tile& tile = this->tiles[slot];
+		ASSERT(isAValidIndex(tile.tileIndex), "slot is not in use");
+
+		this->residentTiles.eraseData(Pair<uint32, uint32>(tile.tileIndex));
+		this->file.unmap(tile.view);
+
+		tile.tileIndex = -1;
+		tile.colliderID = -1;
+		tile.collider.collider.pyramid.clear();
+		this->freeSlots.pushBack(slot);
+	}
+
+	bool TiledHeightField::write(const char* path, const float* heights, const uint32& pointsAlongX, const uint32& pointsAlongZ, const uint32& cellsPerTile, const float& gridSize, const float& originX, const float& originZ)
+	{
+		ASSERT(pointsAlongX > 1 && pointsAlongZ > 1 && cellsPerTile > 0 && cellsPerTile < 65535, "invalid terrain");
+
+		TiledHeightFieldHeader header;
+		header.tilesAlongX = (pointsAlongX - 1 + cellsPerTile - 1) / cellsPerTile;
+		header.tilesAlongZ = (pointsAlongZ - 1 + cellsPerTile - 1) / cellsPerTile;
+		header.cellsPerTile = cellsPerTile;
+		header.pointsAlongX = pointsAlongX;
+		header.pointsAlongZ = pointsAlongZ;
+		header.gridSize = gridSize;
+		header.originX = originX;
+		header.originZ = originZ;
+		header.tableOffset = (sizeof(TiledHeightFieldHeader) + 15) & ~(uint64)15;
+
+		uint32 numOfTiles = header.tilesAlongX * header.tilesAlongZ;
+		uint32 numOfPoints = cellsPerTile + 1;
+		uint64 tileSize = (uint64)numOfPoints * numOfPoints * sizeof(float);
+		uint64 firstTile = (header.tableOffset + numOfTiles * sizeof(TiledHeightFieldRecord) + 15) & ~(uint64)15;
+		header.sizeInBytes = firstTile + numOfTiles * tileSize;
+
+		DynamicArray<TiledHeightFieldRecord, uint32> records;
+		records.reserve(numOfTiles);
+
+		DynamicArray<float, uint32> tileHeights;
+		tileHeights.reserve(numOfPoints * numOfPoints);
+
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		if (stream.is_open() == false) return false;
+
+		//the table is written once the height ranges are known
+		stream.seekp((std::streamoff)firstTile);
+
+		for (uint32 tz = 0; tz < header.tilesAlongZ; ++tz) {
+			for (uint32 tx = 0; tx < header.tilesAlongX; ++tx) {
+
+				TiledHeightFieldRecord& record = records[tz * header.tilesAlongX + tx];
+				record.dataOffset = firstTile + (uint64)(tz * header.tilesAlongX + tx) * tileSize;
+				record.minHeight = FLT_MAX;
+				record.maxHeight = -FLT_MAX;
+
+				//tiles past the edge of the terrain repeat its last row and column, those cells are made holes on load
+				for (uint32 z = 0; z < numOfPoints; ++z) {
+					for (uint32 x = 0; x < numOfPoints; ++x) {
+						uint32 px = mathMIN(tx * cellsPerTile + x, pointsAlongX - 1);
+						uint32 pz = mathMIN(tz * cellsPerTile + z, pointsAlongZ - 1);
+						float h = heights[pz * pointsAlongX + px];
+						tileHeights[z * numOfPoints + x] = h;
+						record.minHeight = h < record.minHeight ? h : record.minHeight;
+						record.maxHeight = h > record.maxHeight ? h : record.maxHeight;
+					}
+				}
+
+				stream.write((const char*)tileHeights.data(), tileSize);
+			}
+		}
+
+		stream.seekp(0);
+		stream.write((const char*)&header, sizeof(TiledHeightFieldHeader));
+		stream.seekp((std::streamoff)header.tableOffset);
+		stream.write((const char*)records.data(), numOfTiles * sizeof(TiledHeightFieldRecord));
+
+		return stream.good();
+	}
+}
@@ -0,0 +1,218 @@
+/*
+	MIT License
+
+	Copyright (c) 2024 Ssebunya Umar
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+//@ssebunya_umar - X(twitter)
+
+#ifndef TILEDHEIGHTFIELD_H
+#define TILEDHEIGHTFIELD_H
+
+#include"collision/collider.h"
+#include"../containers/hashTable.h"
+#include"../containers/pair.h"
+
+namespace mech {
+
+#define TILED_HEIGHT_FIELD_MAGIC 0x454C4954 //"TILE"
+#define TILED_HEIGHT_FIELD_VERSION 2
+
+	/*
+		--------------tiled heightField file-----------------
+		TiledHeightFieldHeader
+		TiledHeightFieldRecord per tile, row by row along x
+		heights of every tile, (cellsPerTile + 1) x (cellsPerTile + 1) floats laid out like BumpyTerrainParameters::heightData
+
+		neighbouring tiles both keep the row of heights along their shared edge so the triangles on either side meet exactly,
+		a query reaching across an edge pairs with every tile it overlaps. tiles at the far edges are padded up to cellsPerTile,
+		the padded cells are holes once loaded
+	*/
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct TiledHeightFieldHeader {
+		uint32 magic = TILED_HEIGHT_FIELD_MAGIC;
+		uint32 version = TILED_HEIGHT_FIELD_VERSION;
+		uint32 tilesAlongX = 0;
+		uint32 tilesAlongZ = 0;
+		uint32 cellsPerTile = 0; //along x and z
+		uint32 pointsAlongX = 0; //of the whole terrain
+		uint32 pointsAlongZ = 0;
+		float gridSize = 0.0;
+		float originX = 0.0; //corner of the first cell
+		float originZ = 0.0;
+		uint64 tableOffset = 0;
+		uint64 sizeInBytes = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct TiledHeightFieldRecord {
+		uint64 dataOffset = 0;
+		float minHeight = 0.0;
+		float maxHeight = 0.0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct MappedView {
+		void* address = nullptr;
+		uint64 size = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	//read only file whose ranges are mapped into memory on demand, the pages are brought in by the OS as they are touched
+	struct MappedFile {
+
+		void* fileHandle = nullptr; //windows
+		void* mappingHandle = nullptr; //windows
+		int32 descriptor = -1;
+		uint64 size = 0;
+
+		MappedFile() {}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { this->close(); }
+
+		bool open(const char* path);
+		void close();
+		bool isOpen() const { return this->size != 0; }
+
+		//returns the address of offset, the view starts at the allocation boundary below it
+		const byte* map(const uint64& offset, const uint64& length, MappedView& view) const;
+		void unmap(MappedView& view) const;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct TiledHeightFieldSettings {
+		uint32 maxResidentTiles = 64;
+		float streamingMargin = 8.0; //tiles within this distance of a body are kept in memory
+		TriangleDiagonalMode diagonalMode = TriangleDiagonalMode::oneToFour;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/*
+		terrain too large to keep in memory, split into square tiles stored in a file.
+		the tiles around bodies are mapped in and each resident tile is a HeightFieldCollider registered on its own, when the
+		budget of resident tiles is reached the tile used least recently is evicted. only the header is read, the table of
+		tiles stays mapped so memory follows the bodies rather than the size of the terrain
+	*/
+	struct TiledHeightField {
+
+		struct Tile {
+			HeightFieldCollider collider;
+			BumpyTerrainParameters parameters;
+			MappedView view;
+			AABB bound;
+			uint32 tileIndex = -1;
+			uint32 colliderID = -1;
+			uint64 lastUsed = 0; //frame the tile was last near a body
+			DynamicArray<byte, uint32> cellFlags; //only used by tiles at the far edges, their padded cells are holes
+		};
+
+		MappedFile file;
+		MappedView tableView;
+		TiledHeightFieldHeader header;
+		const TiledHeightFieldRecord* records = nullptr;
+		TiledHeightFieldSettings settings;
+		PhysicsMaterial material;
+
+		DynamicArray<Tile, uint32> tiles; //slots, sized once so HeightField::bumpy stays valid
+		HashTable<Pair<uint32, uint32>, uint32> residentTiles; //HashTable<Pair<tile index, slot>............
+		DynamicArray<uint32, uint32> freeSlots;
+		uint64 frame = 0;
+
+		TiledHeightField() {}
+		TiledHeightField(const TiledHeightField&) = delete;
+		TiledHeightField& operator=(const TiledHeightField&) = delete;
+		~TiledHeightField() { this->close(); }
+
+		bool open(const char* path, const TiledHeightFieldSettings& tiledSettings, const PhysicsMaterial& tiledMaterial);
+		void close();
+		bool isOpen() const { return this->records != nullptr; }
+
+		float getTileWorldSize() const { return this->header.cellsPerTile * this->header.gridSize; }
+
+		AABB getTileBound(const uint32& tileIndex) const
+		{
+			uint32 tx = tileIndex % this->header.tilesAlongX;
+			uint32 tz = tileIndex / this->header.tilesAlongX;
+			float size = this->getTileWorldSize();
+
+			return AABB(Vec3(this->header.originX + tx * size, this->records[tileIndex].minHeight, this->header.originZ + tz * size),
+				Vec3(this->header.originX + this->getCellsAlongX(tx) * this->header.gridSize + tx * size, this->records[tileIndex].maxHeight, this->header.originZ + this->getCellsAlongZ(tz) * this->header.gridSize + tz * size));
+		}
+
+		//cells of the terrain a tile covers, fewer than cellsPerTile for the last column and row of tiles
+		uint32 getCellsAlongX(const uint32& tx) const { return mathMIN(this->header.cellsPerTile, this->header.pointsAlongX - 1 - tx * this->header.cellsPerTile); }
+		uint32 getCellsAlongZ(const uint32& tz) const { return mathMIN(this->header.cellsPerTile, this->header.pointsAlongZ - 1 - tz * this->header.cellsPerTile); }
+
+		//indices of the tiles under the aabb, the aabb is not tested against their heights
+		template<typename Indices>
+		void getTilesOverlapped(const AABB& aabb, Indices& tileIndices) const
+		{
+			float size = this->getTileWorldSize();
+			float minX = (aabb.min.x - this->header.originX) / size;
+			float maxX = (aabb.max.x - this->header.originX) / size;
+			float minZ = (aabb.min.z - this->header.originZ) / size;
+			float maxZ = (aabb.max.z - this->header.originZ) / size;
+			if (maxX < 0 || maxZ < 0 || minX >= this->header.tilesAlongX || minZ >= this->header.tilesAlongZ) return;
+
+			uint32 x0 = (uint32)mathMAX(minX, 0.0);
+			uint32 z0 = (uint32)mathMAX(minZ, 0.0);
+			uint32 x1 = (uint32)mathMIN(maxX, this->header.tilesAlongX - 1);
+			uint32 z1 = (uint32)mathMIN(maxZ, this->header.tilesAlongZ - 1);
+
+			for (uint32 z = z0; z <= z1; ++z) {
+				for (uint32 x = x0; x <= x1; ++x) {
+					tileIndices.pushBack(z * this->header.tilesAlongX + x);
+				}
+			}
+		}
+
+		uint32 findSlot(const uint32& tileIndex)
+		{
+			Pair<uint32, uint32>* resident = this->residentTiles.find(Pair<uint32, uint32>(tileIndex));
+			return resident != nullptr ? resident->second : (uint32)-1;
+		}
+
+		//least recently used slot that was not needed this frame, -1 if every resident tile is in use
+		uint32 getEvictionCandidate() const
+		{
+			uint32 candidate = -1;
+			uint64 oldest = this->frame;
+			for (uint32 x = 0, len = this->tiles.size(); x < len; ++x) {
+				if (isAValidIndex(this->tiles[x].tileIndex) && this->tiles[x].lastUsed < oldest) {
+					oldest = this->tiles[x].lastUsed;
+					candidate = x;
+				}
+			}
+			return candidate;
+		}
+
+		uint32 load(const uint32& tileIndex); //maps the tile into a free slot and returns the slot, -1 when no slot is free
+		void evict(const uint32& slot);
+
+		//writes heights laid out like BumpyTerrainParameters::heightData, pointsAlongX x pointsAlongZ, as tiles of cellsPerTile x cellsPerTile cells
+		static bool write(const char* path, const float* heights, const uint32& pointsAlongX, const uint32& pointsAlongZ, const uint32& cellsPerTile, const float& gridSize, const float& originX = 0.0, const float& originZ = 0.0);
+	};
+}
+
+#endif
@@ -28,15 +28,17 @@
 #ifndef TIMEOTIMPACT_H
 #define TIMEOFIMPACT_H
 
-#include"physicsData.h"
+#include"colliderDispatch.h"
 #include"../geometry/algorithms/GJK.h"
+#include"../geometry/plane.h"
 
 namespace mech {
 
 #define MAXIMUM_ITERATIONS 20
+#define ANALYTIC_TOI_ROTATION_TOLERANCE decimal(0.9999) //cosine of half the rotation over the step above which a convex hull is swept with conservative advancement
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
-	enum class TOIState : byte { overlaping = 1 << 0, separated = 1 << 1 };
+	enum class TOIState : byte { overlaping = 1 << 0, separated = 1 << 1, unresolved = 1 << 2 };
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct TOIResult {
@@ -44,6 +46,21 @@ namespace mech {
 		TOIState state = TOIState::separated;
 	};
 
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct TOIEvent {
+		decimal t = decimalMAX; //fraction of the whole step, events are handled in this order
+		decimal fraction = decimalMAX; //fraction of the sweep that found the event
+		decimal start = decimal(0.0); //fraction of the step the sweep began at
+		uint32 objectIndex = -1;
+		uint32 colliderID = -1; //collider that is hit
+		uint32 version1 = 0; //motion versions of the body and of the collider hit when the sweep was made
+		uint32 version2 = 0;
+		TOIState state = TOIState::separated;
+		byte count = 0; //events already handled for the body during this step
+
+		bool operator<(const TOIEvent& other) const { return this->t < other.t; }
+	};
+
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////
 	struct TimeOfImpact {
@@ -55,6 +72,8 @@ namespace mech {
 		};
 
 		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		//Evaluator supplies distance(t) and setSupportPoints(axis), both are resolved at compile time
+		template<typename Evaluator>
 		struct SeparationEvaluator {
 
 			Vec3 axis;
@@ -63,10 +82,6 @@ namespace mech {
 			Transform3DRange transform1;
 			Transform3DRange transform2;
 			TimeOfImpact* timeOfImpact = nullptr;
-			Vec3(TimeOfImpact::** supportPtrs) (const ColliderIdentifier&, const Vec3&) = nullptr;
-
-			virtual DistanceResult distance(const decimal& t) = 0;
-			virtual void setSupportPoints(const Vec3& axis) = 0;
 
 			void renewAxis(const DistanceResult& d)
 			{
@@ -77,7 +92,7 @@ namespace mech {
 			{
 				Transform3D tA = this->transform1.interpolate(t);
 				Vec3 a = tA.orientation * this->axis;
-				this->setSupportPoints(a);
+				static_cast<Evaluator*>(this)->setSupportPoints(a);
 				return dotProduct(this->transform2.interpolate(t) * this->support2 - tA * this->support1, a);
 			}
 
@@ -89,87 +104,71 @@ namespace mech {
 
 		};
 
-		struct EvaluatorCommon : public SeparationEvaluator {
+		template<ColliderType type1, ColliderType type2>
+		struct EvaluatorCommon : public SeparationEvaluator<EvaluatorCommon<type1, type2>> {
 
 			ColliderIdentifier identifier1;
 			ColliderIdentifier identifier2;
-			DistanceResult(TimeOfImpact::** distancePtrs) (const ColliderIdentifier&, const ColliderIdentifier&, const Transform3DRange&, const Transform3DRange&, const decimal&) = nullptr;
 
-			DistanceResult distance(const decimal& t) override
+			DistanceResult distance(const decimal& t)
 			{
-				return (timeOfImpact->*distancePtrs[(uint32)(identifier1.type) + ((uint32)(identifier2.type) * 3)])(identifier1, identifier2, transform1, transform2, t);
+				return this->timeOfImpact->distance(ColliderTraits<type1>::get(this->timeOfImpact->physicsData, this->identifier1.colliderIndex).collider.transformed(this->transform1.interpolate(t)), ColliderTraits<type2>::get(this->timeOfImpact->physicsData, this->identifier2.colliderIndex).collider.transformed(this->transform2.interpolate(t)));
 			}
 
-			void setSupportPoints(const Vec3 & axis) override
+			void setSupportPoints(const Vec3 & axis)
 			{
-				this->support1 = (timeOfImpact->*supportPtrs[(uint32)(identifier1.type)])(identifier1, axis);
-				this->support2 = (timeOfImpact->*supportPtrs[(uint32)(identifier2.type)])(identifier2, -axis);
+				this->support1 = ColliderTraits<type1>::get(this->timeOfImpact->physicsData, this->identifier1.colliderIndex).collider.getSupportPoint(axis);
+				this->support2 = ColliderTraits<type2>::get(this->timeOfImpact->physicsData, this->identifier2.colliderIndex).collider.getSupportPoint(-axis);
 			}
 		};
 
-		struct EvaluatorTriangle : public SeparationEvaluator {
+		template<ColliderType type1>
+		struct EvaluatorTriangle : public SeparationEvaluator<EvaluatorTriangle<type1>> {
 
 			ColliderIdentifier identifier1;
 			Triangle triangle;
-			DistanceResult(TimeOfImpact::** triangleDistancePtrs) (const ColliderIdentifier&, const Triangle&, const Transform3DRange&, const decimal&) = nullptr;
 
-			DistanceResult distance(const decimal& t) override
+			DistanceResult distance(const decimal& t)
 			{
-				return (timeOfImpact->*triangleDistancePtrs[(uint32)(identifier1.type)])(identifier1, triangle, transform1, t);
+				return this->timeOfImpact->distance(ColliderTraits<type1>::get(this->timeOfImpact->physicsData, this->identifier1.colliderIndex).collider.transformed(this->transform1.interpolate(t)), this->triangle);
 			}
 
-			void setSupportPoints(const Vec3& axis) override
+			void setSupportPoints(const Vec3& axis)
 			{
-				this->support1 = (timeOfImpact->*supportPtrs[(uint32)(identifier1.type)])(identifier1, axis);
-				this->support2 = triangle.getSupportPoint(-axis);
+				this->support1 = ColliderTraits<type1>::get(this->timeOfImpact->physicsData, this->identifier1.colliderIndex).collider.getSupportPoint(axis);
+				this->support2 = this->triangle.getSupportPoint(-axis);
 			}
 		};
 
 		//////////////////////////////////////////////////////////////////////////////////////////////////////////
-		PhysicsData* physicsData = nullptr;
-		
-		bool (TimeOfImpact::* overlapTestPtrs[3]) (const AABB&, const ColliderIdentifier&) = {};
-		DistanceResult (TimeOfImpact::* distancePtrs[9]) (const ColliderIdentifier&, const ColliderIdentifier&, const Transform3DRange&, const Transform3DRange&, const decimal&) = {};
-		DistanceResult (TimeOfImpact::* triangleDistancePtrs[3]) (const ColliderIdentifier&, const Triangle&, const Transform3DRange&, const decimal&) = {};
-		Vec3 (TimeOfImpact::* supportPtrs[3]) (const ColliderIdentifier&, const Vec3&) = {};
+		//the core of a sphere (pointA == pointB) or capsule at the start of the step and its translation over the step
+		struct SweptCore {
+			Vec3 pointA;
+			Vec3 pointB;
+			Vec3 displacement;
+			decimal radius = decimal(0.0);
+		};
 
-		TimeOfImpact()
-		{
-			this->overlapTestPtrs[0] = &TimeOfImpact::overlapConvexHull;
-			this->overlapTestPtrs[1] = &TimeOfImpact::overlapSphere;
-			this->overlapTestPtrs[2] = &TimeOfImpact::overlapCapsule;
-
-			this->distancePtrs[0] = &TimeOfImpact::convexHullVsConvexHullDistance;
-			this->distancePtrs[1] = &TimeOfImpact::sphereVsConvexHullDistance;
-			this->distancePtrs[2] = &TimeOfImpact::capsuleVsConvexHullDistance;
-			this->distancePtrs[3] = &TimeOfImpact::convexHullVsSphereDistance;
-			this->distancePtrs[4] = &TimeOfImpact::sphereVsSphereDistance;
-			this->distancePtrs[5] = &TimeOfImpact::capsuleVsSphereDistance;
-			this->distancePtrs[6] = &TimeOfImpact::convexHullVsCapsuleDistance;
-			this->distancePtrs[7] = &TimeOfImpact::sphereVsCapsuleDistance;
-			this->distancePtrs[8] = &TimeOfImpact::capsuleVsCapsuleDistance;
-
-			this->triangleDistancePtrs[0] = &TimeOfImpact::convexHullVsTriangleDistance;
-			this->triangleDistancePtrs[1] = &TimeOfImpact::sphereVsTriangleDistance;
-			this->triangleDistancePtrs[2] = &TimeOfImpact::capsuleVsTriangleDistance;
-
-			this->supportPtrs[0] = &TimeOfImpact::convexHullSupport;
-			this->supportPtrs[1] = &TimeOfImpact::sphereSupport;
-			this->supportPtrs[2] = &TimeOfImpact::capsuleSupport;
-		}
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////
+		PhysicsData* physicsData = nullptr;
+		uint32 iterations = 0; //iterations spent during the current step, checked against PhysicsSettings::maxTOIIterations
 
-		TOIResult toiFunction(SeparationEvaluator* sEvaluator, const decimal& tolerance)
+		template<typename Evaluator>
+		TOIResult toiFunction(Evaluator& evaluator, const decimal& tolerance)
 		{
 			BEGIN_PROFILE("TimeOfImpact::toiFunction");
 
 			TOIResult result;
 
 			decimal t1 = decimal(0.0);
+			uint32 work = 0;
 
 			byte toiIterations = 0;
 			while (toiIterations < MAXIMUM_ITERATIONS) {
 
-				DistanceResult r = sEvaluator->distance(t1);
+				++work;
+
+				DistanceResult r = evaluator.distance(t1);
 
 				if (r.overlap == true || magnitudeSq(r.closest2 - r.closest1) <= tolerance) {
 					result.state = TOIState::overlaping;
@@ -179,13 +178,15 @@ namespace mech {
 
 				bool terminate = false;
 
-				sEvaluator->renewAxis(r);
+				evaluator.renewAxis(r);
 
 				decimal t2 = decimal(1.0);
 				byte deepestPointIterations = 0;
 				while (deepestPointIterations < MAXIMUM_ITERATIONS) {
 
-					decimal s2 = sEvaluator->calculateSeparation(t2);
+					++work;
+
+					decimal s2 = evaluator.calculateSeparation(t2);
 
 					if (s2 > tolerance) {
 						result.state = TOIState::separated;
@@ -199,7 +200,7 @@ namespace mech {
 						break;
 					}
 
-					decimal s1 = sEvaluator->reCalculateSeparation(t1);
+					decimal s1 = evaluator.reCalculateSeparation(t1);
 
 					if (s1 < -tolerance || s1 <= tolerance) {
 						result.state = TOIState::overlaping;
@@ -213,6 +214,8 @@ namespace mech {
 					byte rootIterations = 0;
 					while (rootIterations < MAXIMUM_ITERATIONS) {
 
+						++work;
+
 						decimal t;
 						if (rootIterations & 1) {
 							t = rootT1 + (-s1) * (rootT2 - rootT1) / (s2 - s1);
@@ -221,7 +224,7 @@ namespace mech {
 							t = decimal(0.5) * (rootT1 + rootT2);
 						}
 
-						decimal s = sEvaluator->reCalculateSeparation(t);
+						decimal s = evaluator.reCalculateSeparation(t);
 
 						if (mathABS(s) < tolerance) {
 							t2 = t;
@@ -251,167 +254,339 @@ namespace mech {
 
 			ASSERT(toiIterations < MAXIMUM_ITERATIONS, "toiFunction has failed!!");
 
+			this->iterations += work;
+
 			END_PROFILE;
 			return result;
 		}
 
+		bool hasBudget()
+		{
+			return this->iterations < this->physicsData->settings.maxTOIIterations;
+		}
+
+		template<ColliderType type1, ColliderType type2>
 		TOIResult toi(const AABB& aabbCast, const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2)
 		{
-			if ((this->*overlapTestPtrs[(uint32)(identifier2.type)])(aabbCast, identifier2)) {
+			if (this->hasBudget() == false) {
+				TOIResult result;
+				result.state = TOIState::unresolved;
+				return result;
+			}
+
+			if (aabbCast.intersects(ColliderTraits<type2>::get(this->physicsData, identifier2.colliderIndex).bound)) {
+
+				TOIResult result;
+				if (this->analyticTOI(identifier1, identifier2, transform1, transform2, result)) {
+					return result;
+				}
 				
-				EvaluatorCommon evaluator;
+				EvaluatorCommon<type1, type2> evaluator;
 
 				evaluator.identifier1 = identifier1;
 				evaluator.identifier2 = identifier2;
 				evaluator.transform1 = transform1;
 				evaluator.transform2 = transform2;
 				evaluator.timeOfImpact = this;
-				evaluator.distancePtrs = this->distancePtrs;
-				evaluator.supportPtrs = this->supportPtrs;
 
-				return this->toiFunction(&evaluator, decimal(0.01));
+				return this->toiFunction(evaluator, decimal(0.01));
 			}
 
 			return TOIResult();
 		}
 
+		template<ColliderType type1>
 		TOIResult toi(const ColliderIdentifier& identifier, const Triangle& triangle, const Transform3DRange& transform)
 		{
-			EvaluatorTriangle evaluator;
+			if (this->hasBudget() == false) {
+				TOIResult result;
+				result.state = TOIState::unresolved;
+				return result;
+			}
+
+			if (type1 == ColliderType::sphere || type1 == ColliderType::capsule) {
+
+				SweptCore core = this->getSweptCore(identifier, transform);
+
+				decimal t = this->sweepPointVsInflatedPolygon(core.pointA, core.displacement, triangle.vertices, 3, core.radius);
+				if (type1 == ColliderType::capsule) {
+
+					t = this->earliest(t, this->sweepPointVsInflatedPolygon(core.pointB, core.displacement, triangle.vertices, 3, core.radius));
+					for (byte x = 0; x < 3; ++x) {
+						t = this->earliest(t, this->sweepSegmentVsSegment(core.pointA, core.pointB, core.displacement, triangle.vertices[x], triangle.vertices[(x + 1) % 3], core.radius));
+					}
+				}
+
+				return this->toTOIResult(t);
+			}
+
+			EvaluatorTriangle<type1> evaluator;
 
 			evaluator.triangle = triangle;
 			evaluator.identifier1 = identifier;
 			evaluator.transform1 = transform;
 			evaluator.timeOfImpact = this;
-			evaluator.supportPtrs = this->supportPtrs;
-			evaluator.triangleDistancePtrs = this->triangleDistancePtrs;
 
-			return this->toiFunction(&evaluator, decimal(0.01));
+			return this->toiFunction(evaluator, decimal(0.01));
 		}
 
-		bool overlapConvexHull(const AABB& aabbCast, const ColliderIdentifier& identifier)
+		//closed form sweeps for spheres and capsules, conservative advancement is left to convex hulls that rotate or are swept against each other
+		bool analyticTOI(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, TOIResult& result)
 		{
-			return aabbCast.intersects(this->physicsData->convexHullColliders[identifier.colliderIndex].bound);
+			bool round1 = identifier1.type == ColliderType::sphere || identifier1.type == ColliderType::capsule;
+			bool round2 = identifier2.type == ColliderType::sphere || identifier2.type == ColliderType::capsule;
+
+			if (round1 == false && round2 == false) return false;
+
+			BEGIN_PROFILE("TimeOfImpact::analyticTOI");
+
+			if (round1 && round2) {
+
+				SweptCore core1 = this->getSweptCore(identifier1, transform1);
+				SweptCore core2 = this->getSweptCore(identifier2, transform2);
+
+				result = this->toTOIResult(this->sweepSegmentVsSegment(core1.pointA, core1.pointB, core1.displacement - core2.displacement, core2.pointA, core2.pointB, core1.radius + core2.radius));
+
+				END_PROFILE;
+				return true;
+			}
+
+			const ColliderIdentifier& roundIdentifier = round1 ? identifier1 : identifier2;
+			const ColliderIdentifier& hullIdentifier = round1 ? identifier2 : identifier1;
+			const Transform3DRange& roundTransform = round1 ? transform1 : transform2;
+			const Transform3DRange& hullTransform = round1 ? transform2 : transform1;
+
+			if (hullIdentifier.type != ColliderType::convexHull || mathABS(dotProduct(hullTransform.transform1.orientation, hullTransform.transform2.orientation)) < ANALYTIC_TOI_ROTATION_TOLERANCE) {
+				END_PROFILE;
+				return false;
+			}
+
+			//the hull only translates, sweep the core against the hull where it ends the step
+			SweptCore core = this->getSweptCore(roundIdentifier, roundTransform);
+			Vec3 hullDisplacement = hullTransform.transform2.position - hullTransform.transform1.position;
+
+			result = this->toTOIResult(this->sweepSegmentVsConvexHull(core.pointA + hullDisplacement, core.pointB + hullDisplacement, core.displacement - hullDisplacement, core.radius, this->physicsData->convexHullColliders[hullIdentifier.colliderIndex].collider));
+
+			END_PROFILE;
+			return true;
 		}
 
-		bool overlapSphere(const AABB& aabbCast, const ColliderIdentifier& identifier)
+		SweptCore getSweptCore(const ColliderIdentifier& identifier, const Transform3DRange& transform)
 		{
-			return aabbCast.intersects(this->physicsData->sphereColliders[identifier.colliderIndex].bound);
+			//colliders are stored where the body ends the step
+			Transform3D toStart = transform.transform1 * getInverse(transform.transform2);
+
+			SweptCore core;
+			if (identifier.type == ColliderType::sphere) {
+
+				const Sphere& sphere = this->physicsData->sphereColliders[identifier.colliderIndex].collider;
+
+				core.pointA = core.pointB = toStart * sphere.center;
+				core.displacement = sphere.center - core.pointA;
+				core.radius = sphere.radius;
+			}
+			else {
+
+				const Capsule& capsule = this->physicsData->capsuleColliders[identifier.colliderIndex].collider;
+
+				core.pointA = toStart * capsule.pointA;
+				core.pointB = toStart * capsule.pointB;
+				core.displacement = (capsule.pointA + capsule.pointB - core.pointA - core.pointB) * decimal(0.5);
+
+				//the capsule is swept without rotating, grow it by how far its end points stray from a pure translation
+				decimal deviationSq = mathMAX(magnitudeSq(capsule.pointA - (core.pointA + core.displacement)), magnitudeSq(capsule.pointB - (core.pointB + core.displacement)));
+				core.radius = capsule.radius + mathSQRT(deviationSq);
+			}
+
+			return core;
 		}
 
-		bool overlapCapsule(const AABB& aabbCast, const ColliderIdentifier& identifier)
+		decimal earliest(const decimal& t1, const decimal& t2)
 		{
-			return aabbCast.intersects(this->physicsData->capsuleColliders[identifier.colliderIndex].bound);
+			if (t1 < decimal(0.0)) return t2;
+			if (t2 < decimal(0.0)) return t1;
+			return mathMIN(t1, t2);
 		}
 
-		DistanceResult convexHullVsConvexHullDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
+		TOIResult toTOIResult(const decimal& t)
 		{
-			GJKDistanceResult r = GJKDistance(this->physicsData->convexHullColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t)), this->physicsData->convexHullColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t)));
-
-			DistanceResult s;
-			s.closest1 = r.closest1;
-			s.closest2 = r.closest2;
-			s.overlap = r.overlap;
-			return s;
+			TOIResult result;
+			if (t >= decimal(0.0)) {
+				result.t = t;
+				result.state = TOIState::overlaping;
+			}
+			return result;
 		}
 
-		DistanceResult convexHullVsSphereDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
+		//the sweeps below return the first t in [0, 1] at which the moving point / core touches, -1 if it never does
+
+		decimal sweepPointVsSphere(const Vec3& origin, const Vec3& direction, const Vec3& center, const decimal& radius)
 		{
-			Sphere sphere = this->physicsData->sphereColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t));
+			Vec3 m = origin - center;
+			decimal c = magnitudeSq(m) - square(radius);
+			if (c <= decimal(0.0)) return decimal(0.0);
 
-			DistanceResult s;
-			s.closest1 = this->physicsData->convexHullColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t)).closestPoint(sphere.center);
-			s.closest2 = sphere.closestPoint(s.closest1);
-			s.overlap = magnitudeSq(s.closest1 - sphere.center) < square(sphere.radius);
-			return s;
-		}
+			decimal b = dotProduct(m, direction);
+			if (b >= decimal(0.0)) return decimal(-1.0);
 
-		DistanceResult convexHullVsCapsuleDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
-		{
-			Capsule capsule = this->physicsData->capsuleColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t));
+			decimal a = magnitudeSq(direction);
+			decimal discriminant = b * b - a * c;
+			if (discriminant < decimal(0.0)) return decimal(-1.0);
 
-			DistanceResult s;
-			s.closest1 = this->physicsData->convexHullColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t)).closestPoint(capsule.capsuleLine);
-			s.closest2 = capsule.closestPoint(s.closest1);
-			s.overlap = magnitudeSq(s.closest1 - capsule.capsuleLine.closestPoint(s.closest1)) < square(capsule.radius);
-			return s;
+			decimal t = (-b - mathSQRT(discriminant)) / a;
+			return t <= decimal(1.0) ? t : decimal(-1.0);
 		}
 
-		DistanceResult sphereVsConvexHullDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
+		decimal sweepPointVsCapsule(const Vec3& origin, const Vec3& direction, const Vec3& pointA, const Vec3& pointB, const decimal& radius)
 		{
-			Sphere sphere = this->physicsData->sphereColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t));
+			Vec3 ab = pointB - pointA;
+			decimal abLengthSq = magnitudeSq(ab);
+			if (abLengthSq < mathEPSILON) {
+				return this->sweepPointVsSphere(origin, direction, pointA, radius);
+			}
 
-			DistanceResult s;
-			s.closest2 = this->physicsData->convexHullColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t)).closestPoint(sphere.center);
-			s.closest1 = sphere.closestPoint(s.closest2);
-			s.overlap = magnitudeSq(s.closest2 - sphere.center) < square(sphere.radius);
-			return s;
-		}
+			Vec3 ao = origin - pointA;
+			decimal s0 = clamp(dotProduct(ao, ab) / abLengthSq, decimal(0.0), decimal(1.0));
+			if (magnitudeSq(ao - ab * s0) <= square(radius)) return decimal(0.0);
 
-		DistanceResult sphereVsSphereDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
-		{
-			Sphere sphere1 = this->physicsData->sphereColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t));
-			Sphere sphere2 = this->physicsData->sphereColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t));
+			decimal t = decimal(-1.0);
 
-			DistanceResult s;
-			s.closest1 = sphere1.closestPoint(sphere2.center);
-			s.closest2 = sphere2.closestPoint(s.closest1);
-			s.overlap = magnitudeSq(sphere1.center - sphere2.center) < square(sphere1.radius + sphere2.radius);
-			return s;
-		}
+			//infinite cylinder around the segment
+			Vec3 directionPerp = direction - ab * (dotProduct(direction, ab) / abLengthSq);
+			Vec3 aoPerp = ao - ab * (dotProduct(ao, ab) / abLengthSq);
 
-		DistanceResult sphereVsCapsuleDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
-		{
-			Sphere sphere = this->physicsData->sphereColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t));
-			Capsule capsule = this->physicsData->capsuleColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t));
+			decimal a = magnitudeSq(directionPerp);
+			if (a > mathEPSILON) {
 
-			DistanceResult s;
-			s.closest2 = capsule.closestPoint(sphere.center);
-			s.closest1 = sphere.closestPoint(s.closest2);
-			s.overlap = magnitudeSq(sphere.center - capsule.capsuleLine.closestPoint(sphere.center)) < square(sphere.radius + capsule.radius);
-			return s;
+				decimal b = dotProduct(directionPerp, aoPerp);
+				decimal c = magnitudeSq(aoPerp) - square(radius);
+				decimal discriminant = b * b - a * c;
+
+				if (discriminant >= decimal(0.0)) {
+
+					decimal tc = (-b - mathSQRT(discriminant)) / a;
+					if (tc >= decimal(0.0) && tc <= decimal(1.0)) {
+
+						decimal s = dotProduct(ao + direction * tc, ab) / abLengthSq;
+						if (s >= decimal(0.0) && s <= decimal(1.0)) {
+							t = tc;
+						}
+					}
+				}
+			}
+
+			//end caps
+			t = this->earliest(t, this->sweepPointVsSphere(origin, direction, pointA, radius));
+			t = this->earliest(t, this->sweepPointVsSphere(origin, direction, pointB, radius));
+
+			return t;
 		}
 
-		DistanceResult capsuleVsConvexHullDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
+		//vertices of the convex polygon are counterclockwise
+		decimal sweepPointVsInflatedPolygon(const Vec3& origin, const Vec3& direction, const Vec3* vertices, const byte& count, const decimal& radius)
 		{
-			Capsule capsule = this->physicsData->capsuleColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t));
+			decimal t = decimal(-1.0);
 
-			DistanceResult s;
-			s.closest2 = this->physicsData->convexHullColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t)).closestPoint(capsule.capsuleLine);
-			s.closest1 = capsule.closestPoint(s.closest2);
-			s.overlap = magnitudeSq(s.closest2 - capsule.capsuleLine.closestPoint(s.closest2)) < square(capsule.radius);
-			return s;
+			for (byte x = 0; x < count; ++x) {
+				t = this->earliest(t, this->sweepPointVsCapsule(origin, direction, vertices[x], vertices[(x + 1) % count], radius));
+			}
+
+			Vec3 n = crossProduct(vertices[1] - vertices[0], vertices[count - 1] - vertices[0]);
+			decimal nLength = magnitude(n);
+			if (nLength > mathEPSILON) {
+
+				n /= nLength;
+
+				decimal s0 = dotProduct(n, origin - vertices[0]);
+				decimal ds = dotProduct(n, direction);
+
+				decimal tf = decimal(-1.0);
+				if (mathABS(s0) <= radius) tf = decimal(0.0);
+				else if (s0 > radius && ds < decimal(0.0)) tf = (s0 - radius) / -ds;
+				else if (s0 < -radius && ds > decimal(0.0)) tf = (-radius - s0) / ds;
+
+				if (tf >= decimal(0.0) && tf <= decimal(1.0) && (t < decimal(0.0) || tf < t)) {
+
+					Vec3 p = origin + direction * tf;
+
+					bool inside = true;
+					for (byte x = 0; x < count; ++x) {
+						if (dotProduct(crossProduct(vertices[(x + 1) % count] - vertices[x], p - vertices[x]), n) < decimal(0.0)) {
+							inside = false;
+							break;
+						}
+					}
+
+					if (inside) {
+						t = tf;
+					}
+				}
+			}
+
+			return t;
 		}
 
-		DistanceResult capsuleVsSphereDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
+		//segment 1 translates by direction, the gaps between the two segments form a parallelogram that the origin is swept against
+		decimal sweepSegmentVsSegment(const Vec3& a1, const Vec3& b1, const Vec3& direction, const Vec3& a2, const Vec3& b2, const decimal& radius)
 		{
-			Capsule capsule = this->physicsData->capsuleColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t));
-			Sphere sphere = this->physicsData->sphereColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t));
-
-			DistanceResult s;
-			s.closest1 = capsule.closestPoint(sphere.center);
-			s.closest2 = sphere.closestPoint(s.closest1);
-			s.overlap = magnitudeSq(sphere.center - capsule.capsuleLine.closestPoint(sphere.center)) < square(sphere.radius + capsule.radius);
-			return s;
+			Vec3 vertices[4] = { a2 - a1, b2 - a1, b2 - b1, a2 - b1 };
+			return this->sweepPointVsInflatedPolygon(Vec3(), direction, vertices, 4, radius);
 		}
 
-		DistanceResult capsuleVsCapsuleDistance(const ColliderIdentifier& identifier1, const ColliderIdentifier& identifier2, const Transform3DRange& transform1, const Transform3DRange& transform2, const decimal& t)
+		decimal sweepSegmentVsConvexHull(const Vec3& pointA, const Vec3& pointB, const Vec3& direction, const decimal& radius, const ConvexHull& convexHull)
 		{
-			Capsule capsule1 = this->physicsData->capsuleColliders[identifier1.colliderIndex].collider.transformed(transform1.interpolate(t));
-			Capsule capsule2 = this->physicsData->capsuleColliders[identifier2.colliderIndex].collider.transformed(transform2.interpolate(t));
+			//the face planes pushed out by the radius bound the inflated hull, clip the motion against them
+			decimal tEnter = decimal(0.0);
+			decimal tExit = decimal(1.0);
+			for (uint32 x = 0, len = convexHull.halfEdgeMesh.faces.size(); x < len; ++x) {
 
-			Vec3 c = capsule2.capsuleLine.closestPoint(capsule1.capsuleLine);
+				Plane plane = convexHull.getFacePlane(x);
 
-			DistanceResult s;
-			s.closest1 = capsule1.closestPoint(c);
-			s.closest2 = capsule1.closestPoint(s.closest1);
-			s.overlap = magnitudeSq(capsule1.capsuleLine.closestPoint(c) - c) < square(capsule1.radius + capsule2.radius);
-			return s;
+				decimal s0 = mathMIN(dotProduct(plane.normal, pointA), dotProduct(plane.normal, pointB)) - plane.distance - radius;
+				decimal ds = dotProduct(plane.normal, direction);
+
+				if (mathABS(ds) < mathEPSILON) {
+					if (s0 > decimal(0.0)) return decimal(-1.0);
+					continue;
+				}
+
+				decimal t = -s0 / ds;
+				if (ds < decimal(0.0)) {
+					tEnter = mathMAX(tEnter, t);
+				}
+				else {
+					tExit = mathMIN(tExit, t);
+				}
+
+				if (tEnter > tExit) return decimal(-1.0);
+			}
+
+			//a straight line motion can not overshoot when advanced by the remaining distance
+			decimal speed = magnitude(direction);
+			decimal t = tEnter;
+			for (byte iterations = 0; iterations < MAXIMUM_ITERATIONS; ++iterations) {
+
+				++this->iterations;
+
+				GJKDistanceResult r = GJKDistance(convexHull, LineSegment(pointA + direction * t, pointB + direction * t));
+				if (r.overlap) return t;
+
+				decimal gap = magnitude(r.closest2 - r.closest1) - radius;
+				if (gap <= this->physicsData->settings.linearSlop) return t;
+				if (speed < mathEPSILON) return decimal(-1.0);
+
+				t += gap / speed;
+				if (t > tExit) return decimal(-1.0);
+			}
+
+			return t;
 		}
 
-		DistanceResult convexHullVsTriangleDistance(const ColliderIdentifier& identifier, const Triangle& triangle, const Transform3DRange& transform, const decimal& t)
+		//pairs without a closed form go through GJK, the overloads below take spheres and capsules by their core
+		template<typename Shape1, typename Shape2>
+		DistanceResult distance(const Shape1& shape1, const Shape2& shape2)
 		{
-			GJKDistanceResult r = GJKDistance(this->physicsData->convexHullColliders[identifier.colliderIndex].collider.transformed(transform.interpolate(t)), triangle);
+			GJKDistanceResult r = GJKDistance(shape1, shape2);
 
 			DistanceResult s;
 			s.closest1 = r.closest1;
@@ -420,41 +595,82 @@ namespace mech {
 			return s;
 		}
 
-		DistanceResult sphereVsTriangleDistance(const ColliderIdentifier& identifier, const Triangle& triangle, const Transform3DRange& transform, const decimal& t)
+		template<typename Shape>
+		DistanceResult distance(const Shape& shape, const Sphere& sphere)
 		{
-			Sphere sphere = this->physicsData->sphereColliders[identifier.colliderIndex].collider.transformed(transform.interpolate(t));
+			DistanceResult s;
+			s.closest1 = shape.closestPoint(sphere.center);
+			s.closest2 = sphere.closestPoint(s.closest1);
+			s.overlap = magnitudeSq(s.closest1 - sphere.center) < square(sphere.radius);
+			return s;
+		}
 
+		template<typename Shape>
+		DistanceResult distance(const Sphere& sphere, const Shape& shape)
+		{
 			DistanceResult s;
-			s.closest2 = triangle.closestPoint(sphere.center);
+			s.closest2 = shape.closestPoint(sphere.center);
 			s.closest1 = sphere.closestPoint(s.closest2);
 			s.overlap = magnitudeSq(s.closest2 - sphere.center) < square(sphere.radius);
 			return s;
 		}
 
-		DistanceResult capsuleVsTriangleDistance(const ColliderIdentifier& identifier, const Triangle& triangle, const Transform3DRange& transform, const decimal& t)
+		template<typename Shape>
+		DistanceResult distance(const Shape& shape, const Capsule& capsule)
 		{
-			Capsule capsule = this->physicsData->capsuleColliders[identifier.colliderIndex].collider.transformed(transform.interpolate(t));
+			DistanceResult s;
+			s.closest1 = shape.closestPoint(capsule.capsuleLine);
+			s.closest2 = capsule.closestPoint(s.closest1);
+			s.overlap = magnitudeSq(s.closest1 - capsule.capsuleLine.closestPoint(s.closest1)) < square(capsule.radius);
+			return s;
+		}
 
+		template<typename Shape>
+		DistanceResult distance(const Capsule& capsule, const Shape& shape)
+		{
 			DistanceResult s;
-			s.closest2 = triangle.closestPoint(capsule.capsuleLine);
+			s.closest2 = shape.closestPoint(capsule.capsuleLine);
 			s.closest1 = capsule.closestPoint(s.closest2);
 			s.overlap = magnitudeSq(s.closest2 - capsule.capsuleLine.closestPoint(s.closest2)) < square(capsule.radius);
 			return s;
 		}
 
-		Vec3 convexHullSupport(const ColliderIdentifier& identifier, const Vec3& direction)
+		DistanceResult distance(const Sphere& sphere1, const Sphere& sphere2)
+		{
+			DistanceResult s;
+			s.closest1 = sphere1.closestPoint(sphere2.center);
+			s.closest2 = sphere2.closestPoint(s.closest1);
+			s.overlap = magnitudeSq(sphere1.center - sphere2.center) < square(sphere1.radius + sphere2.radius);
+			return s;
+		}
+
+		DistanceResult distance(const Sphere& sphere, const Capsule& capsule)
 		{
-			return this->physicsData->convexHullColliders[identifier.colliderIndex].collider.getSupportPoint(direction);
+			DistanceResult s;
+			s.closest2 = capsule.closestPoint(sphere.center);
+			s.closest1 = sphere.closestPoint(s.closest2);
+			s.overlap = magnitudeSq(sphere.center - capsule.capsuleLine.closestPoint(sphere.center)) < square(sphere.radius + capsule.radius);
+			return s;
 		}
 
-		Vec3 sphereSupport(const ColliderIdentifier& identifier, const Vec3& direction)
+		DistanceResult distance(const Capsule& capsule, const Sphere& sphere)
 		{
-			return this->physicsData->sphereColliders[identifier.colliderIndex].collider.getSupportPoint(direction);
+			DistanceResult s;
+			s.closest1 = capsule.closestPoint(sphere.center);
+			s.closest2 = sphere.closestPoint(s.closest1);
+			s.overlap = magnitudeSq(sphere.center - capsule.capsuleLine.closestPoint(sphere.center)) < square(sphere.radius + capsule.radius);
+			return s;
 		}
 
-		Vec3 capsuleSupport(const ColliderIdentifier& identifier, const Vec3& direction)
+		DistanceResult distance(const Capsule& capsule1, const Capsule& capsule2)
 		{
-			return this->physicsData->capsuleColliders[identifier.colliderIndex].collider.getSupportPoint(direction);
+			Vec3 c = capsule2.capsuleLine.closestPoint(capsule1.capsuleLine);
+
+			DistanceResult s;
+			s.closest1 = capsule1.closestPoint(c);
+			s.closest2 = capsule2.closestPoint(s.closest1);
+			s.overlap = magnitudeSq(capsule1.capsuleLine.closestPoint(c) - c) < square(capsule1.radius + capsule2.radius);
+			return s;
 		}
 	};
 }